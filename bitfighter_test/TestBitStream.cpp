@@ -0,0 +1,391 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlBitStream.h"
+#include "tnlPlatform.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+// The byte-at-a-time BitStream::writeBits() and readBits() we started with, to check the word-at-a-time versions against
+namespace Reference
+{
+   void writeBits(U8 *buffer, U32 &bitNum, U32 bitCount, const void *bitPtr)
+   {
+      if(!bitCount)
+         return;
+
+      U32 upShift  = bitNum & 0x7;
+      U32 downShift= 8 - upShift;
+
+      const U8 *sourcePtr = (U8 *) bitPtr;
+      U8 *destPtr = buffer + (bitNum >> 3);
+
+      if(downShift >= bitCount)
+      {
+         U8 mask = ((1 << bitCount) - 1) << upShift;
+         *destPtr = (*destPtr & ~mask) | ((*sourcePtr << upShift) & mask);
+         bitNum += bitCount;
+         return;
+      }
+
+      if(!upShift)
+      {
+         bitNum += bitCount;
+         for(; bitCount >= 8; bitCount -= 8)
+            *destPtr++ = *sourcePtr++;
+         if(bitCount)
+         {
+            U8 mask = (1 << bitCount) - 1;
+            *destPtr = (*sourcePtr & mask) | (*destPtr & ~mask);
+         }
+         return;
+      }
+
+      U8 sourceByte;
+      U8 destByte = *destPtr & (0xFF >> downShift);
+      U8 lastMask  = 0xFF >> (7 - ((bitNum + bitCount - 1) & 0x7));
+
+      bitNum += bitCount;
+
+      for(;bitCount >= 8; bitCount -= 8)
+      {
+         sourceByte = *sourcePtr++;
+         *destPtr++ = destByte | (sourceByte << upShift);
+         destByte = sourceByte >> downShift;
+      }
+      if(bitCount == 0)
+      {
+         *destPtr = (*destPtr & ~lastMask) | (destByte & lastMask);
+         return;
+      }
+      if(bitCount <= downShift)
+      {
+         *destPtr = (*destPtr & ~lastMask) | ((destByte | (*sourcePtr << upShift)) & lastMask);
+         return;
+      }
+      sourceByte = *sourcePtr;
+
+      *destPtr++ = destByte | (sourceByte << upShift);
+      *destPtr = (*destPtr & ~lastMask) | ((sourceByte >> downShift) & lastMask);
+   }
+
+   void readBits(const U8 *buffer, U32 &bitNum, U32 bitCount, void *bitPtr)
+   {
+      if(!bitCount)
+         return;
+
+      const U8 *sourcePtr = buffer + (bitNum >> 3);
+      U32 byteCount = (bitCount + 7) >> 3;
+
+      U8 *destPtr = (U8 *) bitPtr;
+
+      U32 downShift = bitNum & 0x7;
+      U32 upShift = 8 - downShift;
+
+      if(!downShift)
+      {
+         while(byteCount--)
+            *destPtr++ = *sourcePtr++;
+         bitNum += bitCount;
+         return;
+      }
+
+      U8 sourceByte = *sourcePtr >> downShift;
+      bitNum += bitCount;
+
+      for(; bitCount >= 8; bitCount -= 8)
+      {
+         U8 nextByte = *++sourcePtr;
+         *destPtr++ = sourceByte | (nextByte << upShift);
+         sourceByte = nextByte >> downShift;
+      }
+      if(bitCount)
+      {
+         if(bitCount <= upShift)
+         {
+            *destPtr = sourceByte;
+            return;
+         }
+         *destPtr = sourceByte | ( (*++sourcePtr) << upShift);
+      }
+   }
+
+   U32 readInt(const U8 *buffer, U32 &bitNum, U32 bitCount)
+   {
+      U32 ret = 0;
+      readBits(buffer, bitNum, bitCount, &ret);
+      ret = convertLEndianToHost(ret);
+
+      return bitCount == 32 ? ret : ret & ((1 << bitCount) - 1);
+   }
+};
+
+
+class BitStreamTest : public testing::Test
+{
+protected:
+   static const U32 BufferSize = 512;
+
+   TestRandom mRandom;
+
+   BitStreamTest() : mRandom(12345)
+   {
+      // Do nothing
+   }
+
+   U32 random32()
+   {
+      return (mRandom.next(1 << 16) << 16) | mRandom.next(1 << 16);
+   }
+
+   void fillRandom(U8 *buffer, U32 size)
+   {
+      for(U32 i = 0; i < size; i++)
+         buffer[i] = U8(mRandom.next(256));
+   }
+
+   // Last byte of a read, with the bits past bitCount cleared; the reference leaves whatever followed in the stream there
+   static U8 lastByte(const U8 *buffer, U32 bitCount)
+   {
+      U8 byte = buffer[(bitCount - 1) >> 3];
+      return (bitCount & 0x7) ? byte & ((1 << (bitCount & 0x7)) - 1) : byte;
+   }
+};
+
+
+// Mixed writes over a buffer full of junk have to set exactly the same bits, and leave the rest alone
+TEST_F(BitStreamTest, WritesMatchReference)
+{
+   U8 buffer[BufferSize], expected[BufferSize];
+   U8 source[16];
+
+   for(S32 run = 0; run < 200; run++)
+   {
+      fillRandom(buffer, BufferSize);
+      memcpy(expected, buffer, BufferSize);
+
+      BitStream stream(buffer, BufferSize);
+      U32 bitNum = mRandom.next(64);
+      stream.setBitPosition(bitNum);
+
+      while(bitNum < (BufferSize - sizeof(source)) * 8 - 64)
+      {
+         U32 bitCount;
+
+         switch(mRandom.next(4))
+         {
+            case 0:     // Flag
+            {
+               bool flag = mRandom.next(2) == 1;
+               stream.writeFlag(flag);
+
+               U8 bit = flag ? 1 : 0;
+               Reference::writeBits(expected, bitNum, 1, &bit);
+               break;
+            }
+
+            case 1:     // Int, with junk above the bits being written
+            {
+               U32 value = random32();
+               bitCount = mRandom.next(33);
+               stream.writeInt(value, U8(bitCount));
+
+               value = convertHostToLEndian(value);
+               Reference::writeBits(expected, bitNum, bitCount, &value);
+               break;
+            }
+
+            case 2:     // Blob
+            {
+               fillRandom(source, sizeof(source));
+               bitCount = mRandom.next(sizeof(source) * 8 + 1);
+               stream.writeBits(bitCount, source);
+               Reference::writeBits(expected, bitNum, bitCount, source);
+               break;
+            }
+
+            default:    // Whole bytes, often aligned
+            {
+               fillRandom(source, sizeof(source));
+               bitCount = mRandom.next(sizeof(source) + 1);
+               stream.write(bitCount, source);
+               Reference::writeBits(expected, bitNum, bitCount * 8, source);
+               break;
+            }
+         }
+
+         ASSERT_EQ(bitNum, stream.getBitPosition());
+      }
+
+      ASSERT_EQ(0, memcmp(expected, buffer, BufferSize)) << "Run " << run;
+   }
+}
+
+
+TEST_F(BitStreamTest, ReadsMatchReference)
+{
+   U8 buffer[BufferSize];
+   U8 actual[16], expected[16];
+
+   fillRandom(buffer, BufferSize);
+
+   for(S32 run = 0; run < 200; run++)
+   {
+      BitStream stream(buffer, BufferSize);
+      U32 bitNum = mRandom.next(64);
+      stream.setBitPosition(bitNum);
+
+      while(bitNum < (BufferSize - sizeof(actual)) * 8 - 64)
+      {
+         U32 bitCount;
+
+         switch(mRandom.next(3))
+         {
+            case 0:
+               bitCount = mRandom.next(33);
+               ASSERT_EQ(Reference::readInt(buffer, bitNum, bitCount), stream.readInt(U8(bitCount)));
+               break;
+
+            case 1:
+               bitCount = mRandom.next(sizeof(actual) * 8) + 1;
+               stream.readBits(bitCount, actual);
+               Reference::readBits(buffer, bitNum, bitCount, expected);
+
+               ASSERT_EQ(0, memcmp(expected, actual, (bitCount - 1) >> 3));
+               ASSERT_EQ(lastByte(expected, bitCount), lastByte(actual, bitCount));
+               break;
+
+            default:
+               bitCount = mRandom.next(sizeof(actual)) + 1;
+               stream.read(bitCount, actual);
+               Reference::readBits(buffer, bitNum, bitCount * 8, expected);
+
+               ASSERT_EQ(0, memcmp(expected, actual, bitCount));
+               break;
+         }
+
+         ASSERT_EQ(bitNum, stream.getBitPosition());
+      }
+
+      ASSERT_TRUE(stream.isValid());
+   }
+}
+
+
+// Word loads near the end of the buffer can't grab eight bytes at once
+TEST_F(BitStreamTest, EndOfBuffer)
+{
+   U8 buffer[5] = { 0 };
+   BitStream stream(buffer, sizeof(buffer));
+
+   stream.setBitPosition(7);
+   stream.writeInt(0xFFFFFFFF, 32);
+   stream.writeFlag(true);
+
+   EXPECT_EQ(0x80, buffer[0]);
+   EXPECT_EQ(0xFF, buffer[3]);
+   EXPECT_EQ(0xFF, buffer[4]);
+
+   stream.setBitPosition(7);
+   EXPECT_EQ(0xFFFFFFFF, stream.readInt(32));
+   EXPECT_TRUE(stream.readFlag());
+
+   // Past the end
+   stream.setBitPosition(20);
+   EXPECT_EQ(0, stream.readInt(32));
+   EXPECT_FALSE(stream.isValid());
+}
+
+
+// Resizable streams grow as they're written to
+TEST_F(BitStreamTest, ResizedWrites)
+{
+   BitStream stream;
+
+   for(U32 i = 0; i < 5000; i++)
+      stream.writeInt(i, 13);
+
+   BitStream reader(stream.getBuffer(), stream.getBytePosition());
+
+   for(U32 i = 0; i < 5000; i++)
+      ASSERT_EQ(i, reader.readInt(13));
+}
+
+
+// Cost of the small reads and writes that most packing is made of, against the original byte-at-a-time code.  Best of a
+// few rounds, to keep the noise down.
+TEST_F(BitStreamTest, BenchmarkSmallReadsAndWrites)
+{
+   const U32 OpCount = 200000;
+   const S32 Rounds = 5;
+
+   static U8 buffer[OpCount * 4 + 8];
+   U8 sizes[256];
+   U32 values[256];
+
+   for(S32 i = 0; i < 256; i++)
+   {
+      sizes[i] = U8(mRandom.next(32) + 1);
+      values[i] = random32();
+   }
+
+   memset(buffer, 0, sizeof(buffer));    // So neither side pays for faulting the pages in
+
+   F64 best[4] = { 1e9, 1e9, 1e9, 1e9 };    // write, reference write, read, reference read
+
+   for(S32 round = 0; round < Rounds; round++)
+   {
+      BitStream stream(buffer, sizeof(buffer));
+
+      S64 start = Platform::getHighPrecisionTimerValue();
+      for(U32 i = 0; i < OpCount; i++)
+         stream.writeInt(values[i & 0xFF], sizes[i & 0xFF]);
+      best[0] = min(best[0], Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start));
+
+      U32 bitNum = 0;
+      start = Platform::getHighPrecisionTimerValue();
+      for(U32 i = 0; i < OpCount; i++)
+      {
+         U32 value = convertHostToLEndian(values[i & 0xFF]);
+         Reference::writeBits(buffer, bitNum, sizes[i & 0xFF], &value);
+      }
+      best[1] = min(best[1], Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start));
+
+      EXPECT_EQ(bitNum, stream.getBitPosition());
+
+      U32 sum = 0;
+      stream.setBitPosition(0);
+      start = Platform::getHighPrecisionTimerValue();
+      for(U32 i = 0; i < OpCount; i++)
+         sum += stream.readInt(sizes[i & 0xFF]);
+      best[2] = min(best[2], Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start));
+
+      U32 referenceSum = 0;
+      bitNum = 0;
+      start = Platform::getHighPrecisionTimerValue();
+      for(U32 i = 0; i < OpCount; i++)
+         referenceSum += Reference::readInt(buffer, bitNum, sizes[i & 0xFF]);
+      best[3] = min(best[3], Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start));
+
+      EXPECT_EQ(referenceSum, sum);
+   }
+
+   printf("[ BITBENCH   ] writeInt %6.2f ns/op (byte-at-a-time %6.2f)   readInt %6.2f ns/op (byte-at-a-time %6.2f)\n",
+          best[0] * 1e6 / OpCount, best[1] * 1e6 / OpCount, best[2] * 1e6 / OpCount, best[3] * 1e6 / OpCount);
+}
+
+
+};
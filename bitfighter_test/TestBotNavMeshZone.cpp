@@ -0,0 +1,354 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotNavMeshZone.h"
+#include "BotPathCache.h"
+#include "LevelPreloader.h"
+#include "ServerGame.h"
+#include "BfObject.h"
+#include "stringUtils.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+namespace Zap
+{
+
+static string getNavMeshTestLevel()
+{
+   return
+      "GameType 10 8\n"
+      "LevelName Nav Mesh Test\n"
+      "GridSize 255\n"
+      "Team Blue 0 0 1\n"
+      "BarrierMaker 40 -4 -4 4 -4 4 4 -4 4 -4 -4\n"
+      "BarrierMaker 40 -2 -2 -2 -1\n"
+      "BarrierMaker 40 1 1 2 1 2 2\n"
+      "BarrierMaker 40 0 2.5 0.5 3\n";
+}
+
+
+// Zones we read back from the cache should be the same as the ones we built
+TEST(BotNavMeshZoneTest, CacheRoundTrip)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+
+   game->loadLevelFromString(getNavMeshTestLevel(), db);
+   game->computeWorldObjectExtents();
+
+   Vector<DatabaseObject *> barrierList, emptyList;
+   db->findObjects((TestFunc)isWallType, barrierList, *game->getWorldExtents());
+   Vector<pair<Point, const Vector<Point> *> > teleporterData;
+
+   GridDatabase builtDatabase, readDatabase;
+   Vector<BotNavMeshZone *> builtZones, readZones;
+
+   ASSERT_TRUE(BotNavMeshZone::buildBotMeshZones(&builtDatabase, &builtZones, game->getWorldExtents(), barrierList,
+                                                 emptyList, emptyList, teleporterData, false));
+   ASSERT_TRUE(builtZones.size() > 1);
+
+   const string CacheFile = BotNavMeshZone::getCacheFileName(".", "navmesh_test");
+
+   ASSERT_TRUE(BotNavMeshZone::writeBotMeshZoneCache(CacheFile, &builtZones));
+   ASSERT_TRUE(BotNavMeshZone::readBotMeshZoneCache(CacheFile, &readDatabase, &readZones, false));
+
+   ASSERT_EQ(builtZones.size(), readZones.size());
+
+   for(S32 i = 0; i < builtZones.size(); i++)
+   {
+      BotNavMeshZone *built = builtZones[i];
+      BotNavMeshZone *read = readZones[i];
+
+      EXPECT_EQ(built->getZoneId(), read->getZoneId());
+      EXPECT_EQ(built->getCenter(), read->getCenter());
+
+      ASSERT_EQ(built->getOutline()->size(), read->getOutline()->size());
+      for(S32 j = 0; j < built->getOutline()->size(); j++)
+         EXPECT_EQ((*built->getOutline())[j], (*read->getOutline())[j]);
+
+      ASSERT_EQ(built->mNeighbors.size(), read->mNeighbors.size());
+      for(S32 j = 0; j < built->mNeighbors.size(); j++)
+      {
+         EXPECT_EQ(built->mNeighbors[j].zoneID,       read->mNeighbors[j].zoneID);
+         EXPECT_EQ(built->mNeighbors[j].borderCenter, read->mNeighbors[j].borderCenter);
+         EXPECT_EQ(built->mNeighbors[j].distTo,       read->mNeighbors[j].distTo);
+      }
+   }
+
+   // Zones should be findable in the database we gave them
+   fillVector.clear();
+   readDatabase.findObjects(BotNavMeshZoneTypeNumber, fillVector);
+   EXPECT_EQ(readZones.size(), fillVector.size());
+
+   // A damaged file should be rejected, and leave us with no zones
+   string contents = readFile(CacheFile);
+   ASSERT_TRUE(writeFile(CacheFile, contents.substr(0, contents.size() / 2)));
+
+   GridDatabase damagedDatabase;
+   EXPECT_FALSE(BotNavMeshZone::readBotMeshZoneCache(CacheFile, &damagedDatabase, &readZones, false));
+   EXPECT_EQ(0, readZones.size());
+
+   remove(CacheFile.c_str());
+
+   builtZones.deleteAndClear();
+   delete game;
+}
+
+
+static F32 getPathLength(const Vector<Point> &path)
+{
+   F32 length = 0;
+
+   for(S32 i = 1; i < path.size(); i++)
+      length += path[i - 1].distanceTo(path[i]);
+
+   return length;
+}
+
+
+// A field of pillars -- lots of zones, so the clusters have something to do
+static string getPillarLevel()
+{
+   string level = "GameType 10 8\nLevelName Pillars\nGridSize 255\nTeam Blue 0 0 1\n"
+                  "BarrierMaker 40 -1 -1 21 -1 21 21 -1 21 -1 -1\n";
+
+   for(S32 x = 1; x < 20; x += 2)
+      for(S32 y = 1; y < 20; y += 2)
+         level += "BarrierMaker 20 " + itos(x) + " " + itos(y) + " " + itos(x) + " " + ftos(y + 0.3f) + "\n";
+
+   return level;
+}
+
+
+// Zones triangulated on the preloader's worker should be just the same as ones built all in one go
+TEST(BotNavMeshZoneTest, TriangulateOnWorker)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+
+   game->loadLevelFromString(getPillarLevel(), db);
+   game->computeWorldObjectExtents();
+
+   Vector<DatabaseObject *> barrierList, emptyList;
+   db->findObjects((TestFunc)isWallType, barrierList, *game->getWorldExtents());
+   Vector<pair<Point, const Vector<Point> *> > teleporterData;
+
+   GridDatabase builtDatabase, workerDatabase;
+   Vector<BotNavMeshZone *> builtZones, workerZones;
+
+   ASSERT_TRUE(BotNavMeshZone::buildBotMeshZones(&builtDatabase, &builtZones, game->getWorldExtents(), barrierList,
+                                                 emptyList, emptyList, teleporterData, false));
+
+   BotNavMeshGeometry *geometry = new BotNavMeshGeometry;
+   ASSERT_TRUE(BotNavMeshZone::getBotMeshGeometry(game->getWorldExtents(), barrierList, emptyList, emptyList,
+                                                  teleporterData, *geometry));
+
+   LevelPreloader preloader;
+   bool triangulated = false;
+
+   EXPECT_TRUE(preloader.takeNavMesh(triangulated) == NULL);
+
+   preloader.startNavMesh(geometry);
+   EXPECT_FALSE(preloader.isStarted());      // That's only for levels
+
+   ASSERT_TRUE(preloader.takeNavMesh(triangulated) == geometry);
+   ASSERT_TRUE(triangulated);
+   EXPECT_TRUE(preloader.takeNavMesh(triangulated) == NULL);
+
+   BotNavMeshZone::addBotMeshZones(&workerDatabase, &workerZones, *geometry, false);
+   delete geometry;
+
+   ASSERT_EQ(builtZones.size(), workerZones.size());
+
+   for(S32 i = 0; i < builtZones.size(); i++)
+   {
+      ASSERT_EQ(builtZones[i]->getOutline()->size(), workerZones[i]->getOutline()->size());
+      for(S32 j = 0; j < builtZones[i]->getOutline()->size(); j++)
+         EXPECT_EQ((*builtZones[i]->getOutline())[j], (*workerZones[i]->getOutline())[j]);
+
+      ASSERT_EQ(builtZones[i]->mNeighbors.size(), workerZones[i]->mNeighbors.size());
+      for(S32 j = 0; j < builtZones[i]->mNeighbors.size(); j++)
+      {
+         EXPECT_EQ(builtZones[i]->mNeighbors[j].zoneID,       workerZones[i]->mNeighbors[j].zoneID);
+         EXPECT_EQ(builtZones[i]->mNeighbors[j].borderCenter, workerZones[i]->mNeighbors[j].borderCenter);
+      }
+   }
+
+   // A preloader that goes away with a nav mesh in hand should clean up after itself
+   geometry = new BotNavMeshGeometry;
+   ASSERT_TRUE(BotNavMeshZone::getBotMeshGeometry(game->getWorldExtents(), barrierList, emptyList, emptyList,
+                                                  teleporterData, *geometry));
+   preloader.startNavMesh(geometry);
+
+   builtZones.deleteAndClear();
+   workerZones.deleteAndClear();
+   delete game;
+}
+
+
+// Paths planned over clusters should get there whenever a full search does, and not take a silly way round
+TEST(BotNavMeshZoneTest, HierarchicalPaths)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+
+   game->loadLevelFromString(getPillarLevel(), db);
+   game->computeWorldObjectExtents();
+
+   Vector<DatabaseObject *> barrierList, emptyList;
+   db->findObjects((TestFunc)isWallType, barrierList, *game->getWorldExtents());
+   Vector<pair<Point, const Vector<Point> *> > teleporterData;
+
+   GridDatabase zoneDatabase;
+   Vector<BotNavMeshZone *> zones;
+
+   ASSERT_TRUE(BotNavMeshZone::buildBotMeshZones(&zoneDatabase, &zones, game->getWorldExtents(), barrierList,
+                                                 emptyList, emptyList, teleporterData, false));
+
+   BotZoneClusters clusters;
+   clusters.build(&zones);
+
+   ASSERT_TRUE(clusters.getClusterCount() > 2);
+
+   // Every zone is in a cluster no bigger than it should be
+   Vector<S32> clusterSizes;
+   clusterSizes.resize(clusters.getClusterCount());
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      ASSERT_TRUE(clusters.getCluster(i) < clusters.getClusterCount());
+      clusterSizes[clusters.getCluster(i)]++;
+   }
+
+   for(S32 i = 0; i < clusterSizes.size(); i++)
+      EXPECT_TRUE(clusterSizes[i] > 0 && clusterSizes[i] <= BotZoneClusters::ClusterSize);
+
+   AStar::Context context;
+   Point target(1, 1);
+   F32 totalFullLength = 0, totalClusterLength = 0;
+
+   for(S32 start = 0; start < zones.size(); start += 7)
+      for(S32 end = zones.size() - 1; end >= 0; end -= 11)
+      {
+         Vector<Point> fullPath = AStar::findPath(&zones, start, end, target);
+         Vector<Point> reusedPath = AStar::findPath(&zones, start, end, target, context);
+         Vector<Point> clusterPath = AStar::findPath(&zones, start, end, target, context, &clusters);
+
+         // Reusing a context shouldn't change anything
+         ASSERT_EQ(fullPath.size(), reusedPath.size());
+         for(S32 i = 0; i < fullPath.size(); i++)
+            EXPECT_EQ(fullPath[i], reusedPath[i]);
+
+         ASSERT_EQ(fullPath.size() > 0, clusterPath.size() > 0);
+
+         if(clusterPath.size() > 0)
+         {
+            EXPECT_EQ(zones[start]->getCenter(), clusterPath.last());
+            EXPECT_TRUE(getPathLength(clusterPath) <= getPathLength(fullPath) * 2 + 1);
+
+            totalFullLength += getPathLength(fullPath);
+            totalClusterLength += getPathLength(clusterPath);
+         }
+      }
+
+   // Now and then the corridor costs us a detour, but not often
+   EXPECT_TRUE(totalClusterLength < totalFullLength * 1.05f);
+
+   zones.deleteAndClear();
+   delete game;
+}
+
+
+TEST(BotNavMeshZoneTest, FlowField)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+
+   game->loadLevelFromString(getPillarLevel(), db);
+   game->computeWorldObjectExtents();
+
+   Vector<DatabaseObject *> barrierList, emptyList;
+   db->findObjects((TestFunc)isWallType, barrierList, *game->getWorldExtents());
+   Vector<pair<Point, const Vector<Point> *> > teleporterData;
+
+   GridDatabase zoneDatabase;
+   Vector<BotNavMeshZone *> zones;
+
+   ASSERT_TRUE(BotNavMeshZone::buildBotMeshZones(&zoneDatabase, &zones, game->getWorldExtents(), barrierList,
+                                                 emptyList, emptyList, teleporterData, false));
+
+   Point target(1, 1);
+
+   for(S32 targetZone = 0; targetZone < zones.size(); targetZone += 13)
+   {
+      BotFlowField field;
+      field.build(&zones, targetZone);
+
+      EXPECT_EQ(targetZone, field.getTargetZone());
+      EXPECT_EQ(U16_MAX, field.getNextZone(targetZone));
+      EXPECT_EQ(0, field.getCost(targetZone));
+
+      for(S32 start = 0; start < zones.size(); start++)
+      {
+         // Reachable from the same places AStar can find a path from
+         ASSERT_EQ(AStar::findPath(&zones, start, targetZone, target).size() > 0, field.canReachTarget(start));
+
+         if(!field.canReachTarget(start) || start == targetZone)
+            continue;
+
+         // Following the field gets us there, never going uphill, leaving through a border with the next zone
+         S32 zone = start;
+         S32 steps = 0;
+
+         while(zone != targetZone && steps <= zones.size())
+         {
+            U16 next = field.getNextZone(zone);
+            ASSERT_NE(U16_MAX, next);
+
+            S32 neighborIndex = zones[zone]->getNeighborIndex(next);
+            ASSERT_TRUE(neighborIndex >= 0);
+            EXPECT_EQ(zones[zone]->mNeighbors[neighborIndex].borderCenter, field.getGateway(zone));
+            EXPECT_FALSE(field.isTeleporter(zone));
+            EXPECT_TRUE(field.getCost(next) <= field.getCost(zone));
+
+            zone = next;
+            steps++;
+         }
+
+         EXPECT_EQ(targetZone, zone);
+      }
+   }
+
+   // Robots headed the same way share a field
+   BotFlowFieldCache cache(2);
+
+   const BotFlowField *field = cache.get(&zones, 0);
+   EXPECT_EQ(field, cache.get(&zones, 0));
+   EXPECT_EQ(1, cache.getHits());
+   EXPECT_EQ(1, cache.getMisses());
+
+   cache.get(&zones, 1);
+   cache.get(&zones, 0);     // Now 1 is the least recently used
+   cache.get(&zones, 2);
+   EXPECT_EQ(2, cache.getSize());
+   EXPECT_EQ(2, cache.get(&zones, 2)->getTargetZone());
+   EXPECT_EQ(0, cache.get(&zones, 0)->getTargetZone());
+   EXPECT_EQ(3, cache.getMisses());
+
+   cache.get(&zones, 1);     // Was thrown out, so has to be built again
+   EXPECT_EQ(4, cache.getMisses());
+
+   cache.clear();
+   EXPECT_EQ(0, cache.getSize());
+
+   zones.deleteAndClear();
+   delete game;
+}
+
+
+};
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotPathCache.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static Vector<Point> makePath(F32 x)
+{
+   Vector<Point> path;
+   path.push_back(Point(x, 0));
+   path.push_back(Point(x, 1));
+   return path;
+}
+
+
+TEST(BotPathCacheTest, FindAndEvict)
+{
+   BotPathCache cache(3);
+
+   EXPECT_TRUE(cache.find(1, 2) == NULL);
+   EXPECT_EQ(0, cache.getHits());
+   EXPECT_EQ(1, cache.getMisses());
+
+   cache.add(1, 2, makePath(12));
+   cache.add(2, 1, makePath(21));      // Direction matters
+   cache.add(1, 3, makePath(13));
+   EXPECT_EQ(3, cache.getSize());
+
+   ASSERT_TRUE(cache.find(1, 2) != NULL);
+   EXPECT_EQ(Point(12, 0), (*cache.find(1, 2))[0]);
+   EXPECT_EQ(Point(21, 0), (*cache.find(2, 1))[0]);
+   EXPECT_EQ(3, cache.getHits());
+
+   // 1->3 is now the least recently used, so it's the one to go
+   cache.add(3, 4, makePath(34));
+   EXPECT_EQ(3, cache.getSize());
+   EXPECT_TRUE(cache.find(1, 3) == NULL);
+   EXPECT_TRUE(cache.find(1, 2) != NULL);
+   EXPECT_TRUE(cache.find(3, 4) != NULL);
+
+   // Replacing a path doesn't take more room
+   cache.add(3, 4, makePath(43));
+   EXPECT_EQ(3, cache.getSize());
+   EXPECT_EQ(Point(43, 0), (*cache.find(3, 4))[0]);
+
+   // Empty paths (no way through) are worth remembering too
+   cache.add(5, 6, Vector<Point>());
+   ASSERT_TRUE(cache.find(5, 6) != NULL);
+   EXPECT_EQ(0, cache.find(5, 6)->size());
+
+   cache.clear();
+   EXPECT_EQ(0, cache.getSize());
+   EXPECT_TRUE(cache.find(3, 4) == NULL);
+   EXPECT_TRUE(cache.getHits() > 0);
+
+   cache.resetStats();
+   EXPECT_EQ(0, cache.getHits());
+   EXPECT_EQ(0, cache.getMisses());
+}
+
+
+};
@@ -0,0 +1,371 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "CollisionBroadphase.h"
+#include "gameType.h"
+#include "moveObject.h"
+#include "ServerGame.h"
+#include "ship.h"
+#include "stringUtils.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Zap
+{
+
+using namespace std;
+
+// A walled-in arena with some pillars and loose items for the ships to bang into
+static string getBroadphaseTestLevel()
+{
+   return
+      "GameType 10 8\n"
+      "LevelName Broadphase Test\n"
+      "GridSize 255\n"
+      "Team Blue 0 0 1\n"
+      "BarrierMaker 40 -4 -4 4 -4 4 4 -4 4 -4 -4\n"
+      "BarrierMaker 40 -2 -2 -2 -1\n"
+      "BarrierMaker 40 1 1 2 1 2 2\n"
+      "BarrierMaker 40 0 2.5 0.5 3\n"
+      "TestItem 0.5 0.5\n"
+      "TestItem -1 1\n"
+      "TestItem 1.5 -2\n"
+      "ResourceItem -3 3\n"
+      "ResourceItem 3 -3\n"
+      "ResourceItem -0.5 -3\n"
+   ;
+}
+
+
+struct MoveObjectState
+{
+   U8 typeNumber;
+   Point pos;
+   Point vel;
+};
+
+
+// Play the same scripted game with the broadphase on or off; states gets the position and velocity of every MoveObject
+// after every tick
+static void runReplay(bool useBroadphase, Vector<Vector<MoveObjectState> > &states)
+{
+   const S32 ShipCount = 16;
+   const S32 TickCount = 500;
+   const U32 TickLength = 15;
+
+   ServerGame *game = newServerGame();
+   game->getCollisionBroadphase()->setEnabled(useBroadphase);
+
+   GridDatabase *db = game->getGameObjDatabase();
+   game->loadLevelFromString(getBroadphaseTestLevel(), db);
+   game->computeWorldObjectExtents();
+
+   if(!game->getGameType())
+   {
+      GameType *gt = new GameType();      // Will be deleted in game destructor
+      gt->addToGame(game, db);
+   }
+
+   game->unsuspendGame(false);
+
+   Vector<SafePtr<Ship> > ships;
+   for(S32 i = 0; i < ShipCount; i++)
+   {
+      Ship *ship = new Ship(NULL, TEAM_NEUTRAL, Point(-700 + (i % 4) * 450, -700 + (i / 4) * 450));
+      ship->addToGame(game, db);
+      ships.push_back(ship);
+   }
+
+   TestRandom random(1234);
+   states.clear();
+
+   for(S32 tick = 0; tick < TickCount; tick++)
+   {
+      // Every so often, give each ship a new heading; sometimes full speed, sometimes a crawl
+      if(tick % 20 == 0)
+         for(S32 i = 0; i < ships.size(); i++)
+         {
+            if(!ships[i])
+               continue;
+
+            F32 angle = (random.next(3600)) * FloatTau / 3600;
+            F32 speed = (random.next(4) == 0) ? 0.2f : 1.0f;
+
+            ships[i]->setMove(Move(cos(angle) * speed, sin(angle) * speed, angle));
+         }
+
+      game->idle(TickLength);
+
+      states.push_back(Vector<MoveObjectState>());
+
+      const Vector<DatabaseObject *> *objects = db->findObjects_fast();
+      for(S32 i = 0; i < objects->size(); i++)
+      {
+         BfObject *obj = static_cast<BfObject *>(objects->get(i));
+         if(!obj->isMoveObject())
+            continue;
+
+         MoveObjectState state;
+         state.typeNumber = obj->getObjectTypeNumber();
+         state.pos = static_cast<MoveObject *>(obj)->getActualPos();
+         state.vel = static_cast<MoveObject *>(obj)->getActualVel();
+
+         states.last().push_back(state);
+      }
+   }
+
+   delete game;
+}
+
+
+struct RecordedPosition
+{
+   U8 typeNumber;
+   F32 x, y;
+};
+
+
+// Where runReplay() left every MoveObject after ticks 250 and 500, recorded before the broadphase or the type-indexed
+// database searches existed; a change to how candidates are found shouldn't move anything
+static const RecordedPosition RecordedTick250[] = {
+   { 6, 127.5, 127.5 },
+   { 6, -150.540329, 60.4684982 },
+   { 6, 159.619446, -393.078949 },
+   { 3, -765, 765 },
+   { 3, 765, -765 },
+   { 3, -127.5, -765 },
+   { 1, -496.78476, -827.862549 },
+   { 1, -518.720276, -975.395386 },
+   { 1, 231.106445, -457.183319 },
+   { 1, 523.335632, -144.242889 },
+   { 1, -685.595764, -150.483383 },
+   { 1, -16.2165966, 49.534935 },
+   { 1, -27.3063793, -314.980408 },
+   { 1, 655.783875, -574.276794 },
+   { 1, -817.403625, 318.410797 },
+   { 1, -830.779358, 265.698181 },
+   { 1, 574.237915, 545.182495 },
+   { 1, 974.183228, -78.3474503 },
+   { 1, -741.502808, 694.245361 },
+   { 1, -410.49588, 161.373291 },
+   { 1, 194.364197, 966.054932 },
+   { 1, 696.210815, 417.490479 }
+};
+
+static const RecordedPosition RecordedTick500[] = {
+   { 6, -39.828022, 421.013489 },
+   { 6, -352.544495, -68.1953812 },
+   { 6, -416.751495, -279.973175 },
+   { 3, -765, 765 },
+   { 3, 765, -765 },
+   { 3, -127.5, -765 },
+   { 1, -657.416504, -960.702393 },
+   { 1, -724.109741, -738.441895 },
+   { 1, 610.554871, -581.333008 },
+   { 1, 385.597565, -487.865112 },
+   { 1, -460.921173, -147.945557 },
+   { 1, -79.451889, 106.943878 },
+   { 1, -174.505768, 54.4474564 },
+   { 1, 545.318176, -877.015137 },
+   { 1, -678.353333, 103.176056 },
+   { 1, -818.55365, 44.2788773 },
+   { 1, 599.438599, 498.469604 },
+   { 1, 522.363098, -317.993835 },
+   { 1, -109.850517, 762.878662 },
+   { 1, -716.027344, 192.689255 },
+   { 1, 190.841721, 798.010803 },
+   { 1, 797.353821, 627.307129 }
+};
+
+
+static void checkRecordedPositions(const Vector<MoveObjectState> &states, const RecordedPosition *recorded, S32 count)
+{
+   ASSERT_EQ(count, states.size());
+
+   for(S32 i = 0; i < count; i++)
+   {
+      EXPECT_EQ(recorded[i].typeNumber, states[i].typeNumber) << "object " << i;
+      EXPECT_NEAR(recorded[i].x, states[i].pos.x, 0.01) << "object " << i;
+      EXPECT_NEAR(recorded[i].y, states[i].pos.y, 0.01) << "object " << i;
+   }
+}
+
+
+// The broadphase only changes where collision candidates come from; every collision should play out exactly the same
+TEST(CollisionBroadphaseTest, ReplayMatchesDatabaseSearches)
+{
+   Vector<Vector<MoveObjectState> > withBroadphase, withoutBroadphase;
+
+   runReplay(true,  withBroadphase);
+   runReplay(false, withoutBroadphase);
+
+   ASSERT_EQ(500, withBroadphase.size());
+
+   // Database searches have changed too, so check both runs against what they used to do...
+   {
+      SCOPED_TRACE("without broadphase");
+      checkRecordedPositions(withoutBroadphase[249], RecordedTick250, ARRAYSIZE(RecordedTick250));
+      checkRecordedPositions(withoutBroadphase[499], RecordedTick500, ARRAYSIZE(RecordedTick500));
+   }
+   {
+      SCOPED_TRACE("with broadphase");
+      checkRecordedPositions(withBroadphase[249], RecordedTick250, ARRAYSIZE(RecordedTick250));
+      checkRecordedPositions(withBroadphase[499], RecordedTick500, ARRAYSIZE(RecordedTick500));
+   }
+
+   // ...and against each other, every tick
+   ASSERT_EQ(withoutBroadphase.size(), withBroadphase.size());
+
+   for(S32 tick = 0; tick < withBroadphase.size(); tick++)
+   {
+      SCOPED_TRACE("tick = " + itos(tick));
+
+      ASSERT_EQ(withoutBroadphase[tick].size(), withBroadphase[tick].size());
+
+      for(S32 i = 0; i < withBroadphase[tick].size(); i++)
+      {
+         const MoveObjectState &expected = withoutBroadphase[tick][i];
+         const MoveObjectState &actual = withBroadphase[tick][i];
+
+         // Bit-for-bit, not approximately
+         ASSERT_EQ(expected.typeNumber, actual.typeNumber);
+         ASSERT_EQ(expected.pos.x, actual.pos.x);
+         ASSERT_EQ(expected.pos.y, actual.pos.y);
+         ASSERT_EQ(expected.vel.x, actual.vel.x);
+         ASSERT_EQ(expected.vel.y, actual.vel.y);
+      }
+   }
+}
+
+
+static Vector<DatabaseObject *> sortedCandidates(const CollisionBroadphase &broadphase, const MoveObject *obj, const Rect &rect)
+{
+   Vector<DatabaseObject *> results;
+   EXPECT_TRUE(broadphase.findCandidates(obj, (TestFunc)isAnyObjectType, rect, results));
+   std::sort(results.getStlVector().begin(), results.getStlVector().end());
+   return results;
+}
+
+
+static Vector<DatabaseObject *> sortedSearch(const GridDatabase *db, const Rect &rect)
+{
+   Vector<DatabaseObject *> results;
+   db->findObjects((TestFunc)isAnyObjectType, results, rect);
+   std::sort(results.getStlVector().begin(), results.getStlVector().end());
+   return results;
+}
+
+
+// Candidates must track objects that are added, removed, or moved during the tick
+TEST(CollisionBroadphaseTest, CandidatesFollowDatabaseChanges)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+   game->loadLevelFromString(getBroadphaseTestLevel(), db);
+
+   Ship *ship = new Ship(NULL, TEAM_NEUTRAL, Point(0, 0));
+   ship->addToGame(game, db);
+
+   Ship *other = new Ship(NULL, TEAM_NEUTRAL, Point(5000, 5000));    // Far away from everything
+   other->addToGame(game, db);
+
+   CollisionBroadphase broadphase;
+   broadphase.beginTick(db, 100);
+   ASSERT_TRUE(broadphase.isActive());
+   ASSERT_EQ(db->getObjectCount(PlayerShipTypeNumber) + db->getObjectCount(TestItemTypeNumber) +
+             db->getObjectCount(ResourceItemTypeNumber), broadphase.getMoverCount());
+
+   Rect rect(Point(0, 0), 60);
+   EXPECT_EQ(sortedSearch(db, rect).getStlVector(), sortedCandidates(broadphase, ship, rect).getStlVector());
+
+   // Can't answer for an area the ship couldn't have reached this tick
+   Vector<DatabaseObject *> results;
+   EXPECT_FALSE(broadphase.findCandidates(ship, (TestFunc)isAnyObjectType, Rect(Point(3000, 3000), 10), results));
+   EXPECT_EQ(0, results.size());
+
+   // Jump the other ship right next to ours -- it was never on our candidate list, but we should find it now
+   other->setPos(Point(20, 20));
+   EXPECT_EQ(1, broadphase.getChangedObjectCount());
+   EXPECT_EQ(sortedSearch(db, rect).getStlVector(), sortedCandidates(broadphase, ship, rect).getStlVector());
+   EXPECT_TRUE(sortedCandidates(broadphase, ship, rect).contains(other));
+
+   // New objects are found, removed ones are not
+   Ship *added = new Ship(NULL, TEAM_NEUTRAL, Point(-20, 0));
+   added->addToGame(game, db);
+   EXPECT_TRUE(sortedCandidates(broadphase, ship, rect).contains(added));
+
+   other->removeFromDatabase(false);
+   EXPECT_FALSE(sortedCandidates(broadphase, ship, rect).contains(other));
+   EXPECT_EQ(sortedSearch(db, rect).getStlVector(), sortedCandidates(broadphase, ship, rect).getStlVector());
+
+   broadphase.endTick();
+   EXPECT_FALSE(broadphase.isActive());
+   EXPECT_EQ(NULL, db->getBroadphase());
+
+   delete other;
+   delete game;
+}
+
+
+// Collisions are checked in candidate order, and that decides what gets hit, so candidates have to come in exactly the order a
+// database search would find them -- in either bucket mode
+TEST(CollisionBroadphaseTest, CandidatesComeInSearchOrder)
+{
+   ServerGame *game = newServerGame();
+   GridDatabase *db = game->getGameObjDatabase();
+   game->loadLevelFromString(getBroadphaseTestLevel(), db);
+
+   Vector<Ship *> ships;
+   for(S32 i = 0; i < 9; i++)
+   {
+      Ship *ship = new Ship(NULL, TEAM_NEUTRAL, Point(-600 + (i % 3) * 600, -600 + (i / 3) * 600));
+      ship->addToGame(game, db);
+      ships.push_back(ship);
+   }
+
+   TestRandom random(4321);
+   S32 checked = 0;
+
+   for(S32 mode = 0; mode < 2; mode++)
+   {
+      db->setBucketMode(mode == 0 ? GridDatabase::HashedBuckets : GridDatabase::LevelBuckets);
+      db->fitBucketsToExtents(db->getExtents());
+
+      CollisionBroadphase broadphase;
+      broadphase.beginTick(db, 100);
+
+      for(S32 i = 0; i < 500; i++)
+      {
+         Ship *ship = ships[i % ships.size()];
+
+         Point corner = ship->getActualPos() + Point(F32(random.next(81)) - 40, F32(random.next(81)) - 40);
+         Rect rect(corner, corner + Point(F32(random.next(60)), F32(random.next(60))));
+         rect.expand(Point(ship->getRadius(), ship->getRadius()));
+
+         Vector<DatabaseObject *> candidates, expected;
+         if(!broadphase.findCandidates(ship, ship->collideTypes(), rect, candidates))
+            continue;
+
+         db->findObjects(ship->collideTypes(), expected, rect);
+
+         ASSERT_EQ(expected.getStlVector(), candidates.getStlVector()) << "Mode " << mode << ", search " << i;
+         checked++;
+      }
+
+      broadphase.endTick();
+   }
+
+   EXPECT_LT(500, checked);      // Most searches should have been answered by the broadphase
+
+   delete game;
+}
+
+
+};
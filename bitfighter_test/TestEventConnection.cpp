@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlEventConnection.h"
+#include "tnlRPC.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+// Connection with a couple of RPCs to pack; nothing ever gets sent
+class RPCTestConnection : public EventConnection
+{
+public:
+   TNL_DECLARE_RPC(s2cTestMessage, (U32 number, StringPtr message));
+   TNL_DECLARE_RPC(s2cTestEntry, (StringTableEntry entry));
+};
+
+TNL_IMPLEMENT_RPC(RPCTestConnection, s2cTestMessage, (U32 number, StringPtr message), (number, message),
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirServerToClient, 0)
+{
+   // Do nothing
+}
+
+TNL_IMPLEMENT_RPC(RPCTestConnection, s2cTestEntry, (StringTableEntry entry), (entry),
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirServerToClient, 0)
+{
+   // Do nothing
+}
+
+
+class EventConnectionTest : public testing::Test
+{
+protected:
+   RPCTestConnection mConnection;
+
+   void SetUp()
+   {
+      NetClassRep::initialize();    // Normally done by the NetInterface
+   }
+
+   // Reads back what s2cTestMessage packed, after skipping whatever string was written ahead of it
+   static void checkMessage(BitStream &stream, const char *before)
+   {
+      BitStream reader(stream.getBuffer(), stream.getBytePosition());
+      char buffer[256];
+
+      if(before)
+      {
+         reader.readString(buffer);
+         EXPECT_STREQ(before, buffer);
+      }
+
+      U32 number;
+      reader.read(&number);
+      EXPECT_EQ(7, number);
+
+      reader.readString(buffer);
+      EXPECT_STREQ("hello, world", buffer);
+   }
+};
+
+
+TEST_F(EventConnectionTest, BroadcastArgsArePackedOnce)
+{
+   RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(&mConnection, s2cTestMessage, (7, "hello, world"));
+   event->notifyBroadcast();
+
+   NetClassRep *classRep = event->getClassRep();
+   U32 hits = classRep->getSharedUpdateHits();
+   U32 misses = classRep->getSharedUpdateMisses();
+
+   U8 bufferA[256] = { 0 }, bufferB[256] = { 0 };
+   BitStream a(bufferA, sizeof(bufferA));
+   BitStream b(bufferB, sizeof(bufferB));
+
+   event->pack(&mConnection, &a);
+   event->pack(&mConnection, &b);
+
+   EXPECT_EQ(misses + 1, classRep->getSharedUpdateMisses());
+   EXPECT_EQ(hits + 1, classRep->getSharedUpdateHits());
+
+   ASSERT_EQ(a.getBitPosition(), b.getBitPosition());
+   EXPECT_EQ(0, memcmp(bufferA, bufferB, a.getBytePosition()));
+   EXPECT_STREQ(a.getStringBuffer(), b.getStringBuffer());
+
+   checkMessage(b, NULL);
+
+   // Strings are compressed against the last one written, so a stream that has written something else needs its own
+   U8 bufferC[256] = { 0 }, bufferD[256] = { 0 };
+   BitStream c(bufferC, sizeof(bufferC));
+   BitStream d(bufferD, sizeof(bufferD));
+
+   c.writeString("hello, there");
+   event->pack(&mConnection, &c);
+   EXPECT_EQ(misses + 2, classRep->getSharedUpdateMisses());
+
+   d.writeString("hello, there");
+   event->pack(&mConnection, &d);
+   EXPECT_EQ(hits + 2, classRep->getSharedUpdateHits());
+
+   checkMessage(c, "hello, there");
+   checkMessage(d, "hello, there");
+}
+
+
+// StringTableEntries go through each connection's string table, so they can't be shared
+TEST_F(EventConnectionTest, StringTableEntriesArePackedEveryTime)
+{
+   RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(&mConnection, s2cTestEntry, (StringTableEntry("player")));
+   event->notifyBroadcast();
+
+   NetClassRep *classRep = event->getClassRep();
+   U32 hits = classRep->getSharedUpdateHits();
+
+   U8 bufferA[256] = { 0 }, bufferB[256] = { 0 };
+   BitStream a(bufferA, sizeof(bufferA));
+   BitStream b(bufferB, sizeof(bufferB));
+
+   event->pack(&mConnection, &a);
+   event->pack(&mConnection, &b);
+
+   EXPECT_EQ(hits, classRep->getSharedUpdateHits());
+   EXPECT_EQ(a.getBitPosition(), b.getBitPosition());
+}
+
+
+};
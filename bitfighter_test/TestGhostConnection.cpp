@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlGhostConnection.h"
+#include "tnlNetObject.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+// Bare-bones ghostable object with a priority and update size we control
+class GhostTestObject : public NetObject
+{
+   typedef NetObject Parent;
+
+public:
+   F32 mPriority;
+   U32 mUpdateBits;
+
+   GhostTestObject()
+   {
+      mNetFlags.set(Ghostable);
+      mPriority = 0;
+      mUpdateBits = 0;
+   }
+
+   void markDirty() { setMaskBits(1); }
+
+   F32 getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips)
+   {
+      return mPriority + updateSkips;
+   }
+
+   U32 packUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
+   {
+      for(U32 bits = mUpdateBits; bits > 0; bits -= min(bits, 32u))
+         stream->writeInt(0, min(bits, 32u));
+
+      return 0;
+   }
+
+   TNL_DECLARE_CLASS(GhostTestObject);
+};
+
+TNL_IMPLEMENT_NETOBJECT(GhostTestObject);
+
+
+// Scope object that puts everything in scope, all the time
+class GhostTestScope : public NetObject
+{
+public:
+   Vector<GhostTestObject *> mObjects;
+
+   void performScopeQuery(GhostConnection *connection)
+   {
+      for(S32 i = 0; i < mObjects.size(); i++)
+         connection->objectInScope(mObjects[i]);
+   }
+};
+
+
+// GhostConnection that writes packets without a NetInterface or anyone on the other end; every packet gets there
+class GhostTestConnection : public GhostConnection
+{
+public:
+   GhostTestConnection(GhostTestScope *scope, bool partialGhostSort)
+   {
+      setGhostFrom(true);
+      setTranslatesStrings();
+      setPartialGhostSort(partialGhostSort);
+      setScopeObject(scope);
+
+      mGhostClassCount = NetClassRep::getNetClassCount(getNetClassGroup(), NetClassTypeObject);
+      mGhostClassBitSize = NetClassRep::getNetClassBitSize(getNetClassGroup(), NetClassTypeObject);
+
+      // As if the client had said it was ready
+      mScoping = true;
+      mGhosting = true;
+   }
+
+   NetClassGroup getNetClassGroup() const { return NetClassGroupGame; }
+
+   // Writes one packet, and fills sent with the objects it updated, in the order they were written
+   void writeGhostPacket(Vector<NetObject *> &sent)
+   {
+      PacketStream stream;
+
+      prepareWritePacket();
+
+      PacketNotify *notify = allocNotify();
+      mNotifyQueueHead = mNotifyQueueTail = notify;
+      writePacket(&stream, notify);
+
+      sent.clear();
+      for(GhostRef *ref = static_cast<GhostPacketNotify *>(notify)->ghostList; ref; ref = ref->nextRef)
+         sent.push_front(ref->ghost->obj);     // ghostList is built back to front
+
+      packetReceived(notify);
+      mNotifyQueueHead = mNotifyQueueTail = NULL;
+      freeNotify(notify);
+   }
+
+   static S32 getGhostRefsInUse()  { return mGhostRefChunker.getAllocatedCount(); }
+   static S32 getGhostRefsPooled() { return mGhostRefChunker.getPooledCount(); }
+};
+
+
+class GhostConnectionTest : public testing::Test
+{
+protected:
+   GhostTestScope mScope;
+
+   void SetUp()
+   {
+      NetClassRep::initialize();    // Normally done by the NetInterface
+   }
+
+   void TearDown()
+   {
+      for(S32 i = 0; i < mScope.mObjects.size(); i++)
+         delete mScope.mObjects[i];
+   }
+
+   // Priorities come in a handful of values, so there are plenty of ties; update sizes vary so packets fill unevenly
+   void makeObjects(S32 count)
+   {
+      for(S32 i = 0; i < count; i++)
+      {
+         GhostTestObject *obj = new GhostTestObject();
+         obj->mPriority = F32((i * 7919) % 13);
+         obj->mUpdateBits = 16 + (i * 104729) % 80;
+         mScope.mObjects.push_back(obj);
+      }
+   }
+
+   // Every so often, mark some of the objects as changed, like a game would
+   void markSomeDirty(S32 round)
+   {
+      for(S32 i = 0; i < mScope.mObjects.size(); i++)
+         if((i + round) % 3 == 0)
+            mScope.mObjects[i]->markDirty();
+
+      NetObject::collapseDirtyList();
+   }
+};
+
+
+// Sorting only the ghosts that might fit in the packet should send exactly what a full sort would
+TEST_F(GhostConnectionTest, PartialSortSendsSameGhosts)
+{
+   makeObjects(500);
+
+   GhostTestConnection partial(&mScope, true);
+   GhostTestConnection full(&mScope, false);
+
+   Vector<NetObject *> partialSent, fullSent;
+
+   for(S32 round = 0; round < 100; round++)
+   {
+      if(round % 4 == 0)
+         markSomeDirty(round);
+
+      partial.writeGhostPacket(partialSent);
+      full.writeGhostPacket(fullSent);
+
+      ASSERT_EQ(fullSent.getStlVector(), partialSent.getStlVector()) << "round " << round;
+   }
+}
+
+
+// Update records go back to the pool once their packet is delivered, and get reused by later packets
+TEST_F(GhostConnectionTest, GhostRefsAreRecycled)
+{
+   makeObjects(200);
+
+   GhostTestConnection connection(&mScope, true);
+   Vector<NetObject *> sent;
+
+   S32 inUse = GhostTestConnection::getGhostRefsInUse();
+
+   connection.writeGhostPacket(sent);
+   ASSERT_LT(0, sent.size());
+   EXPECT_EQ(inUse, GhostTestConnection::getGhostRefsInUse());
+
+   S32 pooled = GhostTestConnection::getGhostRefsPooled();
+   EXPECT_LE(sent.size(), pooled);
+
+   // A packet no bigger than the first shouldn't need any fresh records
+   markSomeDirty(0);
+   connection.writeGhostPacket(sent);
+   EXPECT_EQ(inUse, GhostTestConnection::getGhostRefsInUse());
+   EXPECT_EQ(pooled, GhostTestConnection::getGhostRefsPooled());
+}
+
+
+// Per-packet cost of ordering ghosts, with a couple thousand objects waiting to be sent
+TEST_F(GhostConnectionTest, BenchmarkGhostPriorities2k)
+{
+   const S32 ObjectCount = 2000;
+   const S32 PacketCount = 200;
+
+   makeObjects(ObjectCount);
+
+   const char *modeNames[] = { "full sort", "partial sort" };
+
+   for(S32 mode = 0; mode < 2; mode++)
+   {
+      GhostTestConnection connection(&mScope, mode == 1);
+      Vector<NetObject *> sent;
+
+      // First packets ghost everything, which isn't what we want to measure
+      while(connection.writeGhostPacket(sent), sent.size() > 0)
+         ;
+
+      S32 sentCount = 0;
+      S64 start = Platform::getHighPrecisionTimerValue();
+
+      for(S32 i = 0; i < PacketCount; i++)
+      {
+         // Keep everything dirty, so every packet has to choose among them all
+         for(S32 j = 0; j < mScope.mObjects.size(); j++)
+            mScope.mObjects[j]->markDirty();
+         NetObject::collapseDirtyList();
+
+         connection.writeGhostPacket(sent);
+         sentCount += sent.size();
+      }
+
+      F64 elapsed = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+      EXPECT_LT(0, sentCount);
+
+      printf("[ GHOSTBENCH ] %-12s %6d objects   %5.1f updates/packet   %8.4f ms/packet\n",
+             modeNames[mode], ObjectCount, sentCount / F32(PacketCount), elapsed / PacketCount);
+   }
+}
+
+
+};
@@ -0,0 +1,439 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "gridDB.h"
+#include "BfObject.h"
+#include "ServerGame.h"
+#include "stringUtils.h"
+
+#include "tnlPlatform.h"
+#include "tnlRandom.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+namespace Zap
+{
+
+using namespace std;
+
+// Bare-bones object we can stuff into a database without a game behind it
+class GridTestObject : public DatabaseObject
+{
+public:
+   GridTestObject(U8 typeNumber, const Rect &extents)
+   {
+      mObjectTypeNumber = typeNumber;
+      setExtent(extents);
+   }
+
+   void setObjectTypeNumber(U8 typeNumber)
+   {
+      mObjectTypeNumber = typeNumber;
+   }
+};
+
+
+class GridDatabaseTest : public testing::Test
+{
+protected:
+   // Runs queries against db, returns elapsed ms; found gets the total number of hits, so results can be compared between modes
+   static F64 runQueries(const GridDatabase *db, const Vector<Rect> &queries, S32 &found)
+   {
+      Vector<DatabaseObject *> results;
+      found = 0;
+
+      S64 start = Platform::getHighPrecisionTimerValue();
+
+      for(S32 i = 0; i < queries.size(); i++)
+      {
+         results.clear();
+         db->findObjects((TestFunc)isAnyObjectType, results, queries[i]);
+         found += results.size();
+      }
+
+      return Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+   }
+
+
+   // Returns sorted results of a query, so we can compare across bucket modes, which return objects in different orders
+   static Vector<DatabaseObject *> sortedQuery(const GridDatabase *db, const Rect &rect)
+   {
+      Vector<DatabaseObject *> results;
+      db->findObjects((TestFunc)isAnyObjectType, results, rect);
+      std::sort(results.getStlVector().begin(), results.getStlVector().end());
+      return results;
+   }
+
+
+   // Query random rects around the world extents, sized like a typical scope or collision query
+   static void makeQueries(const Rect &worldExtents, S32 count, Vector<Rect> &queries)
+   {
+      queries.clear();
+      for(S32 i = 0; i < count; i++)
+      {
+         Point center(worldExtents.min.x + TNL::Random::readF() * worldExtents.getWidth(),
+                      worldExtents.min.y + TNL::Random::readF() * worldExtents.getHeight());
+         queries.push_back(Rect(center, 50 + TNL::Random::readF() * 800));
+      }
+   }
+
+
+   // Compare results and timings for both bucket modes on whatever is in db
+   static void compareModes(GridDatabase *db, const Rect &worldExtents, const string &name)
+   {
+      Vector<Rect> queries;
+      makeQueries(worldExtents, 2000, queries);
+
+      db->setBucketMode(GridDatabase::HashedBuckets);
+      Vector<Vector<DatabaseObject *> > hashedResults;
+      hashedResults.resize(queries.size());
+      for(S32 i = 0; i < queries.size(); i++)
+         hashedResults[i] = sortedQuery(db, queries[i]);
+
+      S32 hashedFound;
+      F64 hashedTime = runQueries(db, queries, hashedFound);
+
+      db->setBucketMode(GridDatabase::LevelBuckets);
+      db->fitBucketsToExtents(worldExtents);
+
+      for(S32 i = 0; i < queries.size(); i++)
+         ASSERT_EQ(hashedResults[i].getStlVector(), sortedQuery(db, queries[i]).getStlVector()) << name << ": query " << i;
+
+      S32 levelFound;
+      F64 levelTime = runQueries(db, queries, levelFound);
+
+      EXPECT_EQ(hashedFound, levelFound);
+
+      printf("[ GRIDBENCH ] %-20s %6d objects   hashed: %8.2f ms   level: %8.2f ms\n",
+             name.c_str(), db->getObjectCount(), hashedTime, levelTime);
+   }
+};
+
+
+// Objects must be found by the same queries regardless of how the grid is laid out, including objects outside the grid
+TEST_F(GridDatabaseTest, LevelBucketsMatchHashedBuckets)
+{
+   GridDatabase db(false);
+   db.setBucketMode(GridDatabase::LevelBuckets);
+
+   GridTestObject *inside  = new GridTestObject(TestItemTypeNumber, Rect(Point(100, 100), 10));
+   GridTestObject *outside = new GridTestObject(TestItemTypeNumber, Rect(Point(-5000, 9000), 10));
+   GridTestObject *huge    = new GridTestObject(WallItemTypeNumber, Rect(Point(-10000, -10000), Point(10000, 10000)));
+
+   db.addToDatabase(inside);
+   db.addToDatabase(outside);
+   db.addToDatabase(huge);
+
+   db.fitBucketsToExtents(Rect(Point(0, 0), Point(1000, 1000)));
+
+   EXPECT_EQ(2, sortedQuery(&db, Rect(Point(100, 100), 20)).size());
+   EXPECT_EQ(2, sortedQuery(&db, Rect(Point(-5000, 9000), 20)).size());
+   EXPECT_EQ(1, sortedQuery(&db, Rect(Point(500, 500), 20)).size());
+
+   // Moving an object off the grid and back should keep it findable
+   inside->setExtent(Rect(Point(20000, 20000), 10));
+   EXPECT_EQ(1, sortedQuery(&db, Rect(Point(100, 100), 20)).size());
+   EXPECT_EQ(1, sortedQuery(&db, Rect(Point(20000, 20000), 20)).size());
+
+   inside->setExtent(Rect(Point(100, 100), 10));
+   EXPECT_EQ(2, sortedQuery(&db, Rect(Point(100, 100), 20)).size());
+
+   // Switching back must leave everything findable as well
+   db.setBucketMode(GridDatabase::HashedBuckets);
+   EXPECT_EQ(2, sortedQuery(&db, Rect(Point(-5000, 9000), 20)).size());
+}
+
+
+static bool countVisits(DatabaseObject *object, void *context)
+{
+   (*static_cast<S32 *>(context))++;
+   return true;
+}
+
+
+struct NestedSearch
+{
+   const GridDatabase *db;
+   DatabaseQuery *innerQuery;
+   S32 innerFound;
+};
+
+
+// Runs a second search from inside the first, the way a visitor might
+static bool searchAgain(DatabaseObject *object, void *context)
+{
+   NestedSearch *search = static_cast<NestedSearch *>(context);
+
+   search->innerQuery->clear();
+   search->db->findObjects((TestFunc)isAnyObjectType, *search->innerQuery, object->getExtent());
+   search->innerFound += search->innerQuery->getResultCount();
+
+   return true;
+}
+
+
+// Objects spanning many buckets must be reported once per search, in both bucket modes, even when searches are nested
+TEST_F(GridDatabaseTest, ReentrantQueries)
+{
+   GridDatabase db(false);
+
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(100, 100), 10)));
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(2000, 500), 10)));
+   db.addToDatabase(new GridTestObject(WallItemTypeNumber, Rect(Point(-3000, -3000), Point(9000, 300))));   // Wraps in hashed mode
+   db.addToDatabase(new GridTestObject(WallItemTypeNumber, Rect(Point(0, 0), Point(600, 600))));
+
+   const Rect everything(Point(-10000, -10000), Point(10000, 10000));
+
+   for(S32 mode = 0; mode < 2; mode++)
+   {
+      db.setBucketMode(mode == 0 ? GridDatabase::HashedBuckets : GridDatabase::LevelBuckets);
+      db.fitBucketsToExtents(Rect(Point(0, 0), Point(2500, 2500)));
+
+      S32 visits = 0;
+      db.visitObjects((TestFunc)isAnyObjectType, everything, countVisits, &visits);
+      EXPECT_EQ(4, visits);
+
+      DatabaseQuery query;
+      db.findObjects((TestFunc)isAnyObjectType, query, everything);
+      EXPECT_EQ(4, query.getResultCount());
+
+      // Searching again without clearing finds nothing new
+      db.findObjects(WallItemTypeNumber, query, everything);
+      EXPECT_EQ(4, query.getResultCount());
+
+      query.clear();
+      db.findObjects(WallItemTypeNumber, query, everything);
+      EXPECT_EQ(2, query.getResultCount());
+
+      // Item at (100, 100) and both walls all overlap one another; the item at (2000, 500) overlaps only itself
+      DatabaseQuery innerQuery;
+      NestedSearch search = { &db, &innerQuery, 0 };
+      db.visitObjects((TestFunc)isAnyObjectType, everything, searchAgain, &search);
+      EXPECT_EQ(3 + 1 + 3 + 3, search.innerFound);
+   }
+}
+
+
+// Objects unmarked from a query's visited set must be forgotten without losing any of the others
+TEST_F(GridDatabaseTest, QueryUnmarksVisited)
+{
+   Vector<GridTestObject *> objects;
+   for(S32 i = 0; i < 300; i++)
+      objects.push_back(new GridTestObject(TestItemTypeNumber, Rect(Point(i, i), 1)));
+
+   DatabaseQuery query;
+   for(S32 i = 0; i < objects.size(); i++)
+      EXPECT_TRUE(query.markVisited(objects[i]));
+
+   for(S32 i = 0; i < objects.size(); i += 3)
+      EXPECT_TRUE(query.unmarkVisited(objects[i]));
+
+   for(S32 i = 0; i < objects.size(); i++)
+      EXPECT_EQ(i % 3 != 0, query.isVisited(objects[i])) << "object " << i;
+
+   EXPECT_FALSE(query.unmarkVisited(objects[0]));     // Already gone
+   EXPECT_TRUE(query.markVisited(objects[0]));        // And can be found again
+   EXPECT_TRUE(query.isVisited(objects[0]));
+
+   query.clear();
+   for(S32 i = 0; i < objects.size(); i++)
+      EXPECT_FALSE(query.isVisited(objects[i]));
+
+   for(S32 i = 0; i < objects.size(); i++)
+      delete objects[i];
+}
+
+
+// BfObject::deleteObject() changes an object's type while it's still in the database; removing it afterwards must take it
+// off the type list it was filed under
+TEST_F(GridDatabaseTest, RemoveAfterTypeChange)
+{
+   GridDatabase db(false);
+
+   GridTestObject *deleted = new GridTestObject(TestItemTypeNumber, Rect(Point(100, 100), 10));
+   GridTestObject *kept    = new GridTestObject(TestItemTypeNumber, Rect(Point(120, 100), 10));
+
+   db.addToDatabase(deleted);
+   db.addToDatabase(kept);
+
+   deleted->setObjectTypeNumber(DeletedTypeNumber);      // What deleteObject() does
+
+   // Searches by type no longer find it, even though it's still listed
+   Vector<DatabaseObject *> found;
+   db.findObjects(TestItemTypeNumber, found);
+   ASSERT_EQ(1, found.size());
+   EXPECT_EQ(kept, found[0]);
+
+   found.clear();
+   db.findObjects(TestItemTypeNumber, found, Rect(Point(100, 100), 50));
+   ASSERT_EQ(1, found.size());
+   EXPECT_EQ(kept, found[0]);
+
+   db.removeFromDatabase(deleted, true);
+
+   EXPECT_EQ(1, db.getObjectCount());
+   EXPECT_EQ(1, db.getObjectCount(TestItemTypeNumber));
+   ASSERT_EQ(1, db.findObjects_fast(TestItemTypeNumber)->size());
+   EXPECT_EQ(kept, db.findObjects_fast(TestItemTypeNumber)->get(0));
+   EXPECT_EQ(0, db.findObjects_fast(DeletedTypeNumber)->size());
+}
+
+
+// Area searches that go through the type lists must find things in the same order as the buckets would -- collision
+// checks depend on it
+TEST_F(GridDatabaseTest, TypeListsKeepSearchOrder)
+{
+   GridDatabase db(false);
+
+   // Few enough objects that most of these searches will use the type lists
+   for(S32 i = 0; i < 12; i++)
+   {
+      Point center(TNL::Random::readF() * 3000, TNL::Random::readF() * 3000);
+      U8 type = (i % 3 == 0) ? WallItemTypeNumber : TestItemTypeNumber;
+      db.addToDatabase(new GridTestObject(type, Rect(center, 10 + TNL::Random::readF() * 500)));
+   }
+
+   Vector<Rect> queries;
+   for(S32 i = 0; i < 500; i++)
+      queries.push_back(Rect(Point(TNL::Random::readF() * 3000, TNL::Random::readF() * 3000), 300 + TNL::Random::readF() * 1200));
+
+   for(S32 mode = 0; mode < 2; mode++)
+   {
+      db.setBucketMode(mode == 0 ? GridDatabase::HashedBuckets : GridDatabase::LevelBuckets);
+      db.fitBucketsToExtents(Rect(Point(0, 0), Point(3000, 3000)));
+
+      for(S32 i = 0; i < queries.size(); i++)
+      {
+         Vector<DatabaseObject *> indexed, unindexed;
+
+         db.setTypeIndexEnabled(true);
+         db.findObjects((TestFunc)isAnyObjectType, indexed, queries[i]);
+
+         db.setTypeIndexEnabled(false);
+         db.findObjects((TestFunc)isAnyObjectType, unindexed, queries[i]);
+
+         ASSERT_EQ(unindexed.getStlVector(), indexed.getStlVector()) << "mode " << mode << ", query " << i;
+      }
+   }
+}
+
+
+// Type-filtered searches should return the same objects with or without the type index, while examining far fewer of them
+TEST_F(GridDatabaseTest, BenchmarkTypeFilteredCandidates)
+{
+   const Rect worldExtents(Point(-10000, -10000), Point(10000, 10000));
+   const U8 types[] = { WallItemTypeNumber, WallItemTypeNumber, WallItemTypeNumber, TestItemTypeNumber, TestItemTypeNumber,
+                        BulletTypeNumber, BulletTypeNumber, PlayerShipTypeNumber, GoalZoneTypeNumber };
+
+   GridDatabase db(false);
+   db.setBucketMode(GridDatabase::LevelBuckets);
+   db.fitBucketsToExtents(worldExtents);
+
+   for(S32 i = 0; i < 10000; i++)
+   {
+      Point pos(worldExtents.min.x + TNL::Random::readF() * worldExtents.getWidth(),
+                worldExtents.min.y + TNL::Random::readF() * worldExtents.getHeight());
+
+      db.addToDatabase(new GridTestObject(types[i % ARRAYSIZE(types)], Rect(pos, 10 + TNL::Random::readF() * 200)));
+   }
+
+   // Bullets come and go; make sure their types get cleared out of the buckets they leave
+   for(S32 i = 0; i < db.getObjectCount(); i++)
+   {
+      DatabaseObject *object = db.getObjectByIndex(i);
+      if(object->getObjectTypeNumber() == BulletTypeNumber)
+         object->setExtent(Rect(object->getExtent().getCenter() + Point(300, 300), 10));
+   }
+
+   Vector<Rect> queries;
+   makeQueries(worldExtents, 1000, queries);
+
+   const TestFunc testFuncs[]  = { (TestFunc)isShipType, (TestFunc)isProjectileType, (TestFunc)isZoneType, (TestFunc)isWallType };
+   const char *testFuncNames[] = { "ships",              "projectiles",              "zones",              "walls" };
+
+   for(S32 i = 0; i < ARRAYSIZE(testFuncs); i++)
+   {
+      U32 candidates[2];
+      Vector<DatabaseObject *> results[2];
+
+      for(S32 indexed = 0; indexed < 2; indexed++)
+      {
+         db.setTypeIndexEnabled(indexed == 1);
+         db.resetCandidateCount();
+
+         db.findObjects(testFuncs[i], results[indexed]);
+
+         for(S32 j = 0; j < queries.size(); j++)
+            db.findObjects(testFuncs[i], results[indexed], queries[j]);
+
+         candidates[indexed] = db.getCandidateCount();
+         std::sort(results[indexed].getStlVector().begin(), results[indexed].getStlVector().end());
+      }
+
+      EXPECT_EQ(results[0].getStlVector(), results[1].getStlVector()) << testFuncNames[i];
+      EXPECT_LE(candidates[1], candidates[0]) << testFuncNames[i];
+
+      printf("[ GRIDBENCH ] %-12s %7d found   candidates before: %9d   after: %9d\n",
+             testFuncNames[i], results[1].size(), candidates[0], candidates[1]);
+   }
+
+   // Whole-map searches for a single type should only look at objects of that type
+   db.resetCandidateCount();
+   fillVector.clear();
+   db.findObjects((TestFunc)isShipType, fillVector);
+   EXPECT_EQ(db.getObjectCount(PlayerShipTypeNumber), fillVector.size());
+   EXPECT_EQ(U32(fillVector.size()), db.getCandidateCount());
+}
+
+
+TEST_F(GridDatabaseTest, BenchmarkBundledLevels)
+{
+   const string extensions[] = { "level" };
+   Vector<string> levels;
+   getFilesFromFolder("levels", levels, extensions, ARRAYSIZE(extensions));
+
+   ASSERT_TRUE(levels.size() > 0);
+
+   for(S32 i = 0; i < levels.size(); i++)
+   {
+      ServerGame *game = newServerGame();
+      GridDatabase *db = game->getGameObjDatabase();
+
+      game->loadLevelFromString(readFile(joindir("levels", levels[i])), db);
+      game->computeWorldObjectExtents();
+
+      compareModes(db, *game->getWorldExtents(), levels[i]);
+
+      delete game;
+   }
+}
+
+
+TEST_F(GridDatabaseTest, BenchmarkSynthetic20k)
+{
+   const S32 ObjectCount = 20000;
+   const Rect worldExtents(Point(-20000, -20000), Point(20000, 20000));
+
+   GridDatabase db(false);
+
+   for(S32 i = 0; i < ObjectCount; i++)
+   {
+      Point pos(worldExtents.min.x + TNL::Random::readF() * worldExtents.getWidth(),
+                worldExtents.min.y + TNL::Random::readF() * worldExtents.getHeight());
+
+      // Mostly small items, with the occasional long wall
+      F32 size = (i % 50 == 0) ? 2000 : 10 + TNL::Random::readF() * 40;
+      db.addToDatabase(new GridTestObject(i % 2 ? TestItemTypeNumber : WallItemTypeNumber, Rect(pos, size)));
+   }
+
+   compareModes(&db, worldExtents, "synthetic 20k");
+}
+
+
+};
@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlBitStream.h"
+#include "tnlHuffmanStringProcessor.h"
+#include "tnlPlatform.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+class HuffmanStringProcessorTest : public testing::Test
+{
+protected:
+   TestRandom mRandom;
+
+   HuffmanStringProcessorTest() : mRandom(12345)
+   {
+      // Do nothing
+   }
+
+   // Mostly chat-like text, with the odd rare character thrown in
+   void makeString(char *buffer, U32 len)
+   {
+      static const char *common = "etaoin shrdlu ETAOIN SHRDLU cmfwypvbgkjqxz.,!?'0123456789";
+
+      for(U32 i = 0; i < len; i++)
+         buffer[i] = mRandom.next(8) == 0 ? char(mRandom.next(255) + 1) : common[mRandom.next(U32(strlen(common)))];
+
+      buffer[len] = '\0';
+   }
+};
+
+
+// Bits written by the original coder, one code at a time; whatever we do, these have to come out the same
+TEST_F(HuffmanStringProcessorTest, MatchesOriginalEncoding)
+{
+   const U8 expected[] = { 0x1b, 0x9c, 0xfe, 0x18, 0x1a, 0xed, 0x2b, 0xd4, 0x46, 0xa8, 0x02 };    // "Hello, world!"
+
+   U8 buffer[64] = { 0 };
+   BitStream stream(buffer, sizeof(buffer));
+
+   HuffmanStringProcessor::writeHuffBuffer(&stream, "Hello, world!", 255);
+
+   ASSERT_EQ(sizeof(expected), stream.getBytePosition());
+   EXPECT_EQ(0, memcmp(expected, buffer, sizeof(expected)));
+
+   char out[256];
+   BitStream reader((U8 *)expected, sizeof(expected));
+   HuffmanStringProcessor::readHuffBuffer(&reader, out);
+   EXPECT_STREQ("Hello, world!", out);
+}
+
+
+// Random strings at random bit offsets, each read back from a stream that ends right where the string does
+TEST_F(HuffmanStringProcessorTest, RoundTrip)
+{
+   U8 buffer[512];
+   char in[256], out[256];
+
+   for(S32 i = 0; i < 2000; i++)
+   {
+      U32 offset = mRandom.next(16);
+      makeString(in, mRandom.next(256));
+
+      memset(buffer, 0, sizeof(buffer));
+      BitStream stream(buffer, sizeof(buffer));
+      stream.writeInt(mRandom.next(1 << offset), U8(offset));
+      HuffmanStringProcessor::writeHuffBuffer(&stream, in, 255);
+
+      BitStream reader(buffer, sizeof(buffer));
+      reader.setMaxBitSizes(stream.getBitPosition());
+      reader.setBitPosition(offset);
+      HuffmanStringProcessor::readHuffBuffer(&reader, out);
+
+      ASSERT_STREQ(in, out) << "String " << i;
+      ASSERT_EQ(stream.getBitPosition(), reader.getBitPosition()) << "String " << i;
+      ASSERT_TRUE(reader.isValid());
+   }
+}
+
+
+// Strings through BitStream, which compresses each against the one before
+TEST_F(HuffmanStringProcessorTest, RoundTripThroughStream)
+{
+   U8 buffer[8192] = { 0 };
+   char strings[64][256];
+   char out[256];
+
+   BitStream stream(buffer, sizeof(buffer));
+
+   for(S32 i = 0; i < 64; i++)
+   {
+      makeString(strings[i], mRandom.next(64));
+
+      if(i > 0 && mRandom.next(2) == 0)    // Share a prefix with the last one
+         memcpy(strings[i], strings[i - 1], min(strlen(strings[i]), strlen(strings[i - 1])) / 2);
+
+      stream.writeString(strings[i]);
+   }
+
+   BitStream reader(buffer, sizeof(buffer));
+   reader.setMaxBitSizes(stream.getBitPosition());
+
+   for(S32 i = 0; i < 64; i++)
+   {
+      reader.readString(out);
+      EXPECT_STREQ(strings[i], out) << "String " << i;
+   }
+
+   EXPECT_EQ(stream.getBitPosition(), reader.getBitPosition());
+}
+
+
+// Encode and decode throughput for chat-sized lines
+TEST_F(HuffmanStringProcessorTest, BenchmarkThroughput)
+{
+   const S32 StringCount = 1000;
+   const S32 Passes = 20;
+
+   char strings[StringCount][80];
+   U32 totalLength = 0;
+
+   for(S32 i = 0; i < StringCount; i++)
+   {
+      makeString(strings[i], mRandom.next(60) + 10);
+      totalLength += (U32)strlen(strings[i]);
+   }
+
+   static U8 buffer[StringCount * 80];
+   BitStream stream(buffer, sizeof(buffer));
+
+   S64 start = Platform::getHighPrecisionTimerValue();
+
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      stream.setBitPosition(0);
+      for(S32 i = 0; i < StringCount; i++)
+         HuffmanStringProcessor::writeHuffBuffer(&stream, strings[i], 255);
+   }
+
+   F64 encodeMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   BitStream reader(buffer, sizeof(buffer));
+   reader.setMaxBitSizes(stream.getBitPosition());
+   char out[256];
+
+   start = Platform::getHighPrecisionTimerValue();
+
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      reader.setBitPosition(0);
+      for(S32 i = 0; i < StringCount; i++)
+         HuffmanStringProcessor::readHuffBuffer(&reader, out);
+   }
+
+   F64 decodeMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   EXPECT_STREQ(strings[StringCount - 1], out);
+
+   F64 megabytes = F64(totalLength) * Passes / (1024 * 1024);
+   printf("[ HUFFBENCH  ] %d strings x %d   encode %8.2f MB/s   decode %8.2f MB/s\n",
+          StringCount, Passes, megabytes / (encodeMs / 1000), megabytes / (decodeMs / 1000));
+}
+
+
+};
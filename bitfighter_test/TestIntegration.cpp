@@ -11,6 +11,7 @@
 #include "Teleporter.h"
 #include "PickupItem.h"
 #include "barrier.h"
+#include "EngineeredItem.h"
 #include "gameType.h"
 
 #include "TestUtils.h"
@@ -258,4 +259,46 @@ TEST(IntegrationTest, LevelReadingAndItemPropagation)
    }
 }   
 
+
+// Turrets pack their partial updates once and copy them to every other client that needs the same update
+TEST(IntegrationTest, SharedUpdatePropagation)
+{
+   GamePair gamePair(getLevelCode1(), 3);
+
+   const Vector<ClientGame *> *clientGames = GameManager::getClientGames();
+   ServerGame *serverGame = GameManager::getServerGame();
+
+   Turret *turret = new Turret(TEAM_NEUTRAL, Point(-500, -500), Point(0, 1));
+   turret->addToGame(serverGame, serverGame->getGameObjDatabase());
+   ASSERT_TRUE(turret->sharesUpdates());
+
+   GamePair::idle(10, 5);     // Ghost it everywhere -- initial updates are never shared
+
+   NetClassRep *classRep = turret->getClassRep();
+   U32 hits = classRep->getSharedUpdateHits();
+
+   DamageInfo damageInfo;
+   damageInfo.damageAmount = 0.5f;
+   turret->damageObject(&damageInfo);
+
+   GamePair::idle(10, 5);
+
+   // Test connections all send every tick, so the first one packs the health update and the rest copy it
+   EXPECT_LE(hits + U32(clientGames->size()) - 1, classRep->getSharedUpdateHits());
+
+   Vector<DatabaseObject *> fillVector;
+
+   for(S32 i = 0; i < clientGames->size(); i++)
+   {
+      SCOPED_TRACE("i = " + itos(i));
+
+      fillVector.clear();
+      clientGames->get(i)->getGameObjDatabase()->findObjects(TurretTypeNumber, fillVector);
+      ASSERT_EQ(1, fillVector.size());
+
+      // Health is sent with 5 bits of precision
+      EXPECT_NEAR(turret->getHealth(), static_cast<Turret *>(fillVector[0])->getHealth(), 0.05f);
+   }
+}
+
 };
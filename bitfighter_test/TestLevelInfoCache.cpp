@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelInfoCache.h"
+#include "stringUtils.h"
+
+#include "tnlNetBase.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+namespace Zap
+{
+
+static string makeLevelCode(S32 index)
+{
+   return "GameType 10 8\n"
+          "LevelName Test Level " + itos(index) + "\n"
+          "MinPlayers " + itos(index % 4) + "\n"
+          "MaxPlayers " + itos(index % 4 + 4) + "\n"
+          "Script script" + itos(index) + ".lua\n"
+          "Team Blue 0 0 1\n";
+}
+
+
+static string getTestLevelFilename(S32 index)
+{
+   return "levelinfocache_test_" + itos(index) + ".level";
+}
+
+
+TEST(LevelInfoCacheTest, ReadHeader)
+{
+   NetClassRep::initialize();    // Normally done by the NetInterface; we need it to look up game types
+
+   string code = "CTFGameType 10 8\nLevelName Capture the Bagel\nMaxPlayers 6\nTeam Blue 0 0 1\n";
+
+   LevelInfoHeader header;
+   LevelSource::getLevelInfoHeaderFromCodeChunk(code.c_str(), (S32)code.length(), header);
+
+   EXPECT_EQ("CTFGameType", header.gameTypeName);
+   EXPECT_EQ("Capture the Bagel", header.levelName);
+   EXPECT_EQ(0, header.minRecPlayers);
+   EXPECT_EQ(6, header.maxRecPlayers);
+   EXPECT_EQ("", header.scriptFileName);
+
+   // Same result as the old all-in-one path
+   LevelInfo levelInfo, expected;
+   header.populateLevelInfo(levelInfo);
+   LevelSource::getLevelInfoFromCodeChunk(&code[0], (S32)code.length(), expected);
+
+   EXPECT_EQ(CTFGame, levelInfo.mLevelType);
+   EXPECT_EQ(expected.mLevelType, levelInfo.mLevelType);
+   EXPECT_EQ(expected.mLevelName, levelInfo.mLevelName);
+   EXPECT_EQ(expected.maxRecPlayers, levelInfo.maxRecPlayers);
+}
+
+
+// Scan a pile of levels in parallel, save what we found, and make sure a second scan uses it -- except for files
+// that have changed
+TEST(LevelInfoCacheTest, ScanAndReload)
+{
+   const S32 LevelCount = LevelInfoCache::FilesPerThread * 3 + 1;    // Enough to need several threads
+   const string CacheFile = "levelinfocache_test.cache";
+
+   Vector<string> filenames;
+   for(S32 i = 0; i < LevelCount; i++)
+   {
+      filenames.push_back(getTestLevelFilename(i));
+      ASSERT_TRUE(writeFile(filenames[i], makeLevelCode(i)));
+   }
+
+   filenames.push_back("levelinfocache_test_missing.level");
+
+   Vector<LevelInfoHeader> headers;
+   Vector<bool> found;
+
+   LevelInfoCache cache;
+   EXPECT_FALSE(cache.load(CacheFile));
+
+   cache.scan(filenames, headers, found);
+
+   ASSERT_EQ(LevelCount + 1, headers.size());
+   ASSERT_EQ(LevelCount + 1, found.size());
+   EXPECT_FALSE(found[LevelCount]);
+   EXPECT_EQ(LevelCount, cache.getEntryCount());
+
+   for(S32 i = 0; i < LevelCount; i++)
+   {
+      ASSERT_TRUE(found[i]);
+      EXPECT_EQ("GameType", headers[i].gameTypeName);
+      EXPECT_EQ("Test Level " + itos(i), headers[i].levelName);
+      EXPECT_EQ(i % 4, headers[i].minRecPlayers);
+      EXPECT_EQ(i % 4 + 4, headers[i].maxRecPlayers);
+      EXPECT_EQ("script" + itos(i) + ".lua", headers[i].scriptFileName);
+   }
+
+   ASSERT_TRUE(cache.save(CacheFile));
+
+   // Everything should come back from the cache file
+   LevelInfoCache reloaded;
+   EXPECT_TRUE(reloaded.load(CacheFile));
+   EXPECT_EQ(LevelCount, reloaded.getEntryCount());
+
+   S64 modifiedTime, size;
+   ASSERT_TRUE(getFileStats(filenames[3], modifiedTime, size));
+   ASSERT_TRUE(reloaded.findEntry(filenames[3], modifiedTime, size) != NULL);
+   EXPECT_EQ("Test Level 3", reloaded.findEntry(filenames[3], modifiedTime, size)->header.levelName);
+   EXPECT_TRUE(reloaded.findEntry(filenames[3], modifiedTime, size + 1) == NULL);     // Different size, no match
+
+   // Change one of the files (its size, since mtimes only go to the second), and get rid of another; the rest
+   // should come from the cache
+   ASSERT_TRUE(writeFile(filenames[5], "GameType\nLevelName A Whole New Level\n"));
+   remove(filenames[6].c_str());
+
+   reloaded.scan(filenames, headers, found);
+
+   EXPECT_EQ("A Whole New Level", headers[5].levelName);
+   EXPECT_EQ(0, headers[5].maxRecPlayers);
+   EXPECT_FALSE(found[6]);
+   EXPECT_EQ("Test Level 7", headers[7].levelName);
+   EXPECT_EQ(LevelCount - 1, reloaded.getEntryCount());
+
+   for(S32 i = 0; i < LevelCount; i++)
+      remove(filenames[i].c_str());
+   remove(CacheFile.c_str());
+}
+
+
+};
@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelPreloader.h"
+#include "BotNavMeshZone.h"
+#include "game.h"
+#include "stringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+namespace Zap
+{
+
+TEST(LevelPreloaderTest, PreloadAndTake)
+{
+   const string LevelFile = "levelpreloader_test.level";
+   const string LevelCode = "GameType 10 8\nLevelName Preloaded\nTeam Blue 0 0 1\n";
+
+   ASSERT_TRUE(writeFile(LevelFile, LevelCode));
+
+   string hash = Game::md5.getHashFromFile(LevelFile);
+   string navMeshFile = BotNavMeshZone::getCacheFileName(".", hash);
+   ASSERT_TRUE(writeFile(navMeshFile, "not really a nav mesh"));
+
+   LevelPreloader preloader;
+   LevelPreloader::Level level;
+
+   EXPECT_FALSE(preloader.isStarted());
+   EXPECT_FALSE(preloader.take(3, "levelpreloader_test.level", level));
+
+   // Everything we asked for should be there
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+   EXPECT_TRUE(preloader.isStarted());
+
+   ASSERT_TRUE(preloader.take(3, "levelpreloader_test.level", level));
+   EXPECT_EQ(LevelCode, level.contents);
+   EXPECT_EQ(hash, level.hash);
+   EXPECT_EQ("not really a nav mesh", level.navMeshData);
+   EXPECT_FALSE(preloader.isStarted());
+
+   // Only the level we preloaded will do
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+   EXPECT_FALSE(preloader.take(4, "levelpreloader_test.level", level));
+   EXPECT_FALSE(preloader.take(3, "levelpreloader_test.level", level));      // Gone now
+
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+   EXPECT_FALSE(preloader.take(3, "some_other.level", level));
+
+   // No nav mesh is fine; no level file is not
+   remove(navMeshFile.c_str());
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+   ASSERT_TRUE(preloader.take(3, "levelpreloader_test.level", level));
+   EXPECT_EQ("", level.navMeshData);
+
+   remove(LevelFile.c_str());
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+   EXPECT_FALSE(preloader.take(3, "levelpreloader_test.level", level));
+
+   // Leaving a preload running when the preloader goes away should be safe
+   preloader.start(3, "levelpreloader_test.level", LevelFile, ".");
+}
+
+
+// The hash has to be the hash of the file, byte order mark and all, or we'd miss the nav mesh cache
+TEST(LevelPreloaderTest, ByteOrderMark)
+{
+   const string LevelFile = "levelpreloader_bom_test.level";
+   const string LevelCode = "GameType 10 8\nLevelName Marked\n";
+
+   ASSERT_TRUE(writeFile(LevelFile, "\357\273\277" + LevelCode));
+
+   LevelPreloader preloader;
+   LevelPreloader::Level level;
+
+   preloader.start(0, LevelFile, LevelFile, ".");
+   ASSERT_TRUE(preloader.take(0, LevelFile, level));
+
+   EXPECT_EQ(LevelCode, level.contents);
+   EXPECT_EQ(Game::md5.getHashFromFile(LevelFile), level.hash);
+   EXPECT_EQ(readFile(LevelFile), level.contents);
+
+   remove(LevelFile.c_str());
+}
+
+
+};
@@ -6,8 +6,10 @@
 #include "TestUtils.h"
 #include "../zap/ServerGame.h"
 #include "../zap/gameType.h"
+#include "../zap/EventManager.h"
 #include "../zap/luaLevelGenerator.h"
 #include "../zap/SystemFunctions.h"
+#include "../zap/stringUtils.h"
 #include "gtest/gtest.h"
 
 namespace Zap
@@ -145,4 +147,194 @@ TEST_F(LuaEnvironmentTest, findAllObjects)
 }
 
 
+TEST_F(LuaEnvironmentTest, iterateObjects)
+{
+   EXPECT_TRUE(levelgen->runString("bf:addItem(ResourceItem.new(point.new(0,0)))"));
+   EXPECT_TRUE(levelgen->runString("bf:addItem(ResourceItem.new(point.new(300,300)))"));
+   EXPECT_TRUE(levelgen->runString("bf:addItem(TestItem.new(point.new(200,200)))"));
+
+   EXPECT_TRUE(levelgen->runString("n = 0; for obj in bf:iterateObjects() do n = n + 1 end"));
+   EXPECT_TRUE(levelgen->runString("assert(n == 3)"));
+
+   EXPECT_TRUE(levelgen->runString("n = 0; for obj in bf:iterateObjects(ObjType.ResourceItem) do n = n + 1 end"));
+   EXPECT_TRUE(levelgen->runString("assert(n == 2)"));
+
+   EXPECT_TRUE(levelgen->runString("n = 0; for obj in bf:iterateObjectsInArea(point.new(-10,-10), point.new(250,250), "
+                                   "ObjType.ResourceItem, ObjType.TestItem) do n = n + 1 end"));
+   EXPECT_TRUE(levelgen->runString("assert(n == 2)"));
+
+   // Objects removed during the loop don't turn up later in it
+   EXPECT_TRUE(levelgen->runString("n = 0; for obj in bf:iterateObjects() do n = n + 1; "
+                                   "for other in bf:iterateObjects() do if other ~= obj then other:removeFromGame() end end end"));
+   EXPECT_TRUE(levelgen->runString("assert(n == 1)"));
+}
+
+
+// Objects handed out by iterateObjects() are held until the next tick starts
+TEST_F(LuaEnvironmentTest, iterateObjectsHoldsForTick)
+{
+   EXPECT_TRUE(levelgen->runString("bf:addItem(ResourceItem.new(point.new(0,0)))"));
+   EXPECT_TRUE(levelgen->runString("bf:addItem(TestItem.new(point.new(200,200)))"));
+
+   LuaScriptRunner::beginTick();
+   EXPECT_TRUE(levelgen->runString("for obj in bf:iterateObjects() do end"));
+   EXPECT_TRUE(levelgen->runString("for obj in bf:iterateObjects(ObjType.TestItem) do end"));
+
+   S32 held = 0;
+   lua_getfield(L, LUA_REGISTRYINDEX, "TickObjects");
+   for(lua_pushnil(L); lua_next(L, -2); lua_pop(L, 1))
+      held++;
+   lua_pop(L, 1);
+
+   EXPECT_EQ(2, held);     // Once each, no matter how many times we saw them
+
+   LuaScriptRunner::beginTick();
+
+   lua_getfield(L, LUA_REGISTRYINDEX, "TickObjects");
+   lua_pushnil(L);
+   EXPECT_EQ(0, lua_next(L, -2));
+   lua_pop(L, 1);
+}
+
+
+TEST_F(LuaEnvironmentTest, cpuBudget)
+{
+   // A call that runs too long gets stopped, and the script sits out the next tick, but isn't killed
+   LuaScriptRunner::setBudgets(0, 10);
+   EXPECT_TRUE(levelgen->runString("n = 0; function spin() n = n + 1; while true do end end"));
+
+   LuaScriptRunner::beginTick();
+   EXPECT_TRUE(levelgen->runCmd("spin", 0));       // Returns true on error
+   EXPECT_FALSE(levelgen->isSkippingTick());
+
+   LuaScriptRunner::beginTick();
+   EXPECT_TRUE(levelgen->isSkippingTick());
+
+   LuaScriptRunner::beginTick();
+   EXPECT_FALSE(levelgen->isSkippingTick());
+   EXPECT_TRUE(levelgen->runString("assert(n == 1)"));
+
+   // Going over the soft budget lets the call finish, then skips the next tick
+   LuaScriptRunner::setBudgets(1, 0);
+   EXPECT_TRUE(levelgen->runString("function busy() for i = 1, 50000000 do n = i end end"));
+
+   LuaScriptRunner::beginTick();
+   EXPECT_FALSE(levelgen->runCmd("busy", 0));
+   EXPECT_TRUE(levelgen->runString("assert(n == 50000000)"));
+
+   LuaScriptRunner::beginTick();
+   EXPECT_TRUE(levelgen->isSkippingTick());
+
+   LuaScriptRunner::setBudgets(0, 0);
+}
+
+
+TEST_F(LuaEnvironmentTest, profile)
+{
+   LuaScriptRunner::setProfiling(true);
+
+   EXPECT_TRUE(levelgen->runString("function busy() for i = 1, 100000 do n = i end end"));
+   EXPECT_FALSE(levelgen->runCmd("busy", 0));
+
+   Vector<string> lines;
+   levelgen->getProfile(lines, 5);
+
+   ASSERT_EQ(2, lines.size());      // The script, and the one function it ran
+   EXPECT_NE(string::npos, lines[1].find("busy"));
+   EXPECT_GT(levelgen->getTotalTime(), 0);
+
+   levelgen->resetProfile();
+   lines.clear();
+   levelgen->getProfile(lines, 5);
+   EXPECT_EQ(1, lines.size());
+
+   LuaScriptRunner::setProfiling(false);
+}
+
+
+TEST_F(LuaEnvironmentTest, events)
+{
+   LuaLevelGenerator levelgen2(serverGame);
+   EXPECT_TRUE(levelgen2.prepareEnvironment());
+
+   EventManager *events = EventManager::get();
+   events->resetDispatchStats();
+
+   const char *Handlers = "got = { }; function onScoreChanged(score, team) table.insert(got, score + team) end; "
+                          "function onMsgReceived(message) table.insert(got, message) end; "
+                          "subscribe(Event.ScoreChanged); subscribe(Event.MsgReceived)";
+
+   EXPECT_TRUE(levelgen->runString(Handlers));
+   EXPECT_TRUE(levelgen2.runString(Handlers));
+   events->update();
+
+   // Every subscriber gets the same args
+   events->fireEvent(EventManager::ScoreChangedEvent, 5, 1, NULL);
+   EXPECT_TRUE(levelgen->runString("assert(#got == 1 and got[1] == 6)"));
+   EXPECT_TRUE(levelgen2.runString("assert(#got == 1 and got[1] == 6)"));
+
+   // ...except the sender of a message
+   events->fireEvent(levelgen, EventManager::MsgReceivedEvent, "hello", NULL, true);
+   EXPECT_TRUE(levelgen->runString("assert(#got == 1)"));
+   EXPECT_TRUE(levelgen2.runString("assert(#got == 2 and got[2] == 'hello')"));
+
+   // Unsubscribing takes effect on the next update, and resubscribing after that works
+   EXPECT_TRUE(levelgen->runString("unsubscribe(Event.ScoreChanged)"));
+   events->fireEvent(EventManager::ScoreChangedEvent, 1, 1, NULL);
+   events->update();
+   events->fireEvent(EventManager::ScoreChangedEvent, 2, 1, NULL);
+   EXPECT_TRUE(levelgen->runString("assert(#got == 2)"));
+   EXPECT_TRUE(levelgen2.runString("assert(#got == 4 and got[4] == 3)"));
+
+   EXPECT_TRUE(levelgen->runString("subscribe(Event.ScoreChanged)"));
+   events->update();
+   events->fireEvent(EventManager::ScoreChangedEvent, 3, 1, NULL);
+   EXPECT_TRUE(levelgen->runString("assert(#got == 3 and got[3] == 4)"));
+
+   Vector<string> lines;
+   events->getDispatchStats(lines);
+
+   ASSERT_EQ(2, lines.size());      // MsgReceived, then ScoreChanged
+   EXPECT_EQ(0, lines[0].find("MsgReceived events: 1 fired"));
+   EXPECT_EQ(0, lines[1].find("ScoreChanged events: 4 fired"));
+}
+
+
+TEST(LuaBytecodeCacheTest, cacheAndReload)
+{
+   const string CacheDir = "bytecode_test";
+   const string Extensions[] = { "luac" };
+
+   ServerGame *serverGame = newServerGame();
+   string luaDir = serverGame->getSettings()->getFolderManager()->luaDir;
+
+   LuaScriptRunner::setBytecodeCacheDir(CacheDir);
+
+   // Starting Lua compiles the helper scripts, which fills the cache
+   ASSERT_TRUE(LuaScriptRunner::startLua(luaDir));
+   LuaScriptRunner::shutdown();
+
+   Vector<string> files;
+   getFilesFromFolder(CacheDir, files, Extensions, ARRAYSIZE(Extensions));
+   ASSERT_GT(files.size(), 0);
+
+   // Next time they come from the cache; a damaged file just gets compiled again and replaced
+   string cacheFile = joindir(CacheDir, files[0]);
+   ASSERT_TRUE(writeFile(cacheFile, "\033garbage"));
+
+   ASSERT_TRUE(LuaScriptRunner::startLua(luaDir));
+   LuaScriptRunner::shutdown();
+
+   EXPECT_NE("\033garbage", readFile(cacheFile));
+
+   LuaScriptRunner::setBytecodeCacheDir("");
+
+   for(S32 i = 0; i < files.size(); i++)
+      remove(joindir(CacheDir, files[i]).c_str());
+   remove(CacheDir.c_str());
+
+   delete serverGame;
+}
+
+
 };
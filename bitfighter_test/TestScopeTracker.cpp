@@ -0,0 +1,236 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ScopeTracker.h"
+#include "moveObject.h"
+
+#include "tnlGhostConnection.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+// GhostConnection that scopes without a NetInterface or anyone on the other end, and lets us see what's marked always in scope
+class ScopeTestConnection : public GhostConnection
+{
+public:
+   ScopeTestConnection()
+   {
+      setGhostFrom(true);
+
+      mGhostClassCount = NetClassRep::getNetClassCount(getNetClassGroup(), NetClassTypeObject);
+      mGhostClassBitSize = NetClassRep::getNetClassBitSize(getNetClassGroup(), NetClassTypeObject);
+
+      mScoping = true;
+      mGhosting = true;
+   }
+
+   NetClassGroup getNetClassGroup() const { return NetClassGroupGame; }
+
+   bool isScopedAlways(NetObject *obj)
+   {
+      for(GhostInfo *walk = mGhostLookupTable[obj->getHashId() & GhostLookupTableMask]; walk; walk = walk->nextLookupInfo)
+         if(walk->obj == obj)
+            return (walk->flags & GhostInfo::ScopeLocalAlways) != 0;
+
+      return false;
+   }
+};
+
+
+class ScopeTrackerTest : public testing::Test
+{
+protected:
+   GridDatabase mDatabase;
+   ScopeTracker mTracker;
+   Vector<TestItem *> mItems;
+
+   ScopeTrackerTest() : mDatabase(false)
+   {
+      // Do nothing
+   }
+
+   void SetUp()
+   {
+      NetClassRep::initialize();    // Normally done by the NetInterface
+      mTracker.setDatabase(&mDatabase);
+   }
+
+   void TearDown()
+   {
+      mTracker.setDatabase(NULL);
+      mDatabase.removeEverythingFromDatabase();    // Deletes the items
+   }
+
+   TestItem *addItem(const Point &pos)
+   {
+      TestItem *item = new TestItem();
+      item->setPos(pos);
+      item->addToDatabase(&mDatabase);
+      mItems.push_back(item);
+      return item;
+   }
+
+   // Checks that exactly the items overlapping range are marked always in scope
+   void checkScope(ScopeTestConnection &conn, const Rect &range)
+   {
+      for(S32 i = 0; i < mItems.size(); i++)
+      {
+         Rect extent = mItems[i]->getExtent();
+         EXPECT_EQ(extent.intersects(range), conn.isScopedAlways(mItems[i])) << "Item " << i << " at " <<
+               mItems[i]->getPos().toString();
+      }
+   }
+};
+
+
+TEST_F(ScopeTrackerTest, ObjectsMovingInAndOut)
+{
+   ScopeTestConnection conn;
+   Rect range(Point(0, 0), 1000);
+
+   TestItem *inside  = addItem(Point(100, 100));
+   TestItem *outside = addItem(Point(2000, 0));
+
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+
+   EXPECT_TRUE(conn.isScopedAlways(inside));
+   EXPECT_FALSE(conn.isScopedAlways(outside));
+
+   // Swap places
+   inside->setPos(Point(-2000, 0));
+   outside->setPos(Point(0, 200));
+
+   mTracker.resetCounts();
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+
+   EXPECT_FALSE(conn.isScopedAlways(inside));
+   EXPECT_TRUE(conn.isScopedAlways(outside));
+   EXPECT_EQ(1, mTracker.getEnterCount());
+   EXPECT_EQ(1, mTracker.getLeaveCount());
+
+   // Nothing moved, so nothing to do
+   mTracker.resetCounts();
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+
+   EXPECT_EQ(0, mTracker.getEnterCount());
+   EXPECT_EQ(0, mTracker.getLeaveCount());
+
+   // A connection that isn't updated loses what we put in scope for it
+   mTracker.endUpdate();
+   EXPECT_FALSE(conn.isScopedAlways(outside));
+}
+
+
+// Random walks for both the items and the scope range should leave us with the same scope as searching the whole range
+TEST_F(ScopeTrackerTest, MatchesFullSearch)
+{
+   ScopeTestConnection conn;
+   TestRandom random(12345);
+
+   for(S32 i = 0; i < 200; i++)
+   {
+      F32 x = F32(random.next(6000)) - 3000;
+      F32 y = F32(random.next(6000)) - 3000;
+      addItem(Point(x, y));
+   }
+
+   Point center(0, 0);
+
+   for(S32 step = 0; step < 100; step++)
+   {
+      for(S32 i = 0; i < mItems.size(); i++)
+      {
+         if(random.next(4) != 0)
+            continue;
+
+         F32 dx = F32(random.next(201)) - 100;
+         F32 dy = F32(random.next(201)) - 100;
+         mItems[i]->setPos(mItems[i]->getPos() + Point(dx, dy));
+      }
+
+      F32 dx = F32(random.next(101)) - 50;
+      F32 dy = F32(random.next(101)) - 50;
+      center += Point(dx, dy);
+
+      Rect range(center, center);
+      range.expand(Point(1000, 600));
+
+      mTracker.updateConnection(&conn, range);
+      mTracker.endUpdate();
+
+      checkScope(conn, range);
+   }
+}
+
+
+TEST_F(ScopeTrackerTest, RemovedObjects)
+{
+   ScopeTestConnection conn;
+   Rect range(Point(0, 0), 1000);
+
+   TestItem *item = addItem(Point(100, 100));
+
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+   EXPECT_TRUE(conn.isScopedAlways(item));
+
+   // Moved, then removed before the next update; it shouldn't be looked at again
+   item->setPos(Point(200, 200));
+   item->removeFromDatabase(false);
+   mItems.clear();
+
+   mTracker.resetCounts();
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+
+   EXPECT_EQ(0, mTracker.getEnterCount());
+   EXPECT_EQ(0, mTracker.getLeaveCount());
+
+   delete item;
+}
+
+
+// Removing an object without deleting it takes it out of scope, so it can come back outside the range without staying in
+TEST_F(ScopeTrackerTest, RemovedAndReadded)
+{
+   ScopeTestConnection conn;
+   Rect range(Point(0, 0), 1000);
+
+   TestItem *item = addItem(Point(100, 100));
+
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+   EXPECT_TRUE(conn.isScopedAlways(item));
+
+   item->removeFromDatabase(false);
+   EXPECT_FALSE(conn.isScopedAlways(item));
+
+   item->setPos(Point(2000, 0));
+   item->addToDatabase(&mDatabase);
+
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+   EXPECT_FALSE(conn.isScopedAlways(item));
+
+   // And back inside again
+   item->setPos(Point(0, 200));
+
+   mTracker.updateConnection(&conn, range);
+   mTracker.endUpdate();
+   EXPECT_TRUE(conn.isScopedAlways(item));
+}
+
+
+};
@@ -165,4 +165,81 @@ TEST(ServerGameTest, LoadoutManagementTests)
 }
 
 
+// Runs a ship at full speed through a fixed-step game, feeding it the given frame times; returns where it ends up
+static Point runFixedStepShip(const Vector<U32> &frameTimes, U32 *simulatedTime = NULL, U32 *overruns = NULL)
+{
+   ServerGame *serverGame = newServerGame();
+   serverGame->getSettings()->getIniSettings()->fixedTimeStep = 16;
+
+   GameType *gt = new GameType();    // Will be deleted in serverGame destructor
+   gt->addToGame(serverGame, serverGame->getGameObjDatabase());
+   serverGame->unsuspendGame(false);
+
+   SafePtr<Ship> ship = new Ship;
+   ship->addToGame(serverGame, serverGame->getGameObjDatabase());
+   ship->setMove(Move(1,0));
+
+   U32 startTime = serverGame->getCurrentTime();
+
+   for(S32 i = 0; i < frameTimes.size(); i++)
+      serverGame->idle(frameTimes[i]);
+
+   Point pos = ship->getPos();
+
+   if(simulatedTime)
+      *simulatedTime = serverGame->getCurrentTime() - startTime;
+   if(overruns)
+      *overruns = serverGame->getSimulationOverruns();
+
+   delete serverGame;
+
+   return pos;
+}
+
+
+TEST(ServerGameTest, FixedTimeStep)
+{
+   Vector<U32> frames;
+   U32 simulatedTime;
+
+   // Less than a step: nothing happens yet
+   frames.push_back(10);
+   EXPECT_EQ(Point(0,0), runFixedStepShip(frames, &simulatedTime));
+   EXPECT_EQ(0, simulatedTime);
+
+   // Now we have one step, with 4 ms left over
+   frames.push_back(10);
+   EXPECT_NE(Point(0,0), runFixedStepShip(frames, &simulatedTime));
+   EXPECT_EQ(16, simulatedTime);
+
+   // However the frames fall, the same amount of time gives exactly the same game
+   Vector<U32> evenFrames, unevenFrames;
+   for(S32 i = 0; i < 30; i++)
+      evenFrames.push_back(16);
+
+   unevenFrames.push_back(5);
+   unevenFrames.push_back(40);
+   unevenFrames.push_back(100);
+   unevenFrames.push_back(1);
+   unevenFrames.push_back(150);
+   unevenFrames.push_back(184);   // 480 ms in all, same as the even frames
+
+   Point evenPos = runFixedStepShip(evenFrames);
+   Point unevenPos = runFixedStepShip(unevenFrames, &simulatedTime);
+
+   EXPECT_EQ(480, simulatedTime);
+   EXPECT_EQ(evenPos.x, unevenPos.x);     // Bit-for-bit
+   EXPECT_EQ(evenPos.y, unevenPos.y);
+
+   // A long stall only gets caught up to a point
+   Vector<U32> stall;
+   stall.push_back(1000);
+
+   U32 overruns;
+   runFixedStepShip(stall, &simulatedTime, &overruns);
+   EXPECT_EQ(1, overruns);
+   EXPECT_EQ(ServerGame::MaxCatchUpTime / 16 * 16, simulatedTime);
+}
+
+
 };
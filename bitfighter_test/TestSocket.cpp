@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlUDP.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace TNL;
+
+// Fill a packet with bytes that depend on its position, so we can tell if they got mixed up
+static void fillPacket(U8 *data, S32 size, S32 index)
+{
+   for(S32 i = 0; i < size; i++)
+      data[i] = U8(index * 31 + i);
+}
+
+
+// Send a bunch of packets over loopback, and make sure they all arrive intact and in order
+static void sendAndReceive(bool batchedSend, bool batchedReceive)
+{
+   const S32 PacketCount = PacketBatch::MaxPackets + 8;    // More than fit in one batch
+
+   Socket sender(Address("IP:127.0.0.1:0"));
+   Socket receiver(Address("IP:127.0.0.1:0"), Socket::DefaultBufferSize, 1024 * 1024);  // Room for them all
+
+   ASSERT_TRUE(sender.isValid());
+   ASSERT_TRUE(receiver.isValid());
+
+   sender.setBatchedIO(batchedSend);
+   receiver.setBatchedIO(batchedReceive);
+
+   Address senderAddress = sender.getBoundAddress();
+   Address receiverAddress = receiver.getBoundAddress();
+
+   // Sizes vary, from empty to the largest packet we allow
+   S32 sizes[PacketCount];
+   for(S32 i = 0; i < PacketCount; i++)
+      sizes[i] = (i * 397) % (MaxPacketDataSize + 1);
+   sizes[1] = MaxPacketDataSize;
+
+   PacketBatch sendBatch;
+   U8 data[MaxPacketDataSize];
+
+   for(S32 i = 0; i < PacketCount; i++)
+   {
+      if(sendBatch.isFull())
+      {
+         EXPECT_EQ(NoError, sender.sendtoBatch(sendBatch));
+         sendBatch.clear();
+      }
+
+      fillPacket(data, sizes[i], i);
+      ASSERT_TRUE(sendBatch.add(receiverAddress, data, sizes[i]));
+   }
+
+   EXPECT_EQ(NoError, sender.sendtoBatch(sendBatch));
+
+   // Loopback is quick, but give the packets a moment if they aren't all there right away
+   PacketBatch receiveBatch;
+   S32 received = 0;
+
+   for(S32 tries = 0; received < PacketCount && tries < 100; tries++)
+   {
+      if(receiver.recvfromBatch(&receiveBatch) != NoError)
+      {
+         Platform::sleep(10);
+         continue;
+      }
+
+      ASSERT_LT(0, receiveBatch.getCount());
+      ASSERT_GE(PacketBatch::MaxPackets, receiveBatch.getCount());
+
+      for(S32 i = 0; i < receiveBatch.getCount(); i++, received++)
+      {
+         const PacketBatch::Packet &packet = receiveBatch.get(i);
+
+         ASSERT_GT(PacketCount, received);
+         EXPECT_EQ(senderAddress.port, packet.address.port);
+         ASSERT_EQ(sizes[received], packet.size);
+
+         fillPacket(data, sizes[received], received);
+         EXPECT_EQ(0, memcmp(data, packet.data, packet.size)) << "packet " << received;
+      }
+   }
+
+   EXPECT_EQ(PacketCount, received);
+   EXPECT_EQ(WouldBlock, receiver.recvfromBatch(&receiveBatch));
+   EXPECT_EQ(0, receiveBatch.getCount());
+}
+
+
+TEST(SocketTest, BatchedLoopback)
+{
+   sendAndReceive(true, true);
+}
+
+
+// The one-packet-at-a-time fallback, and mixing it with the batched path, should look the same from the outside
+TEST(SocketTest, UnbatchedLoopback)
+{
+   sendAndReceive(false, false);
+   sendAndReceive(true, false);
+   sendAndReceive(false, true);
+}
+
+
+// A socket that can't be read from, rather than one with nothing waiting, should say so, whichever way it reads
+TEST(SocketTest, ReceiveErrors)
+{
+   Address address(IPProtocol, Address::Localhost, 0);
+   address.transport = TCPProtocol;
+
+   Socket unconnected(address);    // Reads fail outright, as nothing is connected
+   ASSERT_TRUE(unconnected.isValid());
+
+   PacketBatch batch;
+
+   unconnected.setBatchedIO(true);
+   EXPECT_EQ(Socket::supportsBatchedIO() ? UnknownError : WouldBlock, unconnected.recvfromBatch(&batch));
+   EXPECT_EQ(0, batch.getCount());
+
+   Socket empty(Address("IP:127.0.0.1:0"));
+   EXPECT_EQ(WouldBlock, empty.recvfromBatch(&batch));
+}
+
+
+TEST(SocketTest, BatchLimits)
+{
+   PacketBatch batch;
+   U8 data[MaxPacketDataSize + 1] = { 0 };
+   Address address(IPProtocol, Address::Localhost, 1);
+
+   EXPECT_FALSE(batch.add(address, data, MaxPacketDataSize + 1));
+   EXPECT_EQ(0, batch.getCount());
+
+   for(S32 i = 0; i < PacketBatch::MaxPackets; i++)
+      EXPECT_TRUE(batch.add(address, data, 10));
+
+   EXPECT_TRUE(batch.isFull());
+   EXPECT_FALSE(batch.add(address, data, 10));
+
+   batch.clear();
+   EXPECT_EQ(0, batch.getCount());
+
+   // Batched IO can only be turned on where the platform has it
+   Socket socket(Address("IP:127.0.0.1:0"));
+   socket.setBatchedIO(true);
+   EXPECT_EQ(Socket::supportsBatchedIO(), socket.usesBatchedIO());
+   socket.setBatchedIO(false);
+   EXPECT_FALSE(socket.usesBatchedIO());
+}
+
+
+};
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickScheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+// Run ticks exactly when they're due, and make sure rounding never pushes the schedule off
+TEST(TickSchedulerTest, ScheduleDoesNotDrift)
+{
+   TickScheduler scheduler(60);     // 16.67 ms per tick, which doesn't come out even
+
+   U32 start = 1000;
+   U32 now = start;
+
+   EXPECT_EQ(0, scheduler.getTimeUntilNextTick(now));      // First tick is due right away
+   scheduler.beginTick(now);
+
+   for(S32 i = 0; i < 600; i++)
+   {
+      U32 wait = scheduler.getTimeUntilNextTick(now);
+      EXPECT_LE(16u, wait);
+      EXPECT_GE(17u, wait);
+
+      now += wait;
+      EXPECT_EQ(0, scheduler.getTimeUntilNextTick(now));
+      EXPECT_EQ(wait, scheduler.beginTick(now));
+   }
+
+   // 600 ticks at 60/sec is 10 seconds, to the ms
+   EXPECT_EQ(start + 10000, now);
+   EXPECT_EQ(600, scheduler.getTicks());
+   EXPECT_EQ(0, scheduler.getMaxLateness());
+}
+
+
+// Late ticks don't push the ones after them back, and get counted
+TEST(TickSchedulerTest, LateTicks)
+{
+   TickScheduler scheduler(100);
+
+   U32 now = 0xFFFFFF00;         // Let the clock wrap while we're at it
+   scheduler.beginTick(now);
+
+   now += 13;                    // 3 ms late
+   EXPECT_EQ(13, scheduler.beginTick(now));
+   EXPECT_EQ(7, scheduler.getTimeUntilNextTick(now));    // Still due on the original schedule
+
+   now += 7;
+   scheduler.beginTick(now);
+
+   EXPECT_EQ(2, scheduler.getTicks());
+   EXPECT_EQ(3, scheduler.getMaxLateness());
+   EXPECT_FLOAT_EQ(1.5f, scheduler.getMeanLateness());
+
+   // Fall way behind, and we start a new schedule rather than try to catch up
+   now += TickScheduler::MaxLateness + 100;
+   scheduler.beginTick(now);
+   EXPECT_EQ(1, scheduler.getResyncs());
+   EXPECT_EQ(10, scheduler.getTimeUntilNextTick(now));
+}
+
+
+// A new tick rate counts from the last tick
+TEST(TickSchedulerTest, ChangeRate)
+{
+   TickScheduler scheduler(100);
+
+   U32 now = 500;
+   scheduler.beginTick(now);
+
+   now += 4;
+   scheduler.setTickRate(25);
+   EXPECT_EQ(25, scheduler.getTickRate());
+   EXPECT_EQ(36, scheduler.getTimeUntilNextTick(now));
+
+   now += 36;
+   EXPECT_EQ(40, scheduler.beginTick(now));
+   EXPECT_EQ(40, scheduler.getTimeUntilNextTick(now));
+}
+
+
+TEST(TickSchedulerTest, Report)
+{
+   TickScheduler scheduler(100);
+
+   U32 now = 0;
+   EXPECT_FALSE(scheduler.isReportDue(now));
+
+   scheduler.beginTick(now);
+
+   while(!scheduler.isReportDue(now))
+   {
+      now += scheduler.getTimeUntilNextTick(now);
+      scheduler.beginTick(now);
+   }
+
+   EXPECT_EQ(TickScheduler::ReportInterval, now);
+   EXPECT_EQ(TickScheduler::ReportInterval / 10, scheduler.getTicks());
+
+   scheduler.logReport(now);
+   EXPECT_EQ(0, scheduler.getTicks());
+   EXPECT_FALSE(scheduler.isReportDue(now));
+}
+
+
+};
@@ -10,6 +10,7 @@
 #include "TeamConstants.h"
 
 #include <tnl.h>
+#include <tnlNetObject.h>          // tnlGhostConnection.h's inline functions need NetObject defined
 #include <tnlGhostConnection.h>
 
 #include <string>
@@ -28,6 +29,24 @@ ClientGame *newClientGame(const GameSettingsPtr &settings);
 
 ServerGame *newServerGame();
 
+// Deterministic pseudo-random numbers, for tests that need the same inputs every run without touching TNL::Random
+class TestRandom
+{
+private:
+   U32 mSeed;
+
+public:
+   explicit TestRandom(U32 seed) : mSeed(seed) { }    // Constructor
+
+   // Returns a number from 0 to range - 1
+   U32 next(U32 range)
+   {
+      mSeed = mSeed * 1664525 + 1013904223;
+      return (mSeed >> 8) % range;
+   }
+};
+
+
 // Generic pack/unpack function -- feed it any class that supports pack/unpack
 template <class T>
 void packUnpack(T input, T &output, U32 mask = 0xFFFFFFFF)
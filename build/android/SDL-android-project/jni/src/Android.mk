@@ -22,8 +22,10 @@ $(ZAP_PATH)/BanList.cpp \
 $(ZAP_PATH)/barrier.cpp \
 $(ZAP_PATH)/BfObject.cpp \
 $(ZAP_PATH)/BotNavMeshZone.cpp \
+$(ZAP_PATH)/BotPathCache.cpp \
 $(ZAP_PATH)/ChatCheck.cpp \
 $(ZAP_PATH)/ClientInfo.cpp \
+$(ZAP_PATH)/CollisionBroadphase.cpp \
 $(ZAP_PATH)/Color.cpp \
 $(ZAP_PATH)/config.cpp \
 $(ZAP_PATH)/Console.cpp \
@@ -53,6 +55,8 @@ $(ZAP_PATH)/HttpRequest.cpp \
 $(ZAP_PATH)/IniFile.cpp \
 $(ZAP_PATH)/InputCode.cpp \
 $(ZAP_PATH)/item.cpp \
+$(ZAP_PATH)/LevelInfoCache.cpp \
+$(ZAP_PATH)/LevelPreloader.cpp \
 $(ZAP_PATH)/LineItem.cpp \
 $(ZAP_PATH)/LoadoutTracker.cpp \
 $(ZAP_PATH)/loadoutZone.cpp \
@@ -76,6 +80,7 @@ $(ZAP_PATH)/rabbitGame.cpp \
 $(ZAP_PATH)/Rect.cpp \
 $(ZAP_PATH)/retrieveGame.cpp \
 $(ZAP_PATH)/robot.cpp \
+$(ZAP_PATH)/ScopeTracker.cpp \
 $(ZAP_PATH)/ScreenInfo.cpp \
 $(ZAP_PATH)/ServerGame.cpp \
 $(ZAP_PATH)/ship.cpp \
@@ -93,6 +98,7 @@ $(ZAP_PATH)/SystemFunctions.cpp \
 $(ZAP_PATH)/teamInfo.cpp \
 $(ZAP_PATH)/teleporter.cpp \
 $(ZAP_PATH)/textItem.cpp \
+$(ZAP_PATH)/TickScheduler.cpp \
 $(ZAP_PATH)/Timer.cpp \
 $(ZAP_PATH)/WallSegmentManager.cpp \
 $(ZAP_PATH)/WeaponInfo.cpp \
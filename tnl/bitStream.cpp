@@ -32,6 +32,7 @@
 #include <tomcrypt.h>
 
 #include <math.h>
+#include <string.h>
 
 namespace TNL {
 
@@ -54,6 +55,8 @@ void BitStream::reset()
    mCompressRelative = false;
    mStringBuffer[0] = 0;
    mStringTable = NULL;
+   mStringsWritten = 0;
+   mStringTableEntriesWritten = 0;
 }
 
 U8 *BitStream::getBytePtr()
@@ -90,6 +93,60 @@ bool BitStream::resizeBits(U32 newBits)
    return true;
 }
 
+// Loads the bytes at ptr as a little-endian word.  Only the first byteCount matter, but when the buffer has room we
+// grab all eight at once.
+U64 BitStream::loadWord(const U8 *ptr, U32 byteCount) const
+{
+   U64 word = 0;
+
+   if(ptr + sizeof(word) <= getBuffer() + getBufferSize())
+   {
+      memcpy(&word, ptr, sizeof(word));
+      return convertLEndianToHost(word);
+   }
+
+   for(U32 i = 0; i < byteCount; i++)
+      word |= U64(ptr[i]) << (i << 3);
+
+   return word;
+}
+
+// Writes go straight from a word, but only touch the bytes they cover.  Loading and storing a whole word each time would
+// be cheaper still, if each write didn't then have to wait on the one before it.
+void BitStream::writeWord(U32 value, U32 bitCount)
+{
+   TNLAssert(bitCount > 0 && bitCount <= 32, "Too many bits for writeWord");
+
+   U8 *ptr = getBuffer() + (bitNum >> 3);
+   U32 shift = bitNum & 0x7;
+   U32 byteCount = (shift + bitCount + 7) >> 3;
+   U32 endShift = (shift + bitCount) & 0x7;
+
+   // Keep the bits on either side of the ones we're writing
+   U64 word = ((U64(value) & ((U64(1) << bitCount) - 1)) << shift) | (ptr[0] & ((1 << shift) - 1));
+   if(endShift)
+      word |= U64(ptr[byteCount - 1] & (0xFF << endShift)) << ((byteCount - 1) << 3);
+
+   for(U32 i = 0; i < byteCount; i++)
+      ptr[i] = U8(word >> (i << 3));
+
+   bitNum += bitCount;
+}
+
+U32 BitStream::readWord(U32 bitCount)
+{
+   TNLAssert(bitCount > 0 && bitCount <= 32, "Too many bits for readWord");
+
+   const U8 *ptr = getBuffer() + (bitNum >> 3);
+   U32 shift = bitNum & 0x7;
+   U32 byteCount = (shift + bitCount + 7) >> 3;
+
+   U64 word = loadWord(ptr, byteCount);
+   bitNum += bitCount;
+
+   return U32((word >> shift) & ((U64(1) << bitCount) - 1));
+}
+
 bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
 {
    if(!bitCount)
@@ -99,64 +156,32 @@ bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
       if(!resizeBits(bitCount + bitNum - maxWriteBitNum))
          return false;
 
-   U32 upShift  = bitNum & 0x7;
-   U32 downShift= 8 - upShift;
-
    const U8 *sourcePtr = (U8 *) bitPtr;
-   U8 *destPtr = getBuffer() + (bitNum >> 3);
 
-   // if this write is for <= 1 byte, and it will all fit in the
-   // first dest byte, then do some special masking.
-   if(downShift >= bitCount)
+   // Byte aligned writes can copy all the whole bytes straight across
+   if(!(bitNum & 0x7))
    {
-      U8 mask = ((1 << bitCount) - 1) << upShift;
-      *destPtr = (*destPtr & ~mask) | ((*sourcePtr << upShift) & mask);
-      bitNum += bitCount;
-      return true;
+      U32 byteCount = bitCount >> 3;
+      memcpy(getBuffer() + (bitNum >> 3), sourcePtr, byteCount);
+      bitNum += byteCount << 3;
+      sourcePtr += byteCount;
+      bitCount &= 0x7;
    }
 
-   // check for byte aligned writes -- this will be
-   // much faster than the shifting writes.
-   if(!upShift)
+   // Everything else goes a word at a time
+   while(bitCount)
    {
-      bitNum += bitCount;
-      for(; bitCount >= 8; bitCount -= 8)
-         *destPtr++ = *sourcePtr++;
-      if(bitCount)
-      {
-         U8 mask = (1 << bitCount) - 1;
-         *destPtr = (*sourcePtr & mask) | (*destPtr & ~mask);
-      }
-      return true;
-   }
+      U32 chunkBits = bitCount < 32 ? bitCount : 32;
+      U32 value = 0;
 
-   // the write destination is not byte aligned.
-   U8 sourceByte;
-   U8 destByte = *destPtr & (0xFF >> downShift);
-   U8 lastMask  = 0xFF >> (7 - ((bitNum + bitCount - 1) & 0x7));
+      for(U32 i = 0; i < (chunkBits + 7) >> 3; i++)
+         value |= U32(sourcePtr[i]) << (i << 3);
 
-   bitNum += bitCount;
-
-   for(/* empty */;bitCount >= 8; bitCount -= 8)
-   {
-      sourceByte = *sourcePtr++;
-      *destPtr++ = destByte | (sourceByte << upShift);
-      destByte = sourceByte >> downShift;
-   }
-   if(bitCount == 0)
-   {
-      *destPtr = (*destPtr & ~lastMask) | (destByte & lastMask);
-      return true;
-   }
-   if(bitCount <= downShift)
-   {
-      *destPtr = (*destPtr & ~lastMask) | ((destByte | (*sourcePtr << upShift)) & lastMask);
-      return true;
+      writeWord(value, chunkBits);
+      sourcePtr += 4;
+      bitCount -= chunkBits;
    }
-   sourceByte = *sourcePtr;
 
-   *destPtr++ = destByte | (sourceByte << upShift);
-   *destPtr = (*destPtr & ~lastMask) | ((sourceByte >> downShift) & lastMask);
    return true;
 }
 
@@ -170,40 +195,29 @@ bool BitStream::readBits(U32 bitCount, void *bitPtr)
       return false;
    }
 
-   U8 *sourcePtr = getBuffer() + (bitNum >> 3);
-   U32 byteCount = (bitCount + 7) >> 3;
-
    U8 *destPtr = (U8 *) bitPtr;
 
-   U32 downShift = bitNum & 0x7;
-   U32 upShift = 8 - downShift;
-
-   if(!downShift)
+   if(!(bitNum & 0x7))
    {
-      while(byteCount--)
-         *destPtr++ = *sourcePtr++;
-      bitNum += bitCount;
-      return true;
+      U32 byteCount = bitCount >> 3;
+      memcpy(destPtr, getBuffer() + (bitNum >> 3), byteCount);
+      bitNum += byteCount << 3;
+      destPtr += byteCount;
+      bitCount &= 0x7;
    }
 
-   U8 sourceByte = *sourcePtr >> downShift;
-   bitNum += bitCount;
-
-   for(; bitCount >= 8; bitCount -= 8)
+   while(bitCount)
    {
-      U8 nextByte = *++sourcePtr;
-      *destPtr++ = sourceByte | (nextByte << upShift);
-      sourceByte = nextByte >> downShift;
-   }
-   if(bitCount)
-   {
-      if(bitCount <= upShift)
-      {
-         *destPtr = sourceByte;
-         return true;
-      }
-      *destPtr = sourceByte | ( (*++sourcePtr) << upShift);
+      U32 chunkBits = bitCount < 32 ? bitCount : 32;
+      U32 value = readWord(chunkBits);
+
+      for(U32 i = 0; i < (chunkBits + 7) >> 3; i++)
+         destPtr[i] = U8(value >> (i << 3));
+
+      destPtr += 4;
+      bitCount -= chunkBits;
    }
+
    return true;
 }
 
@@ -258,17 +272,16 @@ bool BitStream::read(ByteBuffer *theBuffer)
 U32 BitStream::readInt(U8 bitCount)
 {
    TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use readInt64");
-   U32 ret = 0;
-   readBits(bitCount, &ret);
-   ret = convertLEndianToHost(ret);
+   if(!bitCount)
+      return 0;
 
-   // Clear bits that we didn't read.
-   if(bitCount == 32)
-      return ret;
-   else
-      ret &= (1 << bitCount) - 1;
+   if(bitCount + bitNum > maxReadBitNum)
+   {
+      error = true;
+      return 0;
+   }
 
-   return ret;
+   return readWord(bitCount);
 }
 
 U64 BitStream::readInt64(U8 bitCount)
@@ -290,8 +303,14 @@ U64 BitStream::readInt64(U8 bitCount)
 void BitStream::writeInt(U32 val, U8 bitCount)
 {
    TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use writeInt64");
-   val = convertHostToLEndian(val);
-   writeBits(bitCount, &val);
+   if(!bitCount)
+      return;
+
+   if(bitCount + bitNum > maxWriteBitNum)
+      if(!resizeBits(bitCount + bitNum - maxWriteBitNum))
+         return;
+
+   writeWord(val, bitCount);
 }
 
 void BitStream::writeInt64(U64 val, U8 bitCount)
@@ -508,6 +527,9 @@ void BitStream::writeString(const char *string, U8 maxLen)     // maxlen default
 {
    if(!string)
       string = "";
+
+   mStringsWritten++;
+
    U8 j;
    for(j = 0; j < maxLen && mStringBuffer[j] == string[j] && string[j];j++)
       ;  // do nothing
@@ -541,8 +563,17 @@ void BitStream::readStringTableEntry(StringTableEntry *ste)
    }
 }
 
+void BitStream::setStringBuffer(const char *string)
+{
+   strncpy(mStringBuffer, string, sizeof(mStringBuffer) - 1);
+   mStringBuffer[sizeof(mStringBuffer) - 1] = 0;
+}
+
+
 void BitStream::writeStringTableEntry(const StringTableEntry &ste)
 {
+   mStringTableEntriesWritten++;
+
    if(mStringTable)
       mStringTable->writeStringTableEntry(this, ste);
    else
@@ -33,6 +33,7 @@
 namespace TNL {
 
 ClassChunker<EventConnection::EventNote> EventConnection::mEventNoteChunker;
+ClassChunker<EventConnection::EventPacketNotify> EventConnection::mPacketNotifyChunker;
 
 EventConnection::EventConnection()
 {
@@ -52,6 +53,26 @@ EventConnection::EventConnection()
    mTNLDataBuffer = NULL;
 }
 
+NetConnection::PacketNotify *EventConnection::allocNotify()
+{
+   return mPacketNotifyChunker.alloc();
+}
+
+void EventConnection::freeNotify(PacketNotify *notify)
+{
+   mPacketNotifyChunker.free(static_cast<EventPacketNotify *>(notify));
+}
+
+void EventConnection::logPoolUsage()
+{
+   Parent::logPoolUsage();
+
+   logprintf(LogConsumer::LogNetBase, "EventPacketNotify pool - In use: %d   Pooled: %d", 
+             mPacketNotifyChunker.getAllocatedCount(), mPacketNotifyChunker.getPooledCount());
+   logprintf(LogConsumer::LogNetBase, "EventNote pool - In use: %d   Pooled: %d", 
+             mEventNoteChunker.getAllocatedCount(), mEventNoteChunker.getPooledCount());
+}
+
 static const U32 mTNLDataBufferMaxSize = 1024 * 1024 * 4;  // 4 MB
 
 EventConnection::~EventConnection()
@@ -600,6 +621,22 @@ bool EventConnection::postNetEvent(NetEvent *theEvent)
    return true;
 }
 
+S32 EventConnection::broadcastNetEvent(NetEvent *theEvent, const Vector<EventConnection *> &connections)
+{
+   RefPtr<NetEvent> event = theEvent;    // Keep it around if posting fails
+
+   if(connections.size() > 1)
+      theEvent->notifyBroadcast();
+
+   S32 posted = 0;
+
+   for(S32 i = 0; i < connections.size(); i++)
+      if(connections[i]->canPostNetEvent() && connections[i]->postNetEvent(theEvent))
+         posted++;
+
+   return posted;
+}
+
 bool EventConnection::isDataToTransmit()
 {
    return mUnorderedSendEventQueueHead || mSendEventQueueHead || Parent::isDataToTransmit();
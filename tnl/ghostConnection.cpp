@@ -31,8 +31,15 @@
 #include "tnlNetObject.h"
 #include "tnlNetInterface.h"
 
+#include <algorithm>    // For nth_element and sort
+
 namespace TNL {
 
+ClassChunker<GhostConnection::GhostPacketNotify> GhostConnection::mPacketNotifyChunker;
+ClassChunker<GhostConnection::GhostRef> GhostConnection::mGhostRefChunker;
+
+static const S32 FirstGhostSortCount = 32;   // Number of ghosts a partial sort orders at first; usually more than fit in a packet
+
 GhostConnection::GhostConnection()
 {
    // ghost management data:
@@ -40,6 +47,7 @@ GhostConnection::GhostConnection()
    mGhostingSequence = 0;
    mGhosting = false;
    mScoping = false;
+   mPartialGhostSort = true;
    mGhostLookupTable = NULL;
    mGhostZeroUpdateIndex = 0;
 
@@ -57,6 +65,26 @@ GhostConnection::~GhostConnection()
    delete[] mGhostLookupTable;
 }
 
+NetConnection::PacketNotify *GhostConnection::allocNotify()
+{
+   return mPacketNotifyChunker.alloc();
+}
+
+void GhostConnection::freeNotify(PacketNotify *notify)
+{
+   mPacketNotifyChunker.free(static_cast<GhostPacketNotify *>(notify));
+}
+
+void GhostConnection::logPoolUsage()
+{
+   Parent::logPoolUsage();
+
+   logprintf(LogConsumer::LogNetBase, "GhostPacketNotify pool - In use: %d   Pooled: %d", 
+             mPacketNotifyChunker.getAllocatedCount(), mPacketNotifyChunker.getPooledCount());
+   logprintf(LogConsumer::LogNetBase, "GhostRef pool - In use: %d   Pooled: %d", 
+             mGhostRefChunker.getAllocatedCount(), mGhostRefChunker.getPooledCount());
+}
+
 void GhostConnection::setGhostTo(bool ghostTo)
 {
    if(!ghostTo)
@@ -143,7 +171,7 @@ void GhostConnection::packetDropped(PacketNotify *pnotify)
          packRef->ghost->flags &= ~GhostInfo::KillingGhost;
       }
 
-      delete packRef;
+      mGhostRefChunker.free(packRef);
       packRef = temp;
    }
 }
@@ -177,19 +205,38 @@ void GhostConnection::packetReceived(PacketNotify *pnotify)
       else if(packRef->ghostInfoFlags & GhostInfo::KillingGhost)
          freeGhostInfo(packRef->ghost);
 
-      delete packRef;
+      mGhostRefChunker.free(packRef);
       packRef = temp;
    }
 }
 
-static S32 QSORT_CALLBACK UQECompare(const void *a,const void *b)
+// Ghosts with equal priorities are ordered by ghost index, so that the order doesn't depend on how we sort
+static bool isLowerPriority(const GhostInfo *a, const GhostInfo *b)
+{
+   if(a->priority != b->priority)
+      return a->priority < b->priority;
+
+   return a->index < b->index;
+}
+
+// Leaves the sortCount highest priority ghosts of the first count in mGhostArray at the end of that range, in increasing 
+// order of priority, and returns the index of the first of them.  The rest are left in no particular order.
+S32 GhostConnection::sortGhostsByPriority(S32 count, S32 sortCount)
 {
-   GhostInfo *ga = *((GhostInfo **) a);
-   GhostInfo *gb = *((GhostInfo **) b);
+   GhostInfo **ghosts = mGhostArray.address();
+   S32 first = (sortCount < count) ? count - sortCount : 0;
+
+   if(first > 0)
+      std::nth_element(ghosts, ghosts + first, ghosts + count, isLowerPriority);
 
-   F32 ret = ga->priority - gb->priority;
-   return (ret < 0) ? -1 : ((ret > 0) ? 1 : 0);
-} 
+   std::sort(ghosts + first, ghosts + count, isLowerPriority);
+
+   // reset the array indices...
+   for(S32 i = count - 1; i >= 0; i--)
+      ghosts[i]->arrayIndex = i;
+
+   return first;
+}
 
 void GhostConnection::prepareWritePacket()
 {
@@ -301,11 +348,12 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
          walk->priority = 0;
    }
    GhostRef *updateList = NULL;
-   if(mGhostZeroUpdateIndex != 0)
-      qsort(&mGhostArray[0], mGhostZeroUpdateIndex, sizeof(GhostInfo *), UQECompare);
-   // reset the array indices...
-   for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
-      mGhostArray[i]->arrayIndex = i;
+
+   // Ghosts from sortedFrom up are in priority order.  A partial sort only orders the first few we'll try to send, and 
+   // orders more, twice as many each time, if the packet still has room once we've been through them.  Sending a ghost
+   // only moves ghosts we've already been through, so the unsorted ones are never disturbed.
+   S32 sortedFrom = mGhostZeroUpdateIndex;
+   S32 sortCount = mPartialGhostSort ? FirstGhostSortCount : mGhostZeroUpdateIndex;
 
    U8 sendSize = 0;
    while(maxIndex != 0)
@@ -323,6 +371,12 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
    bool have_something_to_send = bstream->getBitPosition() >= 256;
    for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
    {
+      if(i < sortedFrom)
+      {
+         sortedFrom = sortGhostsByPriority(i + 1, sortCount);
+         sortCount *= 2;
+      }
+
       GhostInfo *walk = mGhostArray[i];
       if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
          continue;
@@ -356,7 +410,10 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
             NetObject::mIsInitialUpdate = true;
          }
          // update the object
-         retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         if(!NetObject::mIsInitialUpdate && walk->obj->sharesUpdates())
+            retMask = packSharedUpdate(walk->obj, updateMask, bstream);
+         else
+            retMask = walk->obj->packUpdate(this, updateMask, bstream);
 
          if(NetObject::mIsInitialUpdate)
          {
@@ -391,7 +448,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
       // otherwise, create a record of this ghost update and
       // attach it to the packet.
-      GhostRef *upd = new GhostRef;
+      GhostRef *upd = mGhostRefChunker.alloc();
 
       upd->nextRef = updateList;
       updateList = upd;
@@ -436,6 +493,53 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
    notify->ghostList = updateList;
 }
 
+// Objects with the SharesUpdates flag pack the same bits for every connection, so the first connection to send a
+// given update packs it, and everyone else sending that update during the same round of packet writes gets a copy
+U32 GhostConnection::packSharedUpdate(NetObject *obj, U32 updateMask, BitStream *bstream)
+{
+   NetObject::SharedUpdate *update = obj->mSharedUpdate;
+
+   // Anything the object does after the dirty list is collapsed could change what it would pack
+   if(update && update->tick == NetObject::mUpdateTick && update->updateMask == updateMask && !obj->mDirtyMaskBits)
+   {
+      obj->getClassRep()->addSharedUpdate(true);
+      bstream->writeBits(update->bitCount, update->bits.address());
+      return update->retMask;
+   }
+
+   obj->getClassRep()->addSharedUpdate(false);
+
+   U32 startPos = bstream->getBitPosition();
+   ConnectionStringTable::PacketEntry *strEntry = getCurrentWritePacketNotify()->stringList.stringTail;
+
+   U32 retMask = obj->packUpdate(this, updateMask, bstream);
+
+   TNLAssert(getCurrentWritePacketNotify()->stringList.stringTail == strEntry, 
+             "Objects that share updates can't write string table entries");
+
+   // Don't keep it if the packet overflowed, so we don't have all of it, or if the object changed while packing it
+   if(!bstream->isValid() || obj->mDirtyMaskBits)
+      return retMask;
+
+   if(!update)
+   {
+      update = new NetObject::SharedUpdate;
+      obj->mSharedUpdate = update;
+   }
+
+   update->tick = NetObject::mUpdateTick;
+   update->updateMask = updateMask;
+   update->retMask = retMask;
+   update->bitCount = bstream->getBitPosition() - startPos;
+   update->bits.resize((update->bitCount + 7) >> 3);
+
+   BitStream reader(bstream->getBuffer(), bstream->getBufferSize());
+   reader.setBitPosition(startPos);
+   reader.readBits(update->bitCount, update->bits.address());
+
+   return retMask;
+}
+
 void GhostConnection::readPacket(BitStream *bstream)
 {
    Parent::readPacket(bstream);
@@ -811,7 +915,7 @@ void GhostConnection::clearGhostInfo()
       while(delWalk)
       {
          GhostRef *next = delWalk->nextRef;
-         delete delWalk;
+         mGhostRefChunker.free(delWalk);
          delWalk = next;
       }
    }
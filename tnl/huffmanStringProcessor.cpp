@@ -52,7 +52,19 @@ namespace HuffmanStringProcessor {
    Vector<HuffNode> mHuffNodes;
    Vector<HuffLeaf> mHuffLeaves;
 
+   // Decoding looks up the next DecodeTableBits bits at once, rather than walking the tree a bit at a time.  Codes
+   // that fit resolve to their symbol in one probe; longer ones resolve to the node where the walk carries on.
+   static const U32 DecodeTableBits = 10;
+
+   struct HuffDecodeEntry {
+      S16 index;     // Leaf (negative) or node we end up at, as in HuffNode
+      U8  numBits;   // Bits used getting there
+   };
+
+   HuffDecodeEntry mDecodeTable[1 << DecodeTableBits];
+
    void buildTables();
+   void buildDecodeTable();
 
    // We have to be a bit careful with these, since they are pointers...
    struct HuffWrap {
@@ -71,7 +83,7 @@ namespace HuffmanStringProcessor {
 
    S16 determineIndex(HuffWrap&);
 
-   void generateCodes(BitStream&, S32, S32);
+   void generateCodes(S32, S32, U32);
 };
 
 //bool HuffmanStringProcessor::mTablesBuilt = false;
@@ -149,33 +161,44 @@ void HuffmanStringProcessor::buildTables()
    mHuffNodes[0] = *(pWrap[0].pNode);
    delete [] pWrap;
 
-   U32 code = 0;
-   BitStream bs((U8 *) &code, 4);
-
-   generateCodes(bs, 0, 0);
+   generateCodes(0, 0, 0);
+   buildDecodeTable();
 }
 
-void HuffmanStringProcessor::generateCodes(BitStream& rBS, S32 index, S32 depth)
+// Codes hold their first bit in bit 0, the order they go into the stream
+void HuffmanStringProcessor::generateCodes(S32 index, S32 depth, U32 code)
 {
    if (index < 0) {
       // leaf node, copy the code in, and back out...
       HuffLeaf& rLeaf = mHuffLeaves[-(index + 1)];
 
-      memcpy(&rLeaf.code, rBS.getBuffer(), sizeof(rLeaf.code));
+      TNLAssert(depth <= 32, "Huffman code too long!");
+      rLeaf.code    = code;
       rLeaf.numBits = depth;
    } else {
       HuffNode& rNode = mHuffNodes[index];
 
-      S32 pos = rBS.getBitPosition();
-
-      rBS.writeFlag(false);
-      generateCodes(rBS, rNode.index0, depth + 1);
+      generateCodes(rNode.index0, depth + 1, code);
+      generateCodes(rNode.index1, depth + 1, code | (U32(1) << depth));
+   }
+}
 
-      rBS.setBitPosition(pos);
-      rBS.writeFlag(true);
-      generateCodes(rBS, rNode.index1, depth + 1);
+void HuffmanStringProcessor::buildDecodeTable()
+{
+   for (U32 bits = 0; bits < (1 << DecodeTableBits); bits++) {
+      S32 index = 0;
+      U32 numBits = 0;
+
+      while (index >= 0 && numBits < DecodeTableBits) {
+         if (bits & (1 << numBits))
+            index = mHuffNodes[index].index1;
+         else
+            index = mHuffNodes[index].index0;
+         numBits++;
+      }
 
-      rBS.setBitPosition(pos);
+      mDecodeTable[bits].index   = S16(index);
+      mDecodeTable[bits].numBits = U8(numBits);
    }
 }
 
@@ -201,6 +224,14 @@ bool HuffmanStringProcessor::readHuffBuffer(BitStream* pStream, char* out_pBuffe
       U32 len = pStream->readInt(8);
       for (U32 i = 0; i < len; i++) {
          S32 index = 0;
+
+         // Near the end of the stream there may not be enough bits for a table lookup; walk the tree instead
+         if (pStream->getBitPosition() + DecodeTableBits <= pStream->getMaxReadBitPosition()) {
+            const HuffDecodeEntry& rEntry = mDecodeTable[pStream->readInt(DecodeTableBits)];
+            pStream->advanceBitPosition(S32(rEntry.numBits) - S32(DecodeTableBits));
+            index = rEntry.index;
+         }
+
          while (true) {
             if (index >= 0) {
                if (pStream->readFlag() == true) {
@@ -253,10 +284,24 @@ bool HuffmanStringProcessor::writeHuffBuffer(BitStream* pStream, const char* out
    } else {
       pStream->writeFlag(true);
       pStream->writeInt(len, 8);
+
+      // Collect codes and write them out 32 bits at a time
+      U64 bits = 0;
+      U32 bitCount = 0;
+
       for (i = 0; i < len; i++) {
          HuffLeaf& rLeaf = mHuffLeaves[((unsigned char)out_pBuffer[i])];
-         pStream->writeBits(rLeaf.numBits, &rLeaf.code);
+         bits |= U64(rLeaf.code) << bitCount;
+         bitCount += rLeaf.numBits;
+
+         if (bitCount >= 32) {
+            pStream->writeInt(U32(bits), 32);
+            bits >>= 32;
+            bitCount -= 32;
+         }
       }
+
+      pStream->writeInt(U32(bits), bitCount);
    }
 
    return true;
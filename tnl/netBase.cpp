@@ -47,6 +47,8 @@ NetClassRep::NetClassRep()
    mInitialUpdateBitsUsed = 0;
    mPartialUpdateCount = 0;
    mPartialUpdateBitsUsed = 0;
+   mSharedUpdateHits = 0;
+   mSharedUpdateMisses = 0;
 }
 
 Object* NetClassRep::create(const char* className)
@@ -162,6 +164,14 @@ void NetClassRep::logBitUsage()
                walk->mPartialUpdateBitsUsed / F32(walk->mPartialUpdateCount));
          atLeastOne = true;
       }
+
+      if(walk->mSharedUpdateHits + walk->mSharedUpdateMisses)
+      {
+         logprintf(LogConsumer::LogNetBase, "%s (Shared) - Copied: %d   Packed: %d   Hit Rate: %g%%", 
+               walk->mClassName, walk->mSharedUpdateHits, walk->mSharedUpdateMisses, 
+               walk->mSharedUpdateHits * 100 / F32(walk->mSharedUpdateHits + walk->mSharedUpdateMisses));
+         atLeastOne = true;
+      }
    }
 
    if(!atLeastOne)
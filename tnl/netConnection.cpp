@@ -164,6 +164,24 @@ NetConnection::PacketNotify::PacketNotify()
    sendTime = 0;
 }
 
+ClassChunker<NetConnection::PacketNotify> NetConnection::mNotifyChunker;
+
+NetConnection::PacketNotify *NetConnection::allocNotify()
+{
+   return mNotifyChunker.alloc();
+}
+
+void NetConnection::freeNotify(PacketNotify *note)
+{
+   mNotifyChunker.free(note);
+}
+
+void NetConnection::logPoolUsage()
+{
+   logprintf(LogConsumer::LogNetBase, "PacketNotify pool - In use: %d   Pooled: %d", 
+             mNotifyChunker.getAllocatedCount(), mNotifyChunker.getPooledCount());
+}
+
 bool NetConnection::checkTimeout(U32 time)
 {
    if(!mLastPingSendTime)
@@ -670,7 +688,7 @@ void NetConnection::handleNotify(U32 sequence, bool recvd)
       packetDropped(note);
       mPacketSendDropped++;
    }
-   delete note;
+   freeNotify(note);
 }
 
 //--------------------------------------------------------------------
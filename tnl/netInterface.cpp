@@ -55,6 +55,7 @@ NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
    for(S32 i = 0; i < mConnectionHashTable.size(); i++)
       mConnectionHashTable[i] = NULL;
    mSendPacketList = NULL;
+   mQueueingSends = false;
    mCurrentTime = Platform::getRealMilliseconds();
 }
 
@@ -104,7 +105,38 @@ void NetInterface::setPrivateKey(AsymmetricKey *theKey)
 
 NetError NetInterface::sendto(const Address &address, BitStream *stream)
 {
-   return mSocket.sendto(address, stream->getBuffer(), stream->getBytePosition());
+   return sendOrQueue(address, stream->getBuffer(), stream->getBytePosition());
+}
+
+NetError NetInterface::sendOrQueue(const Address &address, const U8 *data, S32 size)
+{
+   if(mQueueingSends)
+   {
+      if(mSendBatch.isFull())
+      {
+         mSocket.sendtoBatch(mSendBatch);
+         mSendBatch.clear();
+      }
+
+      if(mSendBatch.add(address, data, size))
+         return NoError;
+   }
+
+   return mSocket.sendto(address, data, size);
+}
+
+void NetInterface::flushSendBatch()
+{
+   if(mSendBatch.getCount() > 0)
+   {
+      NetError error = mSocket.sendtoBatch(mSendBatch);
+      if(error != NoError && error != WouldBlock)
+         logprintf(LogConsumer::LogUDP, "Error %d sending a batch of %d packets", error, mSendBatch.getCount());
+
+      mSendBatch.clear();
+   }
+
+   mQueueingSends = false;
 }
 
 void NetInterface::sendtoDelayed(const Address *address, NetConnection *receiveTo, BitStream *stream, U32 millisecondDelay)
@@ -326,6 +358,9 @@ void NetInterface::processConnections()
    mCurrentTime = Platform::getRealMilliseconds();
    mPuzzleManager.tick(mCurrentTime);
 
+   // Collect the packets our connections are about to send, so they can all go out with one system call
+   mQueueingSends = mSocket.usesBatchedIO();
+
    // first see if there are any delayed packets that need to be sent...
    while(mSendPacketList && S32(mSendPacketList->sendTime - getCurrentTime()) < 0)
    {
@@ -343,7 +378,7 @@ void NetInterface::processConnections()
       }
       else
       {
-         mSocket.sendto(mSendPacketList->remoteAddress,
+         sendOrQueue(mSendPacketList->remoteAddress,
             mSendPacketList->packetData, mSendPacketList->packetSize);
       }
       mSendPacketList->~DelaySendPacket(); // properly free stuff like SafePtr
@@ -355,6 +390,8 @@ void NetInterface::processConnections()
    for(S32 i = 0; i < mConnectionList.size(); i++)
       mConnectionList[i]->checkPacketSend(false, getCurrentTime());
 
+   flushSendBatch();
+
    if(U32(getCurrentTime() - mLastTimeoutCheckTime) > TimeoutCheckInterval)
    {
       for(S32 i = 0; i < mPendingConnections.size();)
@@ -452,6 +489,22 @@ void NetInterface::checkIncomingPackets()
 
    mCurrentTime = Platform::getRealMilliseconds();
 
+   if(mSocket.usesBatchedIO())
+   {
+      // read out all the available packets, a batch at a time:
+      while(mSocket.recvfromBatch(&mReceiveBatch) == NoError)
+         for(S32 i = 0; i < mReceiveBatch.getCount(); i++)
+         {
+            PacketBatch::Packet &packet = mReceiveBatch.get(i);
+
+            BitStream b(packet.data, packet.size);
+            b.setMaxSizes(packet.size, 0);
+            b.reset();
+            processPacket(packet.address, &b);
+         }
+      return;
+   }
+
    // read out all the available packets:
    while((error = stream.recvfrom(mSocket, &sourceAddress)) == NoError)
       processPacket(sourceAddress, &stream);
@@ -34,6 +34,7 @@ namespace TNL {
 GhostConnection *NetObject::mRPCSourceConnection = NULL;
 GhostConnection *NetObject::mRPCDestConnection = NULL;
 bool NetObject::mIsInitialUpdate = false;
+U32 NetObject::mUpdateTick = 0;
 
 NetObject::NetObject()
 {
@@ -43,6 +44,7 @@ NetObject::NetObject()
    mPrevDirtyList = NULL;
    mNextDirtyList = NULL;
    mDirtyMaskBits = 0;
+   mSharedUpdate = NULL;
 }
 
 // Copy constructor
@@ -53,11 +55,14 @@ NetObject::NetObject(const NetObject &t)
    mPrevDirtyList = NULL;
    mNextDirtyList = NULL;
    mDirtyMaskBits = 0;
+   mSharedUpdate = NULL;
 }
 
 
 NetObject::~NetObject()
 {
+   delete mSharedUpdate;
+
    while(mFirstObjectRef)
       mFirstObjectRef->connection->detachObject(mFirstObjectRef);
 
@@ -152,6 +157,8 @@ void NetObject::collapseDirtyList()
       obj = next;
    }
    mDirtyList = NULL;
+   mUpdateTick++;    // Any updates packed before now may be out of date
+
    for(S32 i = 0; i < tempV.size(); i++)
    {
       TNLAssert(tempV[i]->mNextDirtyList == NULL && tempV[i]->mPrevDirtyList == NULL && tempV[i]->mDirtyMaskBits == 0, "Error in collapse");
@@ -219,6 +226,9 @@ void NetObject::postRPCEvent(NetObjectRPCEvent *theEvent)
    }
    else
    {
+      if(mFirstObjectRef && mFirstObjectRef->nextObjectRef)
+         theEvent->notifyBroadcast();
+
       for(GhostInfo *walk = mFirstObjectRef; walk; walk = walk->nextObjectRef)
       {
          if(!(walk->flags & GhostInfo::NotAvailable))
@@ -420,13 +420,17 @@ class UnixTimer
       UnixTimer()
       {
       }
+      // In microseconds; x86UNIXGetTickCount() only has ms granularity, which is too coarse for timing short stretches of code
       S64 getCurrentTime()
       {
-         return x86UNIXGetTickCount();
+         timeval t;
+         ::gettimeofday(&t, NULL);
+
+         return S64(t.tv_sec) * 1000000 + t.tv_usec;
       }
       F64 convertToMS(S64 delta)
       {
-         return F64(delta);
+         return F64(delta) / 1000.0;
       }
 };
 
@@ -36,11 +36,80 @@ namespace TNL {
 RPCEvent::RPCEvent(RPCGuaranteeType gType, RPCDirection dir) :
       NetEvent((NetEvent::GuaranteeType) gType, (NetEvent::EventDirection) dir)
 {
+   mBroadcast = false;
+   mPackedArgs = NULL;
+}
+
+RPCEvent::~RPCEvent()
+{
+   delete mPackedArgs;
+}
+
+void RPCEvent::notifyBroadcast()
+{
+   mBroadcast = true;
 }
 
 void RPCEvent::pack(EventConnection *ps, BitStream *bstream)
 {
+   if(mBroadcast)
+      packArgs(bstream);
+   else
+      mFunctor->write(*bstream);
+}
+
+// The arguments of a broadcast event are the same for every connection, so we pack them for the first connection and
+// copy the bits for the rest.  Strings are compressed against the last string written to the stream, so bits with
+// strings in them can only be copied into a stream holding the same last string.  StringTableEntries are written
+// through each connection's string table, so events with them get packed every time.
+void RPCEvent::packArgs(BitStream *bstream)
+{
+   if(mPackedArgs && (!mPackedArgs->usesStringBuffer || mPackedArgs->startString == bstream->getStringBuffer()))
+   {
+      getClassRep()->addSharedUpdate(true);
+      bstream->writeBits(mPackedArgs->bitCount, mPackedArgs->bits.address());
+
+      if(mPackedArgs->usesStringBuffer)
+         bstream->setStringBuffer(mPackedArgs->endString.c_str());
+
+      return;
+   }
+
+   getClassRep()->addSharedUpdate(false);
+
+   U32 startPos = bstream->getBitPosition();
+   U32 stringsWritten = bstream->getStringsWritten();
+   U32 entriesWritten = bstream->getStringTableEntriesWritten();
+   std::string startString = bstream->getStringBuffer();
+
    mFunctor->write(*bstream);
+
+   if(bstream->getStringTableEntriesWritten() != entriesWritten)
+   {
+      mBroadcast = false;     // Never the same twice
+      return;
+   }
+
+   // Don't keep it if the packet overflowed, so we don't have all of it
+   if(!bstream->isValid())
+      return;
+
+   if(!mPackedArgs)
+      mPackedArgs = new PackedArgs;
+
+   mPackedArgs->bitCount = bstream->getBitPosition() - startPos;
+   mPackedArgs->bits.resize((mPackedArgs->bitCount + 7) >> 3);
+   mPackedArgs->usesStringBuffer = bstream->getStringsWritten() != stringsWritten;
+
+   if(mPackedArgs->usesStringBuffer)
+   {
+      mPackedArgs->startString = startString;
+      mPackedArgs->endString = bstream->getStringBuffer();
+   }
+
+   BitStream reader(bstream->getBuffer(), bstream->getBufferSize());
+   reader.setBitPosition(startPos);
+   reader.readBits(mPackedArgs->bitCount, mPackedArgs->bits.address());
 }
 
 void RPCEvent::unpack(EventConnection *ps, BitStream *bstream)
@@ -79,8 +79,20 @@ protected:
    ConnectionStringTable *mStringTable; ///< String table used to compress StringTableEntries over the network.
    /// String buffer holds the last string written into the stream for substring compression.
    char mStringBuffer[256];
+   U32 mStringsWritten;                ///< Number of strings written since the last reset, through writeString()
+   U32 mStringTableEntriesWritten;     ///< Number of StringTableEntries written since the last reset
 
    bool resizeBits(U32 numBitsNeeded);
+
+   /// @name Word-at-a-time access
+   ///
+   /// Reads and writes of up to 32 bits at the current position, done with a single 64-bit word rather than a
+   /// byte at a time.  The caller checks the read/write limits.
+   /// @{
+   U64  loadWord(const U8 *ptr, U32 byteCount) const;
+   void writeWord(U32 value, U32 bitCount);
+   U32  readWord(U32 bitCount);
+   /// @}
 public:
 
    /// @name Constructors
@@ -113,6 +125,18 @@ public:
    /// clears the string compression buffer.
    void clearStringBuffer() { mStringBuffer[0] = 0; }
 
+   /// Returns the string compression buffer, which the next string written is compressed against.
+   const char *getStringBuffer() const { return mStringBuffer; }
+   /// Sets the string compression buffer, as if string had just been written.
+   void setStringBuffer(const char *string);
+
+   /// Returns how many strings have been written since the last reset.  Bits written around a string depend on the
+   /// string buffer.
+   U32 getStringsWritten() const { return mStringsWritten; }
+   /// Returns how many StringTableEntries have been written since the last reset.  Bits written around an entry depend
+   /// on the connection's string table, if any.
+   U32 getStringTableEntriesWritten() const { return mStringTableEntriesWritten; }
+
    /// sets the ConnectionStringTable for compressing string table entries across the network
    void setStringTable(ConnectionStringTable *table) { mStringTable = table; }
 
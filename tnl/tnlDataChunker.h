@@ -96,12 +96,14 @@ template<class T>
 class ClassChunker: private DataChunker
 {
    S32 numAllocated; ///< number of elements currently allocated through this ClassChunker
+   S32 numPooled;    ///< number of freed elements waiting on the free list for reuse
    S32 elementSize;  ///< the size of each element, or the size of a pointer, whichever is greater
    T *freeListHead;  ///< a pointer to a linked list of freed elements for reuse
 public:
    ClassChunker(S32 size = DataChunker::ChunkSize) : DataChunker(size)
    {
       numAllocated = 0;
+      numPooled = 0;
       elementSize = getMax(U32(sizeof(T)), U32(sizeof(T *)));
       freeListHead = NULL;
    }
@@ -113,6 +115,7 @@ public:
          return constructInPlace(reinterpret_cast<T*>(DataChunker::alloc(elementSize)));
       T* ret = freeListHead;
       freeListHead = *(reinterpret_cast<T**>(freeListHead));
+      numPooled--;
       return constructInPlace(ret);
    }
 
@@ -121,6 +124,7 @@ public:
    {
       destructInPlace(elem);
       numAllocated--;
+      numPooled++;
       *(reinterpret_cast<T**>(elem)) = freeListHead;
       freeListHead = elem;
    }
@@ -128,7 +132,15 @@ public:
    void freeBlocks()
    {
 	   DataChunker::freeBlocks();
+      freeListHead = NULL;    // The free list was in the blocks we just freed
+      numPooled = 0;
    }
+
+   /// Returns the number of elements currently allocated, for diagnostics.
+   S32 getAllocatedCount() const { return numAllocated; }
+
+   /// Returns the number of freed elements waiting to be reused, for diagnostics.
+   S32 getPooledCount() const { return numPooled; }
 };
 
 };
@@ -78,6 +78,9 @@ public:
 
    EventConnection();
    ~EventConnection();
+
+   /// Logs pool usage for our packet notifies and event notes, as well as our parent's
+   static void logPoolUsage();
 protected:
    void clearSendEvents();
    void clearRecvEvents();
@@ -89,7 +92,10 @@ protected:
    };
 
    /// Allocates a PacketNotify for this connection
-   PacketNotify *allocNotify() { return new EventPacketNotify; }
+   PacketNotify *allocNotify();
+
+   /// Frees a PacketNotify allocated by allocNotify()
+   void freeNotify(PacketNotify *notify);
 
    /// Override processing to requeue any guaranteed events in the packet that was dropped
    void packetDropped(PacketNotify *notify);
@@ -116,6 +122,7 @@ protected:
 
 private:
    static ClassChunker<EventNote> mEventNoteChunker; ///< Quick memory allocator for net event notes
+   static ClassChunker<EventPacketNotify> mPacketNotifyChunker; ///< Quick memory allocator for packet notifies
 
    EventNote *mSendEventQueueHead;          ///< Head of the list of events to be sent to the remote host
    EventNote *mSendEventQueueTail;          ///< Tail of the list of events to be sent to the remote host.  New events are tagged on to the end of this list
@@ -161,6 +168,11 @@ public:
    /// Posts a NetEvent for processing on the remote host
    bool postNetEvent(NetEvent *event);
 
+   /// Posts one NetEvent to each of connections, skipping any that can't take events.  The event is shared, so it only
+   /// gets constructed once, and RPC arguments are packed once and copied for the other connections where they can be.
+   /// Returns the number of connections the event was posted to.
+   static S32 broadcastNetEvent(NetEvent *event, const Vector<EventConnection *> &connections);
+
    /// For fake connections (AI for instance)
    virtual bool canPostNetEvent() const { return true; }
 
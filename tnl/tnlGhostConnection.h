@@ -105,7 +105,13 @@ public:
 protected:
 
    /// Override of EventConnection's allocNotify, to use the GhostPacketNotify structure.
-   PacketNotify *allocNotify() { return new GhostPacketNotify; }
+   PacketNotify *allocNotify();
+
+   /// Frees a GhostPacketNotify allocated by allocNotify().
+   void freeNotify(PacketNotify *notify);
+
+   static ClassChunker<GhostPacketNotify> mPacketNotifyChunker; ///< Quick memory allocator for packet notifies
+   static ClassChunker<GhostRef> mGhostRefChunker;              ///< Quick memory allocator for ghost update records
 
    /// Override to properly update the GhostInfo's for all ghosts that had upates in the dropped packet.
    void packetDropped(PacketNotify *notify);
@@ -141,6 +147,7 @@ protected:
 
    bool mGhosting;         ///< Am I currently ghosting objects over?
    bool mScoping;          ///< Am I currently allowing objects to be scoped?
+   bool mPartialGhostSort; ///< Do I only sort the ghosts that might fit in the packet?
    U32  mGhostingSequence; ///< Sequence number describing this ghosting session.
 
    Vector<NetObject *> mLocalGhosts;        ///< Local ghost array for remote objects, or NULL if mGhostTo is false.
@@ -157,6 +164,12 @@ protected:
 
    void freeGhostInfo(GhostInfo *);
 
+   /// Puts the highest priority ghosts in mGhostArray[0..count) in order at the end of that range.
+   S32 sortGhostsByPriority(S32 count, S32 sortCount);
+
+   /// Writes a partial update of an object that shares its updates, copying it from another connection if we can.
+   U32 packSharedUpdate(NetObject *obj, U32 updateMask, BitStream *bstream);
+
    /// Notifies subclasses that the remote host is about to start ghosting objects.
    virtual void onStartGhosting();                              
 
@@ -172,6 +185,9 @@ public:
    GhostConnection();
    ~GhostConnection();
 
+   /// Logs pool usage for our packet notifies and ghost update records, as well as our parent's
+   static void logPoolUsage();
+
    void setGhostFrom(bool ghostFrom); ///< Sets whether ghosts transmit from this side of the connection.
    void setGhostTo(bool ghostTo);     ///< Sets whether ghosts are allowed from the other side of the connection.
 
@@ -222,6 +238,10 @@ public:
    void activateGhosting();                ///< Begins ghosting objects from this GhostConnection to the remote host, starting with the GhostAlways objects.
    bool isGhosting() { return mGhosting; } ///< Returns true if this connection is currently ghosting objects to the remote host.
 
+   /// When set (the default), each packet only puts as many ghosts in priority order as it has room to send, rather
+   /// than sorting every ghost with a pending update.  Either way, the same ghosts are sent in the same order.
+   void setPartialGhostSort(bool partial) { mPartialGhostSort = partial; }
+
    void detachObject(GhostInfo *info);                      ///< Notifies the GhostConnection that the specified GhostInfo should no longer be scoped to the client.
 
    /// RPC from server to client before the GhostAlwaysObjects are transmitted
@@ -209,6 +209,8 @@ protected:
    U32 mPartialUpdateBitsUsed; ///< Number of bits used on partial updates of objects of this class.
    U32 mInitialUpdateCount;    ///< Number of objects of this class constructed over a connection.
    U32 mPartialUpdateCount;    ///< Number of objects of this class updated over a connection.
+   U32 mSharedUpdateHits;      ///< Number of partial updates copied from an update packed for another connection.
+   U32 mSharedUpdateMisses;    ///< Number of partial updates that had to be packed because no copy was available.
 
    /// Next declared NetClassRep.
    ///
@@ -255,6 +257,18 @@ public:
       mPartialUpdateBitsUsed += bitCount;
    }
 
+   /// Records whether a partial update of an object of this class that shares its updates was copied or packed.
+   void addSharedUpdate(bool hit)
+   {
+      if(hit)
+         mSharedUpdateHits++;
+      else
+         mSharedUpdateMisses++;
+   }
+
+   U32 getSharedUpdateHits() const   { return mSharedUpdateHits; }     ///< Returns how many shared partial updates were copied.
+   U32 getSharedUpdateMisses() const { return mSharedUpdateMisses; }   ///< Returns how many shared partial updates were packed.
+
    virtual Object *create() const = 0;             ///< Creates an instance of the class this represents.
 
    /// Returns the number of classes registered under classGroup and classType.
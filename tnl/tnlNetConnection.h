@@ -47,6 +47,10 @@
 #include "tnlConnectionStringTable.h"
 #endif
 
+#ifndef _TNL_DATACHUNKER_H_
+#include "tnlDataChunker.h"
+#endif
+
 namespace TNL {
 
 class NetConnection;
@@ -307,7 +311,14 @@ protected:
    ///
    /// If you need to track additional notification information, you'll have to
    /// override this so you allocate a subclass of PacketNotify with extra fields.
-   virtual PacketNotify *allocNotify() { return new PacketNotify; }
+   virtual PacketNotify *allocNotify();
+
+   /// Frees a data record allocated by allocNotify().
+   ///
+   /// Subclasses that override allocNotify() must override this as well, and call
+   /// clearAllPacketNotifies() in their destructors, as by the time our destructor
+   /// runs, it can only free notifies of our own type.
+   virtual void freeNotify(PacketNotify *note);
 
 public:
    /// Returns the next send sequence that will be sent by this side.
@@ -441,6 +452,8 @@ private:
    U32 mPingSendCount;    ///< Number of unacknowledged ping packets sent to the remote host
    U32 mLastPingSendTime; ///< Last time a ping packet was sent from this connection
 
+   static ClassChunker<PacketNotify> mNotifyChunker;  ///< Quick memory allocator for packet notifies
+
 protected:
    PacketNotify *mNotifyQueueHead;  ///< Linked list of structures representing the data in sent packets
    PacketNotify *mNotifyQueueTail;  ///< Tail of the notify queue linked list.  New packets are added to the end of the tail.
@@ -457,6 +470,10 @@ protected:
 public:
    ConnectionParameters &getConnectionParameters() { return mConnectionParameters; }
 
+   /// Logs how many of the packet records allocated from pools are in use, and how many are waiting to be reused.
+   /// Subclasses with pools of their own log them too.
+   static void logPoolUsage();
+
    /// returns true if this object initiated the connection with the remote host
    bool isInitiator() { return mConnectionParameters.mIsInitiator; }
    void setRemoteConnectionObject(NetConnection *connection) { mRemoteConnection = connection; };
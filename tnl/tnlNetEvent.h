@@ -246,6 +246,10 @@ public:
    /// This allows events to post additional events to the connection that will be send _before_ this event
    virtual void notifyPosted(EventConnection *ps) {}
 
+   /// notifyBroadcast is called on an event before it is posted to more than one EventConnection, so it can get ready
+   /// to be packed for several connections.  See EventConnection::broadcastNetEvent().
+   virtual void notifyBroadcast() {}
+
    /// notifySent is called on each event after all of the events for a packet have
    /// been written into the packet stream.
    virtual void notifySent(EventConnection *ps) {}
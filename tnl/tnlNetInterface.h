@@ -188,6 +188,13 @@ protected:
    ///
    Socket    mSocket;   ///< Network socket this NetInterface communicates over.
 
+   PacketBatch mReceiveBatch;  ///< Buffers for reading incoming packets off the socket several at a time.
+   PacketBatch mSendBatch;     ///< Connection packets written during processConnections, waiting to go out together.
+   bool mQueueingSends;        ///< True while sendto should add packets to mSendBatch instead of sending them.
+
+   /// Sends a packet right away, or adds it to mSendBatch if we're queueing sends.
+   NetError sendOrQueue(const Address &address, const U8 *data, S32 size);
+
    /// @}
 
    U32 mCurrentTime;            /// Current time tracked by this NetInterface.
@@ -352,8 +359,20 @@ public:
    Socket &getSocket() { return mSocket; }
 
    /// Sends a packet to the remote address over this interface's socket.
+   ///
+   /// While processConnections is checking its connections for packets to send, the packet is
+   /// queued instead, and sent along with all the others in as few system calls as possible.
    NetError sendto(const Address &address, BitStream *stream);
 
+   /// Sends any packets that have been queued, and stops queueing them.
+   void flushSendBatch();
+
+   /// Sets whether packets should be moved through the socket in batches, where the platform supports it.
+   void setBatchedIO(bool batchedIO) { mSocket.setBatchedIO(batchedIO); }
+
+   /// Returns true if packets are being moved through the socket in batches.
+   bool usesBatchedIO() const { return mSocket.usesBatchedIO(); }
+
    /// Sends a packet to the remote address after millisecondDelay time has elapsed.
    ///
    /// This is used to simulate network latency on a LAN or single computer.
@@ -362,6 +381,9 @@ public:
    /// Dispatch function for processing all network packets through this NetInterface.
    void checkIncomingPackets();
 
+   /// Waits up to timeoutMillis for packets to arrive.  Returns true if there are packets for checkIncomingPackets.
+   bool waitForIncomingPackets(U32 timeoutMillis) { return mSocket.waitForIncoming(timeoutMillis); }
+
    /// Processes a single packet, and dispatches either to handleInfoPacket or to
    /// the NetConnection associated with the remote address.
    virtual void processPacket(const Address &address, BitStream *packetStream);
@@ -215,6 +215,20 @@ class NetObject : public Object
    GhostInfo *mFirstObjectRef; ///< Head of the linked list of GhostInfos for this object.
 
    static bool mIsInitialUpdate; ///< Managed by GhostConnection - set to true when this is an initial update
+   static U32 mUpdateTick;       ///< Bumped each time the dirty list is collapsed, i.e. once per round of packet writes
+
+   /// A partial update packed for one connection, kept so the other connections can copy it instead of
+   /// calling packUpdate again.  Only used by objects with the SharesUpdates flag.
+   struct SharedUpdate
+   {
+      U32 tick;         ///< mUpdateTick when the update was packed
+      U32 updateMask;   ///< Mask the update was packed with
+      U32 retMask;      ///< What packUpdate returned
+      U32 bitCount;     ///< Size of the update, in bits
+      Vector<U8> bits;  ///< The update itself, starting at bit 0
+   };
+   SharedUpdate *mSharedUpdate;
+
    SafePtr<NetObject> mServerObject; ///< Direct pointer to the parent object on the server if it is a local connection
    GhostConnection *mOwningConnection; ///< The connection that owns this ghost, if it's a ghost
 protected:
@@ -223,6 +237,7 @@ protected:
       IsGhost =            BIT(1),  ///< Set if this is a ghost.
       ScopeLocal =         BIT(2),  ///< If set, this object ghosts only to the local client.
       Ghostable =          BIT(3),  ///< Set if this object can ghost at all.
+      SharesUpdates =      BIT(4),  ///< Set if partial updates are the same for every connection, so can be packed once per tick.
       MaxNetFlagBit = 15
    };
 
@@ -343,6 +358,13 @@ public:
    /// isGhostable returns true if this object can be ghosted to any clients.
    bool isGhostable() const;
 
+   /// sharesUpdates returns true if partial updates of this object can be packed once and copied to every connection.
+   ///
+   /// Objects set SharesUpdates only if their packUpdate, for anything other than the initial update, writes the
+   /// same bits for every connection and has no side effects: no ghost indices, no string table entries or strings,
+   /// and no positions relative to the connection's control object.
+   bool sharesUpdates() const;
+
    /// Return a hash for this object.
    ///
    /// @note This is based on its location in memory.
@@ -374,6 +396,11 @@ inline bool NetObject::isGhostable() const
     return mNetFlags.test(Ghostable);
 }
 
+inline bool NetObject::sharesUpdates() const
+{
+    return mNetFlags.test(SharesUpdates);
+}
+
 // New method gives same results as old, but without the type-punning
 inline U32 NetObject::getHashId() const
 {
@@ -172,15 +172,34 @@ public: \
 /// All declared RPC methods create subclasses of RPCEvent to send data across the wire
 class RPCEvent : public NetEvent
 {
+   /// Arguments packed for one connection, kept so the other connections an event is broadcast to can copy them
+   /// instead of packing them again.
+   struct PackedArgs
+   {
+      U32 bitCount;              ///< Size of the arguments, in bits
+      Vector<U8> bits;           ///< The arguments themselves, starting at bit 0
+      bool usesStringBuffer;     ///< True if the arguments include strings, so the bits depend on the string buffer
+      std::string startString;   ///< Stream's string buffer before the arguments were packed, if usesStringBuffer
+      std::string endString;     ///< ...and after
+   };
+
+   bool mBroadcast;              ///< True if we're being sent to several connections
+   PackedArgs *mPackedArgs;
+
+   void packArgs(BitStream *bstream);
+
 public:
    Functor *mFunctor;
    /// Constructor call from within the rpc<i>Something</i> method generated by the TNL_IMPLEMENT_RPC macro.
    RPCEvent(RPCGuaranteeType gType, RPCDirection dir);
+   ~RPCEvent();
    void pack(EventConnection *ps, BitStream *bstream);
    void unpack(EventConnection *ps, BitStream *bstream);
    virtual bool checkClassType(Object *theObject) = 0;
 
    void process(EventConnection *ps);
+
+   void notifyBroadcast();
 };
 
 /// Declares an RPC method within a class declaration, which can be used for declaring methods in a superclass that will be implemented in a subclass using TNL_DECLARE_RPC and friends.
@@ -144,11 +144,48 @@ enum NetError {
    UnknownError,          ///< There was some other, unknown error.
 };
 
+/// A set of packet buffers, so a Socket can move many datagrams with a single system call on platforms that allow it.
+class PacketBatch
+{
+public:
+   enum {
+      MaxPackets = 32, ///< The most packets a batch can hold
+   };
+
+   /// One datagram, and the address it came from or is going to.
+   struct Packet
+   {
+      Address address;               ///< Source of a received packet, or destination of one being sent
+      S32 size;                      ///< Number of bytes of data in the packet
+      U8 data[MaxPacketDataSize];    ///< The packet data
+   };
+
+private:
+   Packet mPackets[MaxPackets];
+   S32 mCount;
+
+   friend class Socket;
+
+public:
+   PacketBatch() { mCount = 0; }
+
+   S32 getCount() const { return mCount; }          ///< Returns the number of packets in the batch.
+   bool isFull() const { return mCount == MaxPackets; }
+   void clear() { mCount = 0; }                     ///< Empties the batch, so its buffers can be reused.
+
+   Packet &get(S32 index) { return mPackets[index]; }
+   const Packet &get(S32 index) const { return mPackets[index]; }
+
+   /// Copies a packet into the next free buffer.  Returns false if the batch is full or the packet is too big.
+   bool add(const Address &address, const U8 *data, S32 size);
+};
+
 /// The Socket class encapsulates a platform's network socket.
 class Socket
 {
    S32 mPlatformSocket;    ///< The OS-level socket
    U32 mTransportProtocol; ///< The transport type this socket uses.
+   bool mBatchedIO;        ///< True if sendtoBatch and recvfromBatch should use the platform's batched calls
 public:
    enum {
       DefaultBufferSize = 32768, ///< The default send and receive buffer sizes
@@ -177,6 +214,24 @@ public:
    /// @param   bytesRead       Specifies the number of bytes which were actually in the packet.
    NetError recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *bytesRead);
 
+   /// Sends every packet in batch, in order.  Where the platform allows (Linux, with sendmmsg), this takes one system
+   /// call for the whole batch; elsewhere each packet is sent with sendto.  A packet that can't be sent doesn't stop
+   /// the rest; the first error encountered is returned.
+   NetError sendtoBatch(const PacketBatch &batch);
+
+   /// Replaces the contents of batch with as many waiting packets as it will hold, using recvmmsg where available.
+   /// Returns WouldBlock if there was nothing to read, or UnknownError if the socket couldn't be read from at all.
+   NetError recvfromBatch(PacketBatch *batch);
+
+   /// Returns true if this platform can send or receive a batch of packets in a single system call.
+   static bool supportsBatchedIO();
+
+   /// Turns the single-call batched path on or off.  When off, or unsupported, batches are moved one packet at a time.
+   void setBatchedIO(bool batchedIO);
+
+   /// Returns true if batches will be moved with one system call.
+   bool usesBatchedIO() const;
+
    /// Returns the Address corresponding to this socket, as bound on the local machine.
    Address getBoundAddress();
 
@@ -189,6 +244,10 @@ public:
    virtual NetError send(const U8 *buffer, S32 bufferSize);
 
    bool isWritable(U32 timeout = 0);
+
+   /// Waits up to timeoutMillis for a packet to arrive, returning true as soon as there is one waiting to be read.
+   /// A timeout of 0 just checks, without waiting.
+   bool waitForIncoming(U32 timeoutMillis);
 };
 
 //inline void read(BitStream &s, IPAddress *val)
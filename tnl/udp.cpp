@@ -94,6 +94,10 @@ typedef in_addr IN_ADDR;
 
 #define closesocket close
 
+#  if defined(TNL_OS_LINUX)
+#    define TNL_BATCHED_SOCKET_IO     // We have recvmmsg and sendmmsg
+#  endif
+
 #else
 
 #endif
@@ -222,6 +226,7 @@ Socket::Socket(const Address &bindAddress, U32 sendBufferSize, U32 recvBufferSiz
    init();
    mPlatformSocket = INVALID_SOCKET;
    mTransportProtocol = bindAddress.transport;
+   mBatchedIO = supportsBatchedIO();
 
    const char *socketType;
 
@@ -411,6 +416,164 @@ NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *out
    return NoError;
 }
 
+bool PacketBatch::add(const Address &address, const U8 *data, S32 size)
+{
+   if(isFull() || size < 0 || size > (S32)MaxPacketDataSize)
+      return false;
+
+   Packet &packet = mPackets[mCount++];
+   packet.address = address;
+   packet.size = size;
+   memcpy(packet.data, data, size);
+
+   return true;
+}
+
+bool Socket::supportsBatchedIO()
+{
+#ifdef TNL_BATCHED_SOCKET_IO
+   return true;
+#else
+   return false;
+#endif
+}
+
+void Socket::setBatchedIO(bool batchedIO)
+{
+   mBatchedIO = batchedIO && supportsBatchedIO();
+}
+
+bool Socket::usesBatchedIO() const
+{
+   // Journals record and replay individual sendto and recvfrom calls, so they get the packets one at a time
+   return mBatchedIO && Journal::getCurrentMode() == Journal::Inactive;
+}
+
+NetError Socket::sendtoBatch(const PacketBatch &batch)
+{
+   NetError firstError = NoError;
+
+#ifdef TNL_BATCHED_SOCKET_IO
+   if(usesBatchedIO())
+   {
+      mmsghdr headers[PacketBatch::MaxPackets];
+      iovec buffers[PacketBatch::MaxPackets];
+      SOCKADDR addresses[PacketBatch::MaxPackets];
+      S32 count = 0;
+
+      for(S32 i = 0; i < batch.getCount(); i++)
+      {
+         const PacketBatch::Packet &packet = batch.get(i);
+
+         if(packet.address.transport != mTransportProtocol)
+         {
+            if(firstError == NoError)
+               firstError = InvalidPacketProtocol;
+            continue;
+         }
+
+         socklen_t addressSize;
+         TNLToSocketAddress(packet.address, &addresses[count], &addressSize);
+
+         buffers[count].iov_base = (void *) packet.data;
+         buffers[count].iov_len = packet.size;
+
+         memset(&headers[count], 0, sizeof(headers[count]));
+         headers[count].msg_hdr.msg_name = &addresses[count];
+         headers[count].msg_hdr.msg_namelen = addressSize;
+         headers[count].msg_hdr.msg_iov = &buffers[count];
+         headers[count].msg_hdr.msg_iovlen = 1;
+
+         count++;
+      }
+
+      // sendmmsg stops at the first packet it can't send; note the error, skip that packet, and carry on with the rest
+      for(S32 sent = 0; sent < count; )
+      {
+         S32 result = sendmmsg(mPlatformSocket, headers + sent, count - sent, 0);
+
+         if(result > 0)
+            sent += result;
+         else
+         {
+            if(firstError == NoError)
+               firstError = getLastError();
+            sent++;
+         }
+      }
+
+      return firstError;
+   }
+#endif
+
+   for(S32 i = 0; i < batch.getCount(); i++)
+   {
+      const PacketBatch::Packet &packet = batch.get(i);
+      NetError error = sendto(packet.address, packet.data, packet.size);
+
+      if(error != NoError && firstError == NoError)
+         firstError = error;
+   }
+
+   return firstError;
+}
+
+NetError Socket::recvfromBatch(PacketBatch *batch)
+{
+   batch->clear();
+
+#ifdef TNL_BATCHED_SOCKET_IO
+   if(usesBatchedIO())
+   {
+      mmsghdr headers[PacketBatch::MaxPackets];
+      iovec buffers[PacketBatch::MaxPackets];
+      SOCKADDR addresses[PacketBatch::MaxPackets];
+
+      for(S32 i = 0; i < PacketBatch::MaxPackets; i++)
+      {
+         buffers[i].iov_base = batch->mPackets[i].data;
+         buffers[i].iov_len = MaxPacketDataSize;
+
+         memset(&headers[i], 0, sizeof(headers[i]));
+         headers[i].msg_hdr.msg_name = &addresses[i];
+         headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+         headers[i].msg_hdr.msg_iov = &buffers[i];
+         headers[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      // MSG_WAITFORONE: a blocking socket waits for the first packet, as recvfrom would, but not for the batch to fill
+      S32 count = recvmmsg(mPlatformSocket, headers, PacketBatch::MaxPackets, MSG_WAITFORONE, NULL);
+
+      if(count == 0)
+         return WouldBlock;
+
+      if(count == SOCKET_ERROR)
+         return getLastError();     // WouldBlock only when the socket is simply empty
+
+      for(S32 i = 0; i < count; i++)
+      {
+         SocketToTNLAddress(&addresses[i], &batch->mPackets[i].address);
+         batch->mPackets[i].size = headers[i].msg_len;
+      }
+
+      batch->mCount = count;
+      return NoError;
+   }
+#endif
+
+   while(!batch->isFull())
+   {
+      PacketBatch::Packet &packet = batch->mPackets[batch->mCount];
+
+      if(recvfrom(&packet.address, packet.data, MaxPacketDataSize, &packet.size) != NoError)
+         break;
+
+      batch->mCount++;
+   }
+
+   return batch->getCount() > 0 ? NoError : WouldBlock;
+}
+
 NetError Socket::connect(const Address &theAddress)
 {
    SOCKADDR destAddress;
@@ -482,6 +645,35 @@ bool Socket::isWritable(U32 timeoutMillis)
    return FD_ISSET(mPlatformSocket, &fds);
 }
 
+bool Socket::waitForIncoming(U32 timeoutMillis)
+{
+   // Nothing to wait for when the packets are coming from a journal
+   if(Journal::getCurrentMode() == Journal::Playback)
+      return true;
+
+#if defined ( TNL_OS_WIN32 ) || defined ( TNL_OS_XBOX )
+   fd_set fds;
+   FD_ZERO(&fds);
+   FD_SET(mPlatformSocket, &fds);
+
+   timeval timeoutval;
+   timeoutval.tv_sec = timeoutMillis / 1000;
+   timeoutval.tv_usec = (timeoutMillis % 1000) * 1000;
+
+   if(::select(mPlatformSocket + 1, &fds, 0, 0, &timeoutval) == SOCKET_ERROR)
+      return false;
+
+   return FD_ISSET(mPlatformSocket, &fds);
+#else
+   pollfd fd;
+   fd.fd = mPlatformSocket;
+   fd.events = POLLIN;
+   fd.revents = 0;
+
+   return ::poll(&fd, 1, timeoutMillis) > 0 && (fd.revents & POLLIN);
+#endif
+}
+
 #if defined ( TNL_OS_WIN32 )
 void Socket::getInterfaceAddresses(Vector<Address> *addressVector)
 {
@@ -235,6 +235,19 @@ bool isMountableItemType(U8 x)
 }
 
 
+// Things that stay where the level put them
+bool isStationaryType(U8 x)
+{
+   return
+         x == BarrierTypeNumber     || x == PolyWallTypeNumber        || x == WallItemTypeNumber    ||
+         x == LineTypeNumber        || x == TextItemTypeNumber        || x == LoadoutZoneTypeNumber ||
+         x == GoalZoneTypeNumber    || x == NexusTypeNumber           || x == SlipZoneTypeNumber    ||
+         x == SpeedZoneTypeNumber   || x == ZoneTypeNumber            || x == TeleporterTypeNumber  ||
+         x == TurretTypeNumber      || x == ForceFieldTypeNumber      || x == CoreTypeNumber        ||
+         x == ForceFieldProjectorTypeNumber;
+}
+
+
 bool isAnyObjectType(U8 x)
 {
    return true;
@@ -113,6 +113,7 @@ bool isVisibleOnCmdrsMapWithSensorType(U8 x);
 bool isZoneType(U8 x);
 bool isSeekerTarget(U8 x);
 bool isMountableItemType(U8 x);
+bool isStationaryType(U8 x);
 
 bool isAnyObjectType(U8 x);
 // END GAME OBJECT TYPES
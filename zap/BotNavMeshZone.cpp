@@ -12,13 +12,17 @@
 #include "EngineeredItem.h"         // For Turret and ForceFieldProjector methods in generating zones
 #include "GeomUtils.h"
 #include "MathUtils.h"
+#include "stringUtils.h"
+#include "version.h"                // For BUILD_VERSION
 
+#include "tnlBitStream.h"
 #include "tnlLog.h"
 
 #include "../recast/RecastAlloc.h"
 #include <clipper.hpp>
 
 #include <vector>
+#include <queue>
 #include <math.h>
 
 
@@ -38,13 +42,16 @@ namespace Zap
 {
 
 // Declare our statics
-static const S32 MAX_ZONES = 10000;                              // Don't make this go above S16 max - 1 (32,766), AStar::findPath is limited
+static const S32 MAX_ZONES = 10000;                              // Zone ids are U16s, and BotZoneClusters uses U16_MAX for "none"
 const S32 BotNavMeshZone::BufferRadius = Ship::CollisionRadius;  // Radius to buffer objects when creating the holes for zones
 
 // Extra padding around the game extents to allow outsize zones to be created.
 // Make sure we always have 50 for good measure
 const S32 BotNavMeshZone::LevelZoneBuffer = MAX(BufferRadius * 2, 50);
 
+const U32 BotNavMeshZone::CacheFormatVersion = 1;
+static const U32 CacheFileTag = 0x4D4E4642;     // "BFNM"
+
 
 // Constructor
 BotNavMeshZone::BotNavMeshZone(S32 id)
@@ -131,7 +138,7 @@ struct rcEdge
 
 // Build connections between zones using the adjacency data created in recast
 bool BotNavMeshZone::buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotNavMeshZone *> *allZones, 
-                                                               rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap)
+                                                               const rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap)
 {
    if(allZones->size() == 0)      // Nothing to do!
       return true;
@@ -290,14 +297,11 @@ static BotNavMeshZone *findZoneTouchingCircle(const GridDatabase *botZoneDatabas
 #  define LOG_TIMER
 #endif
 
-static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
-                                const Vector<DatabaseObject *> &turrets,
-                                const Vector<DatabaseObject *> &forceFieldProjectors, 
-                                F32 bufferRadius,   PolyTree &solution)
+static void getBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
+                              const Vector<DatabaseObject *> &turrets,
+                              const Vector<DatabaseObject *> &forceFieldProjectors, 
+                              F32 bufferRadius, Vector<Vector<Point> > &inputPolygons)
 {
-
-   Vector<Vector<Point> > inputPolygons;
-
    // Add barriers (PolyWalls are Barriers on the server)
    for(S32 i = 0; i < barriers.size(); i++)
    {
@@ -352,8 +356,6 @@ static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
          inputPolygons[i][j].x = (F32)floor(inputPolygons[i][j].x);
          inputPolygons[i][j].y = (F32)floor(inputPolygons[i][j].y);
       }
-
-   return mergePolysToPolyTree(inputPolygons, solution);
 }
 
 
@@ -372,7 +374,7 @@ void BotNavMeshZone::populateZoneList(GridDatabase *botZoneDatabase, Vector<BotN
 
 // Only runs on server
 static void linkTeleportersBotNavMeshZoneConnections(const GridDatabase *botZoneDatabase,
-                                                     const Vector<pair<Point, const Vector<Point> *> > &teleporterData)
+                                                     const Vector<pair<Point, Vector<Point> > > &teleporterData)
 {
    NeighboringZone neighbor;
    // Now create paths representing the teleporters
@@ -386,9 +388,9 @@ static void linkTeleportersBotNavMeshZoneConnections(const GridDatabase *botZone
       BotNavMeshZone *origZone = findZoneTouchingCircle(botZoneDatabase, origin, triggerRadius);
 
       if(origZone != NULL)
-      for(S32 j = 0; j < teleporterData[i].second->size(); j++)     // Review each teleporter destination
+      for(S32 j = 0; j < teleporterData[i].second.size(); j++)     // Review each teleporter destination
       {
-         dest = teleporterData[i].second->get(j);
+         dest = teleporterData[i].second[j];
          BotNavMeshZone *destZone = findZoneTouchingCircle(botZoneDatabase, dest, triggerRadius);
 
          if(destZone != NULL && origZone != destZone)      // Ignore teleporters that begin and end in the same zone
@@ -411,6 +413,13 @@ static void linkTeleportersBotNavMeshZoneConnections(const GridDatabase *botZone
 }
 
 
+// Constructor
+BotNavMeshGeometry::BotNavMeshGeometry()
+{
+   recastPassed = false;
+}
+
+
 // Server only
 // Use the Triangle library to create zones.  Aggregate triangles with Recast
 bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
@@ -422,10 +431,40 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
    U32 starttime = Platform::getRealMilliseconds();
 #endif
 
-   Rect bounds(worldExtents);      // Modifiable copy
    allZones->deleteAndClear();
 
-   bounds.expandToInt(Point(LevelZoneBuffer, LevelZoneBuffer));      // Provide a little breathing room
+   BotNavMeshGeometry geometry;
+
+   if(!getBotMeshGeometry(worldExtents, barrierList, turretList, forceFieldProjectorList, teleporterData, geometry))
+      return false;
+
+   if(!triangulateBotMeshZones(geometry))
+      return false;
+
+#ifdef LOG_TIMER
+   U32 done1 = Platform::getRealMilliseconds();
+#endif
+
+   addBotMeshZones(botZoneDatabase, allZones, geometry, triangulateZones);
+
+#ifdef LOG_TIMER
+   U32 done2 = Platform::getRealMilliseconds();
+
+   logprintf("Timings: %d %d", done1-starttime, done2-done1);
+#endif
+
+   return true;
+}
+
+
+// Copies everything about the level that the zones depend on into geometry.  Returns false if the level is too big to
+// build zones for.
+bool BotNavMeshZone::getBotMeshGeometry(const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
+                                        const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
+                                        const Vector<pair<Point, const Vector<Point> *> > &teleporterData, BotNavMeshGeometry &geometry)
+{
+   Rect bounds(worldExtents);
+   bounds.expandToInt(Point(LevelZoneBuffer, LevelZoneBuffer));
 
    // Make sure level isn't too big for zone generation, which uses 16 bit ints
    if(bounds.getHeight() >= (F32)U16_MAX || bounds.getWidth() >= (F32)U16_MAX)
@@ -434,12 +473,35 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       return false;
    }
 
-   Vector<F32> holes;
+   geometry.worldExtents = *worldExtents;
+
+   geometry.obstacles.clear();
+   getBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, geometry.obstacles);
+
+   geometry.teleporters.resize(teleporterData.size());
+   for(S32 i = 0; i < teleporterData.size(); i++)
+   {
+      geometry.teleporters[i].first  = teleporterData[i].first;
+      geometry.teleporters[i].second = *teleporterData[i].second;
+   }
+
+   return true;
+}
+
+
+// Triangulates the space around geometry's obstacles, and merges the triangles into convex polygons.  Touches nothing
+// but geometry, so it's fine to run on a worker thread.
+bool BotNavMeshZone::triangulateBotMeshZones(BotNavMeshGeometry &geometry)
+{
+   Rect bounds(geometry.worldExtents);      // Modifiable copy
+
+   bounds.expandToInt(Point(LevelZoneBuffer, LevelZoneBuffer));      // Provide a little breathing room
+
    PolyTree solution;
 
    // Check if this is some sort of degenerate empty level and manually inject a zone.  Using a square because it looks nice;
    // A triangle would work too, and would be a tiny bit more efficient.
-   if(barrierList.size() == 0 && turretList.size() == 0 && forceFieldProjectorList.size() == 0)
+   if(geometry.obstacles.size() == 0)
    {
       Vector<Vector<Point> > inputPolygons(1);
       Vector<Point> points(4);
@@ -457,47 +519,46 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       // Merge bot zone buffers from barriers, turrets, and forcefield projectors
       // The Clipper library is the work horse here.  Its output is essential for the
       // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
-      if(!mergeBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, solution))
+      if(!mergePolysToPolyTree(geometry.obstacles, solution))
          return false;
    }
 
-
-#ifdef LOG_TIMER
-   U32 done1 = Platform::getRealMilliseconds();
-#endif
-
    // Tessellate!
    // This will downscale the Clipper output and use poly2tri to triangulate
-   Vector<Point> outputTriangles;  // Every 3 points is a triangle
-   if(!Triangulate::processComplex(outputTriangles, bounds, solution))
+   geometry.triangles.clear();
+   if(!Triangulate::processComplex(geometry.triangles, bounds, solution))
       return false;
 
-#ifdef LOG_TIMER
-   U32 done2 = Platform::getRealMilliseconds();
-#endif
-
-   bool recastPassed = false;
-   rcPolyMesh mesh;
+   geometry.recastPassed = false;
 
    if(bounds.getWidth() < U16_MAX && bounds.getHeight() < U16_MAX)
    {
-      mesh.offsetX = -1 * (int)floor(bounds.min.x + 0.5f);
-      mesh.offsetY = -1 * (int)floor(bounds.min.y + 0.5f);
-
-      // This works because bounds is always passed by reference.  Is this really needed?
-      bounds.offset(Point(mesh.offsetX, mesh.offsetY));
+      geometry.mesh.offsetX = -1 * (int)floor(bounds.min.x + 0.5f);
+      geometry.mesh.offsetY = -1 * (int)floor(bounds.min.y + 0.5f);
 
       // Merge!  into convex polygons
-      recastPassed = Triangulate::mergeTriangles(outputTriangles, mesh);
+      geometry.recastPassed = Triangulate::mergeTriangles(geometry.triangles, geometry.mesh);
    }
 
+   return true;
+}
+
+
+// Turns triangulated geometry into zones, and links them up
+void BotNavMeshZone::addBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                     const BotNavMeshGeometry &geometry, bool triangulateZones)
+{
+   const rcPolyMesh &mesh = geometry.mesh;
+
+   allZones->deleteAndClear();
+
    populateZoneList(botZoneDatabase, allZones);     // Populate allZones from botZoneDatabase
 
    // So here we are.  If recastPassed, our triangles were successfully aggregated into zones, but will need further polishing below.  If it failed 
    // (which will happen rarely, if ever), the aggregation failed and our zones are just the unaggregated raw triangles that we created before 
    // attempting mergeTriangles.  
 
-   if(recastPassed)
+   if(geometry.recastPassed)
    {
       BotNavMeshZone *botzone = NULL;
       bool addedZones = false;
@@ -557,7 +618,7 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
          populateZoneList(botZoneDatabase, allZones);     // Repopulate allZones with the zones we modified above
 
       buildBotNavMeshZoneConnectionsRecastStyle(allZones, mesh, polyToZoneMap);
-      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, geometry.teleporters);
    }
 
    // If recast failed, build zones from the underlying triangle geometry.  This bit could be made more efficient by using the adjacnecy
@@ -567,6 +628,8 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       TNLAssert(false, "Recast failed -- please report this level to the devs, and pick continue to build zones from triangle output");
       logprintf(LogConsumer::LogLevelError, "There were problems with bot nav zone creation -- please report this level to the devs!");
 
+      const Vector<Point> &outputTriangles = geometry.triangles;
+
       for(S32 i = 0; i < outputTriangles.size(); i+=3)
       {
          if(botZoneDatabase->getObjectCount() >= MAX_ZONES)      // Don't add too many zones...
@@ -587,16 +650,8 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       }
 
       buildBotNavMeshZoneConnections(allZones);
-      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, geometry.teleporters);
    }
-
-#ifdef LOG_TIMER
-   U32 done3 = Platform::getRealMilliseconds();
-
-   logprintf("Timings: %d %d %d", done1-starttime, done2-done1, done3-done2);
-#endif
-
-   return true;
 }
 
 
@@ -651,6 +706,205 @@ void BotNavMeshZone::buildBotNavMeshZoneConnections(const Vector<BotNavMeshZone
 }
 
 
+string BotNavMeshZone::getCacheFileName(const string &cacheDir, const string &levelFileHash)
+{
+   return joindir(cacheDir, levelFileHash + ".navmesh");
+}
+
+
+static void writePoint(BitStream &stream, const Point &point)
+{
+   stream.write(point.x);
+   stream.write(point.y);
+}
+
+
+static void readPoint(BitStream &stream, Point &point)
+{
+   stream.read(&point.x);
+   stream.read(&point.y);
+}
+
+
+// Saves allZones, with their neighbors, to filename.  Returns false if the file couldn't be written.
+bool BotNavMeshZone::writeBotMeshZoneCache(const string &filename, const Vector<BotNavMeshZone *> *allZones)
+{
+   BitStream stream;    // Resizes itself as needed
+
+   stream.write(CacheFileTag);
+   stream.write(CacheFormatVersion);
+   stream.write(U32(BUILD_VERSION));     // Zones from another build might have been made differently
+   stream.write(U32(allZones->size()));
+
+   for(S32 i = 0; i < allZones->size(); i++)
+   {
+      const BotNavMeshZone *zone = allZones->get(i);
+      const Vector<Point> *outline = zone->getOutline();
+
+      stream.write(U32(outline->size()));
+      for(S32 j = 0; j < outline->size(); j++)
+         writePoint(stream, outline->get(j));
+
+      stream.write(U32(zone->mNeighbors.size()));
+      for(S32 j = 0; j < zone->mNeighbors.size(); j++)
+      {
+         const NeighboringZone &neighbor = zone->mNeighbors[j];
+
+         stream.write(neighbor.zoneID);
+         writePoint(stream, neighbor.borderStart);
+         writePoint(stream, neighbor.borderEnd);
+         writePoint(stream, neighbor.borderCenter);
+         writePoint(stream, neighbor.center);
+         stream.write(neighbor.distTo);
+      }
+   }
+
+   if(!stream.isValid())
+      return false;
+
+   FILE *f = fopen(filename.c_str(), "wb");
+   if(!f)
+      return false;
+
+   U32 size = stream.getBytePosition();
+   bool ok = fwrite(stream.getBuffer(), 1, size, f) == size;
+   fclose(f);
+
+   if(!ok)
+      remove(filename.c_str());    // Don't leave half a file lying around
+
+   return ok;
+}
+
+
+// Reads the contents of a nav mesh cache file into data.  Only does file I/O, so it's fine to run on a worker thread.
+// Returns false if there was no file to read.
+bool BotNavMeshZone::loadBotMeshZoneCacheData(const string &filename, string &data)
+{
+   data.clear();
+
+   FILE *f = fopen(filename.c_str(), "rb");
+   if(!f)
+      return false;
+
+   // Read the whole thing in one go -- they're not big
+   fseek(f, 0, SEEK_END);
+   S32 size = (S32)ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if(size > 0)
+      data.resize(size);
+
+   bool ok = size > 0 && fread(&data[0], 1, size, f) == (size_t)size;
+   fclose(f);
+
+   if(!ok)
+      data.clear();
+
+   return ok;
+}
+
+
+// Replaces the contents of botZoneDatabase and allZones with the zones saved in filename.  Returns false, leaving no zones,
+// if the file is missing or isn't one we can use.
+bool BotNavMeshZone::readBotMeshZoneCache(const string &filename, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                          bool triangulateZones)
+{
+   string data;
+
+   if(!loadBotMeshZoneCacheData(filename, data))
+   {
+      allZones->deleteAndClear();
+      return false;
+   }
+
+   return readBotMeshZoneCacheData(data, botZoneDatabase, allZones, triangulateZones);
+}
+
+
+// Same as above, but with the contents of the file already in hand
+bool BotNavMeshZone::readBotMeshZoneCacheData(const string &data, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                              bool triangulateZones)
+{
+   allZones->deleteAndClear();
+
+   if(data.size() == 0)
+      return false;
+
+   U32 size = (U32)data.size();
+   BitStream stream((U8 *)data.data(), size);     // We only read from it, so the cast is harmless
+
+   U32 tag, formatVersion, buildVersion, zoneCount;
+   stream.read(&tag);
+   stream.read(&formatVersion);
+   stream.read(&buildVersion);
+   stream.read(&zoneCount);
+
+   if(!stream.isValid() || tag != CacheFileTag || formatVersion != CacheFormatVersion || buildVersion != U32(BUILD_VERSION) ||
+      zoneCount > U32(MAX_ZONES))
+      return false;
+
+   Point point;
+   NeighboringZone neighbor;
+
+   for(U32 i = 0; i < zoneCount && stream.isValid(); i++)
+   {
+      BotNavMeshZone *zone = new BotNavMeshZone(i);
+
+      // See buildBotMeshZones() for why
+      if(!triangulateZones)
+         zone->disableTriangulation();
+
+      U32 vertCount;
+      stream.read(&vertCount);
+
+      for(U32 j = 0; j < vertCount && stream.isValid(); j++)
+      {
+         readPoint(stream, point);
+         zone->addVert(point);
+      }
+
+      U32 neighborCount;
+      stream.read(&neighborCount);
+
+      for(U32 j = 0; j < neighborCount && stream.isValid(); j++)
+      {
+         stream.read(&neighbor.zoneID);
+         readPoint(stream, neighbor.borderStart);
+         readPoint(stream, neighbor.borderEnd);
+         readPoint(stream, neighbor.borderCenter);
+         readPoint(stream, neighbor.center);
+         stream.read(&neighbor.distTo);
+
+         if(neighbor.zoneID >= zoneCount)    // Neighbors must be zones we know about
+         {
+            delete zone;
+            zone = NULL;
+            break;
+         }
+
+         zone->mNeighbors.push_back(neighbor);
+      }
+
+      if(!zone)
+         break;
+
+      zone->addToZoneDatabase(botZoneDatabase);
+   }
+
+   populateZoneList(botZoneDatabase, allZones);
+
+   // Anything short of a complete, undamaged file, and we're better off building the zones from scratch
+   if(!stream.isValid() || stream.getBytePosition() != size || allZones->size() != (S32)zoneCount)
+   {
+      allZones->deleteAndClear();
+      return false;
+   }
+
+   return true;
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -666,6 +920,334 @@ NeighboringZone::NeighboringZone()
 ////////////////////////////////////////
 
 
+// Zones we'll put in one cluster; big enough that the cluster graph is small, small enough that a corridor of clusters
+// is a lot less than the whole level
+const S32 BotZoneClusters::ClusterSize = 32;
+
+// Constructor
+BotZoneClusters::BotZoneClusters()
+{
+   // Do nothing
+}
+
+
+// Destructor
+BotZoneClusters::~BotZoneClusters()
+{
+   // Do nothing
+}
+
+
+// Grows clusters outward from the lowest numbered zone not yet in one, so each cluster is a connected clump of zones
+void BotZoneClusters::build(const Vector<BotNavMeshZone *> *zones)
+{
+   clear();
+
+   S32 zoneCount = zones->size();
+   mZoneCluster.resize(zoneCount);
+
+   for(S32 i = 0; i < zoneCount; i++)
+      mZoneCluster[i] = U16_MAX;
+
+   Vector<S32> queue;
+   Vector<S32> clusterZoneCounts;
+
+   for(S32 seed = 0; seed < zoneCount; seed++)
+   {
+      if(mZoneCluster[seed] != U16_MAX)
+         continue;
+
+      U16 cluster = (U16)mClusterCenters.size();
+      S32 count = 0;
+      Point centerSum;
+
+      queue.clear();
+      queue.push_back(seed);
+      mZoneCluster[seed] = cluster;
+
+      for(S32 next = 0; next < queue.size(); next++)
+      {
+         BotNavMeshZone *zone = zones->get(queue[next]);
+
+         centerSum += zone->getCenter();
+         count++;
+
+         for(S32 i = 0; i < zone->mNeighbors.size(); i++)
+         {
+            U16 neighbor = zone->mNeighbors[i].zoneID;
+
+            if(mZoneCluster[neighbor] == U16_MAX && queue.size() < ClusterSize)
+            {
+               mZoneCluster[neighbor] = cluster;
+               queue.push_back(neighbor);
+            }
+         }
+      }
+
+      mClusterCenters.push_back(centerSum / (F32)count);
+   }
+
+   // A cluster leads into another if any of its zones do
+   mClusterNeighbors.resize(mClusterCenters.size());
+
+   for(S32 i = 0; i < zoneCount; i++)
+   {
+      Vector<U16> &clusterNeighbors = mClusterNeighbors[mZoneCluster[i]];
+      const Vector<NeighboringZone> &neighbors = zones->get(i)->mNeighbors;
+
+      for(S32 j = 0; j < neighbors.size(); j++)
+      {
+         U16 neighborCluster = mZoneCluster[neighbors[j].zoneID];
+
+         if(neighborCluster != mZoneCluster[i] && !clusterNeighbors.contains(neighborCluster))
+            clusterNeighbors.push_back(neighborCluster);
+      }
+   }
+}
+
+
+void BotZoneClusters::clear()
+{
+   mZoneCluster.clear();
+   mClusterCenters.clear();
+   mClusterNeighbors.clear();
+}
+
+
+S32 BotZoneClusters::getClusterCount() const
+{
+   return mClusterCenters.size();
+}
+
+
+U16 BotZoneClusters::getCluster(S32 zone) const
+{
+   return mZoneCluster[zone];
+}
+
+
+const Point &BotZoneClusters::getClusterCenter(S32 cluster) const
+{
+   return mClusterCenters[cluster];
+}
+
+
+const Vector<U16> &BotZoneClusters::getClusterNeighbors(S32 cluster) const
+{
+   return mClusterNeighbors[cluster];
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+BotFlowField::BotFlowField()
+{
+   mTargetZone = U16_MAX;
+}
+
+
+// Destructor
+BotFlowField::~BotFlowField()
+{
+   // Do nothing
+}
+
+
+// Searches outward from targetZone along the zone links, backwards, so every zone ends up knowing its next step
+// toward the target.  Links can be one-way (teleporters), so we first need to know which links lead into each zone.
+void BotFlowField::build(const Vector<BotNavMeshZone *> *zones, U16 targetZone)
+{
+   clear();
+
+   S32 zoneCount = zones->size();
+
+   mTargetZone = targetZone;
+   mNextZone.resize(zoneCount);
+   mGateway.resize(zoneCount);
+   mTeleporter.resize(zoneCount);
+   mCost.resize(zoneCount);
+
+   for(S32 i = 0; i < zoneCount; i++)
+   {
+      mNextZone[i] = U16_MAX;
+      mTeleporter[i] = 0;
+      mCost[i] = F32_MAX;
+   }
+
+   if(targetZone >= zoneCount)
+      return;
+
+   // Links into each zone, grouped by the zone they lead to: those into zone i are at firstLink[i] to firstLink[i + 1] - 1
+   Vector<S32> firstLink;
+   firstLink.resize(zoneCount + 1);
+
+   for(S32 i = 0; i <= zoneCount; i++)
+      firstLink[i] = 0;
+
+   for(S32 i = 0; i < zoneCount; i++)
+      for(S32 j = 0; j < zones->get(i)->mNeighbors.size(); j++)
+         firstLink[zones->get(i)->mNeighbors[j].zoneID + 1]++;
+
+   for(S32 i = 0; i < zoneCount; i++)
+      firstLink[i + 1] += firstLink[i];
+
+   Vector<S32> linkFrom;            // Zone the link starts in
+   Vector<S32> linkNeighbor;        // Index of the link in that zone's mNeighbors
+   Vector<S32> nextLink;
+
+   linkFrom.resize(firstLink[zoneCount]);
+   linkNeighbor.resize(firstLink[zoneCount]);
+   nextLink.resize(zoneCount);
+
+   for(S32 i = 0; i < zoneCount; i++)
+      nextLink[i] = firstLink[i];
+
+   for(S32 i = 0; i < zoneCount; i++)
+      for(S32 j = 0; j < zones->get(i)->mNeighbors.size(); j++)
+      {
+         S32 link = nextLink[zones->get(i)->mNeighbors[j].zoneID]++;
+         linkFrom[link] = i;
+         linkNeighbor[link] = j;
+      }
+
+   // Min-heap on cost, via negation
+   priority_queue<pair<F32, S32> > open;
+
+   mCost[targetZone] = 0;
+   open.push(pair<F32, S32>(0, targetZone));
+
+   while(!open.empty())
+   {
+      F32 cost = -open.top().first;
+      S32 zone = open.top().second;
+      open.pop();
+
+      if(cost > mCost[zone])     // Stale entry; we've found a better way here since
+         continue;
+
+      for(S32 i = firstLink[zone]; i < firstLink[zone + 1]; i++)
+      {
+         S32 from = linkFrom[i];
+         const NeighboringZone &neighbor = zones->get(from)->mNeighbors[linkNeighbor[i]];
+
+         // Same cost as AStar::findPath uses, so robots take the same routes either way
+         F32 newCost = cost + neighbor.distTo;
+
+         if(newCost < mCost[from])
+         {
+            mCost[from] = newCost;
+            mNextZone[from] = zone;
+            mGateway[from] = neighbor.borderCenter;
+            // Teleporter links run from the teleporter to its destination, with the gateway at the teleporter end;
+            // ordinary links have their gateway in the middle of the shared border
+            mTeleporter[from] = (neighbor.borderCenter == neighbor.borderStart && neighbor.borderStart != neighbor.borderEnd);
+            open.push(pair<F32, S32>(-newCost, from));
+         }
+      }
+   }
+}
+
+
+void BotFlowField::clear()
+{
+   mTargetZone = U16_MAX;
+   mNextZone.clear();
+   mGateway.clear();
+   mTeleporter.clear();
+   mCost.clear();
+}
+
+
+U16 BotFlowField::getTargetZone() const
+{
+   return mTargetZone;
+}
+
+
+bool BotFlowField::canReachTarget(S32 zone) const
+{
+   return zone >= 0 && zone < mCost.size() && mCost[zone] != F32_MAX;
+}
+
+
+// Returns U16_MAX for the target zone itself, and for zones the target can't be reached from
+U16 BotFlowField::getNextZone(S32 zone) const
+{
+   if(zone < 0 || zone >= mNextZone.size())
+      return U16_MAX;
+
+   return mNextZone[zone];
+}
+
+
+// Only meaningful when getNextZone(zone) isn't U16_MAX
+const Point &BotFlowField::getGateway(S32 zone) const
+{
+   return mGateway[zone];
+}
+
+
+bool BotFlowField::isTeleporter(S32 zone) const
+{
+   return mTeleporter[zone] != 0;
+}
+
+
+F32 BotFlowField::getCost(S32 zone) const
+{
+   return mCost[zone];
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+AStar::Context::Context()
+{
+   mOnClosedList = 0;
+}
+
+
+// Destructor
+AStar::Context::~Context()
+{
+   // Do nothing
+}
+
+
+// Make sure we have room for searching zoneCount zones
+void AStar::Context::prepare(S32 zoneCount)
+{
+   if(mWhichList.size() < zoneCount)
+   {
+      mWhichList.resize(zoneCount);
+      mOpenList.resize(zoneCount + 1);
+      mOpenZone.resize(zoneCount + 1);
+      mParentZones.resize(zoneCount);
+      mFcost.resize(zoneCount + 1);
+      mHcost.resize(zoneCount + 1);
+      mGcost.resize(zoneCount);
+
+      mOnClosedList = U16_MAX;      // Forces whichList to be cleared below, which will take care of the new parts
+   }
+
+   // This lets us repeatedly reuse the whichList array without resetting it or recreating it, which, for larger numbers 
+   // of zones should be a real time saver.  It's not clear if it is particularly more efficient for the zone counts we 
+   // typically see in Bitfighter levels.
+   if(mOnClosedList > U16_MAX - 3)  // Reset whichList when we've run out of headroom
+   {
+      for(S32 i = 0; i < mWhichList.size(); i++)
+         mWhichList[i] = 0;
+      mOnClosedList = 0;
+   }
+
+   mOnClosedList += 2;  // Changing the values of onOpenList and onClosed list is faster than redimming whichList() array
+}
+
+
 // Rough guess as to distance from fromZone to toZone
 F32 AStar::heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 toZone)
 {
@@ -673,42 +1255,122 @@ F32 AStar::heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 to
 }
 
 
-// Returns a path, including the startZone and targetZone 
+// Finds the clusters a path from startCluster to targetCluster should go through, and marks them, plus the clusters
+// next to them, in context.mCorridor.  There are only ever a few hundred clusters, so a plain Dijkstra does fine here.
+// Returns false if there's no way through.
+bool AStar::findCorridor(const BotZoneClusters *clusters, S32 startCluster, S32 targetCluster, Context &context)
+{
+   S32 clusterCount = clusters->getClusterCount();
+
+   context.mCorridor.resize(clusterCount);
+   context.mClusterParents.resize(clusterCount);
+   context.mClusterCosts.resize(clusterCount);
+
+   for(S32 i = 0; i < clusterCount; i++)
+   {
+      context.mCorridor[i] = 0;
+      context.mClusterParents[i] = -1;
+      context.mClusterCosts[i] = F32_MAX;
+   }
+
+   // Min-heap on cost, via negation
+   priority_queue<pair<F32, S32> > open;
+
+   context.mClusterCosts[startCluster] = 0;
+   open.push(pair<F32, S32>(0, startCluster));
+
+   while(!open.empty())
+   {
+      F32 cost = -open.top().first;
+      S32 cluster = open.top().second;
+      open.pop();
+
+      if(cluster == targetCluster)
+         break;
+
+      if(cost > context.mClusterCosts[cluster])     // Stale entry; we've found a better way here since
+         continue;
+
+      const Vector<U16> &neighbors = clusters->getClusterNeighbors(cluster);
+
+      for(S32 i = 0; i < neighbors.size(); i++)
+      {
+         S32 neighbor = neighbors[i];
+         F32 newCost = cost + clusters->getClusterCenter(cluster).distanceTo(clusters->getClusterCenter(neighbor));
+
+         if(newCost < context.mClusterCosts[neighbor])
+         {
+            context.mClusterCosts[neighbor] = newCost;
+            context.mClusterParents[neighbor] = cluster;
+            open.push(pair<F32, S32>(-newCost, neighbor));
+         }
+      }
+   }
+
+   if(startCluster != targetCluster && context.mClusterParents[targetCluster] == -1)
+      return false;
+
+   // Mark the clusters on the path, and their neighbors, so the zone search has some room to find a good line
+   for(S32 cluster = targetCluster; cluster != -1; cluster = context.mClusterParents[cluster])
+   {
+      context.mCorridor[cluster] = 1;
+
+      const Vector<U16> &neighbors = clusters->getClusterNeighbors(cluster);
+      for(S32 i = 0; i < neighbors.size(); i++)
+         context.mCorridor[neighbors[i]] = 1;
+   }
+
+   return true;
+}
+
+
+// Returns a path, including the startZone and targetZone.  Uses its own scratch space, so it's safe to call from
+// anywhere, but if you're going to be doing a lot of searches, keep a Context around and use the version below.
 Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target)
 {
-   // Because of these variables...
-   static U16 onClosedList = 0;
-   static U16 onOpenList;
+   Context context;
+   return findPath(zones, startZone, targetZone, target, context);
+}
+
 
-   // ...these arrays can be reused without further initialization
-   static U16 whichList[MAX_ZONES];       // Record whether a zone is on the open or closed list
-   static S16 openList[MAX_ZONES + 1]; 
-   static S16 openZone[MAX_ZONES]; 
-   static S16 parentZones[MAX_ZONES]; 
+// Returns a path, including the startZone and targetZone.  If clusters is given, and the zones are far enough apart
+// to be worth it, we'll plan the route over the clusters first, and only search the zones along it.  If that doesn't
+// work out, we'll fall back to searching all of them.
+Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target,
+                              Context &context, const BotZoneClusters *clusters)
+{
+   bool useCorridor = false;
 
-   static F32 Fcost[MAX_ZONES];   
-   static F32 Gcost[MAX_ZONES];    
-   static F32 Hcost[MAX_ZONES];   
+   if(clusters && clusters->getClusterCount() > 2)
+   {
+      S32 startCluster  = clusters->getCluster(startZone);
+      S32 targetCluster = clusters->getCluster(targetZone);
 
-   S16 numberOfOpenListItems = 0;
+      // If they're in the same or neighboring clusters, the corridor wouldn't save us anything
+      if(startCluster != targetCluster && !clusters->getClusterNeighbors(startCluster).contains(targetCluster))
+         useCorridor = findCorridor(clusters, startCluster, targetCluster, context);
+   }
+
+   context.prepare(zones->size());
+
+   const U16 onClosedList = context.mOnClosedList;
+   const U16 onOpenList = onClosedList - 1;
+
+   U16 *whichList    = context.mWhichList.address();
+   S32 *openList     = context.mOpenList.address();
+   S32 *openZone     = context.mOpenZone.address();
+   S32 *parentZones  = context.mParentZones.address();
+   F32 *Fcost        = context.mFcost.address();
+   F32 *Hcost        = context.mHcost.address();
+   F32 *Gcost        = context.mGcost.address();
+
+   S32 numberOfOpenListItems = 0;
    bool foundPath;
 
    S32 newOpenListItemID = 0;         // Used for creating new IDs for zones to make heap work
 
    Vector<Point> path;
 
-   // This block here lets us repeatedly reuse the whichList array without resetting it or recreating it
-   // which, for larger numbers of zones should be a real time saver.  It's not clear if it is particularly
-   // more efficient for the zone counts we typically see in Bitfighter levels.
-   if(onClosedList > U16_MAX - 3 ) // Reset whichList when we've run out of headroom
-   {
-      for(S32 i = 0; i < MAX_ZONES; i++) 
-         whichList[i] = 0;
-      onClosedList = 0;   
-   }
-   onClosedList = onClosedList + 2; // Changing the values of onOpenList and onClosed list is faster than redimming whichList() array
-   onOpenList = onClosedList - 1;
-
    Gcost[startZone] = 0;         // That's the cost of going from the startZone to the startZone!
    Fcost[0] = Hcost[0] = heuristic(zones, startZone, targetZone);
 
@@ -746,12 +1408,12 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
             
          //   Delete the top item in binary heap and reorder the heap, with the lowest F cost item rising to the top.
          openList[1] = openList[numberOfOpenListItems + 1];   // Move the last item in the heap up to slot #1
-         S16 v = 1; 
+         S32 v = 1; 
 
          //   Loop until the new item in slot #1 sinks to its proper spot in the heap.
          while(true) // ***
          {
-            S16 u = v;      
+            S32 u = v;      
             if (2 * u + 1 < numberOfOpenListItems) // if both children exist
             {
                // Check if the F cost of the parent is greater than each child,
@@ -770,7 +1432,7 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
 
             if(u != v) // If parent's F is > one of its children, swap them...
             {
-               S16 temp = openList[u];
+               S32 temp = openList[u];
                openList[u] = openList[v];
                openList[v] = temp;         
             }
@@ -784,11 +1446,11 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
          // Add these adjacent child squares to the open list
          //   for later consideration if appropriate.
 
-         Vector<NeighboringZone> neighboringZones = zones->get(parentZone)->mNeighbors;
+         const Vector<NeighboringZone> &neighboringZones = zones->get(parentZone)->mNeighbors;
 
          for(S32 a = 0; a < neighboringZones.size(); a++)
          {
-            NeighboringZone zone = neighboringZones[a];
+            const NeighboringZone &zone = neighboringZones[a];
             S32 zoneID = zone.zoneID;
 
             //   Check if zone is already on the closed list (items on the closed list have
@@ -796,9 +1458,12 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
             if(whichList[zoneID] == onClosedList) 
                continue;
 
+            // Stay inside the corridor, if we have one
+            if(useCorridor && !context.mCorridor[clusters->getCluster(zoneID)])
+               continue;
+
             //   Add zone to the open list if it's not already on it
-            TNLAssert(newOpenListItemID < MAX_ZONES, "Too many nav zones... try increasing MAX_ZONES!");
-            if(whichList[zoneID] != onOpenList && newOpenListItemID < MAX_ZONES) 
+            if(whichList[zoneID] != onOpenList && newOpenListItemID < zones->size()) 
             {   
                // Create a new open list item in the binary heap
                newOpenListItemID = newOpenListItemID + 1;   // Give each new item a unique id
@@ -817,7 +1482,7 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
                // or bubbles all the way to the top (if it has the lowest F cost).
                while(m > 1 && Fcost[openList[m]] <= Fcost[openList[m/2]]) 
                {
-                  S16 temp = openList[m/2];
+                  S32 temp = openList[m/2];
                   openList[m/2] = openList[m];
                   openList[m] = temp;
                   m = m/2;
@@ -835,14 +1500,14 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
             else // zone was already on the open list
             {
                // Figure out the G cost of this possible new path
-               S32 tempGcost = (S32)(Gcost[parentZone] + zone.distTo);
+               F32 tempGcost = Gcost[parentZone] + zone.distTo;
                
                // If this path is shorter (G cost is lower) then change
                // the parent cell, G cost and F cost.
                if(tempGcost < Gcost[zoneID])
                {
                   parentZones[zoneID] = parentZone; // Change the square's parent
-                  Gcost[zoneID] = (F32)tempGcost;        // and its G cost         
+                  Gcost[zoneID] = tempGcost;        // and its G cost         
 
                   // Because changing the G cost also changes the F cost, if
                   // the item is on the open list we need to change the item's
@@ -859,7 +1524,7 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
                         S32 m = i;
                         while(m > 1 && Fcost[openList[m]] < Fcost[openList[m/2]]) 
                         {
-                           S16 temp = openList[m/2];
+                           S32 temp = openList[m/2];
                            openList[m/2] = openList[m];
                            openList[m] = temp;
                            m = m/2;
@@ -886,6 +1551,11 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
    if(!foundPath)
    {      
       TNLAssert(path.size() == 0, "Expected empty path!");
+
+      // The corridor can miss a way through that the full graph has -- one-way teleporters can do that
+      if(useCorridor)
+         return findPath(zones, startZone, targetZone, target, context);
+
       return path;
    }
 
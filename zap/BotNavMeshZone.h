@@ -41,6 +41,30 @@ public:
 
 class ServerGame;
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// What a level's zones are built around, copied out of its objects, and what triangulating around it produces.  The
+// triangulating is the slow part of building zones, and as it doesn't touch the game, it can be done on a worker thread.
+struct BotNavMeshGeometry
+{
+   Rect worldExtents;
+   Vector<Vector<Point> > obstacles;                  // Buffered outlines of walls, turrets and forcefield projectors
+   Vector<pair<Point, Vector<Point> > > teleporters;  // Each teleporter, with its destinations
+
+   // Filled in by BotNavMeshZone::triangulateBotMeshZones()
+   Vector<Point> triangles;                           // Every 3 points is a triangle
+   rcPolyMesh mesh;                                   // The triangles merged into convex polygons, if recastPassed
+   bool recastPassed;
+
+   BotNavMeshGeometry();      // Constructor
+
+private:
+   BotNavMeshGeometry(const BotNavMeshGeometry &);             // Not copyable; mesh owns its memory
+   BotNavMeshGeometry &operator=(const BotNavMeshGeometry &);
+};
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -84,9 +108,88 @@ public:
                                  const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
                                  const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones);
 
+   // buildBotMeshZones() in three steps, for callers that want to do the middle one elsewhere.  Only
+   // triangulateBotMeshZones() is safe to run off the main thread.
+   static bool getBotMeshGeometry(const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
+                                  const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
+                                  const Vector<pair<Point, const Vector<Point> *> > &teleporterData, BotNavMeshGeometry &geometry);
+   static bool triangulateBotMeshZones(BotNavMeshGeometry &geometry);
+   static void addBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                               const BotNavMeshGeometry &geometry, bool triangulateZones);
+
    static bool buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotNavMeshZone *> *allZones, 
-                                                         rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap);
+                                                         const rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap);
    static void buildBotNavMeshZoneConnections(const Vector<BotNavMeshZone *> *allZones);
+
+   // Nav mesh cache -- saves the finished zones and their connections, so we don't have to build them every time the
+   // level is played
+   static const U32 CacheFormatVersion;      // Bump this when the file layout changes
+
+   static string getCacheFileName(const string &cacheDir, const string &levelFileHash);
+   static bool writeBotMeshZoneCache(const string &filename, const Vector<BotNavMeshZone *> *allZones);
+   static bool readBotMeshZoneCache(const string &filename, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                    bool triangulateZones);
+   static bool loadBotMeshZoneCacheData(const string &filename, string &data);
+   static bool readBotMeshZoneCacheData(const string &data, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                        bool triangulateZones);
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Groups neighboring zones into clusters of a few dozen, so a path across a big level can be planned over the clusters
+// first, and the zone-by-zone search only has to look at the clusters along the way.  Built whenever the zones are.
+class BotZoneClusters
+{
+private:
+   Vector<U16> mZoneCluster;                    // Cluster each zone belongs to
+   Vector<Point> mClusterCenters;               // Average of the centers of each cluster's zones
+   Vector<Vector<U16> > mClusterNeighbors;      // Clusters each cluster has a zone leading into
+
+public:
+   static const S32 ClusterSize;                // Most zones we'll put in one cluster
+
+   BotZoneClusters();            // Constructor
+   virtual ~BotZoneClusters();   // Destructor
+
+   void build(const Vector<BotNavMeshZone *> *zones);
+   void clear();
+
+   S32 getClusterCount() const;
+   U16 getCluster(S32 zone) const;
+   const Point &getClusterCenter(S32 cluster) const;
+   const Vector<U16> &getClusterNeighbors(S32 cluster) const;
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// The best way to one target zone from every other zone, found with a single search outward from the target.  Any number
+// of robots headed for the same place can then look up their next step, rather than each searching for a path.
+class BotFlowField
+{
+private:
+   U16 mTargetZone;
+   Vector<U16> mNextZone;       // Next zone on the way to the target, or U16_MAX if the target can't be reached
+   Vector<Point> mGateway;      // Where to leave each zone to get to its next zone
+   Vector<U8> mTeleporter;      // Whether the gateway is a teleporter
+   Vector<F32> mCost;           // Distance to the target
+
+public:
+   BotFlowField();            // Constructor
+   virtual ~BotFlowField();   // Destructor
+
+   void build(const Vector<BotNavMeshZone *> *zones, U16 targetZone);
+   void clear();
+
+   U16 getTargetZone() const;
+   bool canReachTarget(S32 zone) const;
+   U16 getNextZone(S32 zone) const;
+   const Point &getGateway(S32 zone) const;
+   bool isTeleporter(S32 zone) const;
+   F32 getCost(S32 zone) const;
 };
 
 
@@ -95,13 +198,43 @@ public:
 
 class AStar
 {
+public:
+   // Scratch space for a search.  Reusing one saves clearing and allocating it every time, and searches with different
+   // contexts can run at the same time.
+   class Context
+   {
+      friend class AStar;
+
+   private:
+      U16 mOnClosedList;               // Lets whichList be reused without clearing; see findPath()
+      Vector<U16> mWhichList;          // Whether each zone is on the open or closed list
+      Vector<S32> mOpenList;           // Binary heap of open list item ids
+      Vector<S32> mOpenZone;           // Zone for each open list item
+      Vector<S32> mParentZones;
+      Vector<F32> mFcost;              // By open list item
+      Vector<F32> mHcost;              // By open list item
+      Vector<F32> mGcost;              // By zone
+
+      Vector<U8> mCorridor;            // Clusters a hierarchical search may use
+      Vector<S32> mClusterParents;
+      Vector<F32> mClusterCosts;
+
+      void prepare(S32 zoneCount);
+
+   public:
+      Context();            // Constructor
+      virtual ~Context();   // Destructor
+   };
+
 private:
    static F32 heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 toZone);
    static Point findGateway(const Vector<BotNavMeshZone *> *zones, S32 zone1, S32 zone2);
+   static bool findCorridor(const BotZoneClusters *clusters, S32 startCluster, S32 targetCluster, Context &context);
 
 public:
-   static Vector<Point> findPath (const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
-   
+   static Vector<Point> findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
+   static Vector<Point> findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target,
+                                 Context &context, const BotZoneClusters *clusters = NULL);
 };
 
 
@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotPathCache.h"
+
+
+namespace Zap
+{
+
+// Statics
+const S32 BotPathCache::DefaultCapacity = 1024;
+const S32 BotFlowFieldCache::DefaultCapacity = 32;
+
+
+// Constructor
+BotPathCache::BotPathCache(S32 capacity)
+{
+   mCapacity = capacity > 0 ? capacity : 1;
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+// Destructor
+BotPathCache::~BotPathCache()
+{
+   // Do nothing
+}
+
+
+U32 BotPathCache::makeKey(U16 startZone, U16 targetZone)
+{
+   return (U32(startZone) << 16) | targetZone;
+}
+
+
+const Vector<Point> *BotPathCache::find(U16 startZone, U16 targetZone)
+{
+   map<U32, EntryList::iterator>::iterator it = mIndex.find(makeKey(startZone, targetZone));
+
+   if(it == mIndex.end())
+   {
+      mMisses++;
+      return NULL;
+   }
+
+   mHits++;
+
+   // Move to the front, as the most recently used
+   mEntries.splice(mEntries.begin(), mEntries, it->second);
+
+   return &it->second->path;
+}
+
+
+void BotPathCache::add(U16 startZone, U16 targetZone, const Vector<Point> &path)
+{
+   U32 key = makeKey(startZone, targetZone);
+   map<U32, EntryList::iterator>::iterator it = mIndex.find(key);
+
+   if(it != mIndex.end())
+   {
+      it->second->path = path;
+      mEntries.splice(mEntries.begin(), mEntries, it->second);
+      return;
+   }
+
+   // Make room by dropping the least recently used path
+   if((S32)mIndex.size() >= mCapacity)
+   {
+      mIndex.erase(mEntries.back().key);
+      mEntries.pop_back();
+   }
+
+   mEntries.push_front(Entry());
+   mEntries.front().key = key;
+   mEntries.front().path = path;
+
+   mIndex[key] = mEntries.begin();
+}
+
+
+void BotPathCache::clear()
+{
+   mEntries.clear();
+   mIndex.clear();
+}
+
+
+void BotPathCache::resetStats()
+{
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+S32 BotPathCache::getSize() const
+{
+   return (S32)mIndex.size();
+}
+
+
+S32 BotPathCache::getCapacity() const
+{
+   return mCapacity;
+}
+
+
+U32 BotPathCache::getHits() const
+{
+   return mHits;
+}
+
+
+U32 BotPathCache::getMisses() const
+{
+   return mMisses;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+BotFlowFieldCache::BotFlowFieldCache(S32 capacity)
+{
+   mCapacity = capacity > 0 ? capacity : 1;
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+// Destructor
+BotFlowFieldCache::~BotFlowFieldCache()
+{
+   // Do nothing
+}
+
+
+const BotFlowField *BotFlowFieldCache::get(const Vector<BotNavMeshZone *> *zones, U16 targetZone)
+{
+   map<U16, FieldList::iterator>::iterator it = mIndex.find(targetZone);
+
+   if(it != mIndex.end())
+   {
+      mHits++;
+      mFields.splice(mFields.begin(), mFields, it->second);
+      return &mFields.front();
+   }
+
+   mMisses++;
+
+   // Reuse the least recently used field if we're full, rather than freeing it and allocating another
+   if((S32)mIndex.size() >= mCapacity)
+   {
+      mIndex.erase(mFields.back().getTargetZone());
+      mFields.splice(mFields.begin(), mFields, --mFields.end());
+   }
+   else
+      mFields.push_front(BotFlowField());
+
+   mFields.front().build(zones, targetZone);
+   mIndex[targetZone] = mFields.begin();
+
+   return &mFields.front();
+}
+
+
+void BotFlowFieldCache::clear()
+{
+   mFields.clear();
+   mIndex.clear();
+}
+
+
+void BotFlowFieldCache::resetStats()
+{
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+S32 BotFlowFieldCache::getSize() const
+{
+   return (S32)mIndex.size();
+}
+
+
+S32 BotFlowFieldCache::getCapacity() const
+{
+   return mCapacity;
+}
+
+
+U32 BotFlowFieldCache::getHits() const
+{
+   return mHits;
+}
+
+
+U32 BotFlowFieldCache::getMisses() const
+{
+   return mMisses;
+}
+
+
+}
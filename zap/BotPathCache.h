@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _BOT_PATH_CACHE_H_
+#define _BOT_PATH_CACHE_H_
+
+#include "BotNavMeshZone.h"
+#include "Point.h"
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <list>
+#include <map>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Zone-to-zone paths that robots have asked for, shared by all the robots on the server.  Holds a limited number,
+// throwing out whichever has gone unused the longest when it needs room.
+class BotPathCache
+{
+private:
+   struct Entry
+   {
+      U32 key;
+      Vector<Point> path;
+   };
+
+   typedef list<Entry> EntryList;
+
+   EntryList mEntries;                          // Most recently used first
+   map<U32, EntryList::iterator> mIndex;        // Where each path is in mEntries
+
+   S32 mCapacity;
+   U32 mHits;
+   U32 mMisses;
+
+   static U32 makeKey(U16 startZone, U16 targetZone);
+
+public:
+   static const S32 DefaultCapacity;
+
+   explicit BotPathCache(S32 capacity = DefaultCapacity);    // Constructor
+   virtual ~BotPathCache();                                  // Destructor
+
+   // Returns NULL if we don't have a path between these zones.  Counts as a hit or a miss.
+   const Vector<Point> *find(U16 startZone, U16 targetZone);
+   void add(U16 startZone, U16 targetZone, const Vector<Point> &path);
+
+   void clear();           // Forget all paths; call when the zones change
+   void resetStats();
+
+   S32 getSize() const;
+   S32 getCapacity() const;
+   U32 getHits() const;
+   U32 getMisses() const;
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Flow fields for the zones robots are heading to, shared by all the robots on the server.  A field stays good until the
+// zones change, so a target only costs a search when it moves into a zone nobody has headed for lately.
+class BotFlowFieldCache
+{
+private:
+   typedef list<BotFlowField> FieldList;
+
+   FieldList mFields;                           // Most recently used first
+   map<U16, FieldList::iterator> mIndex;        // Where the field for each target zone is in mFields
+
+   S32 mCapacity;
+   U32 mHits;
+   U32 mMisses;
+
+public:
+   static const S32 DefaultCapacity;
+
+   explicit BotFlowFieldCache(S32 capacity = DefaultCapacity);    // Constructor
+   virtual ~BotFlowFieldCache();                                  // Destructor
+
+   // Builds the field for targetZone if we don't have it.  Counts as a hit or a miss.
+   const BotFlowField *get(const Vector<BotNavMeshZone *> *zones, U16 targetZone);
+
+   void clear();           // Forget all fields; call when the zones change
+   void resetStats();
+
+   S32 getSize() const;
+   S32 getCapacity() const;
+   U32 getHits() const;
+   U32 getMisses() const;
+};
+
+
+}
+
+#endif
@@ -580,6 +580,21 @@ void clearCacheHandler(ClientGame *game, const Vector<string> &words)
 }
 
 
+// Profiling is done on the server, so the command is passed on to it
+void luaProfHandler(ClientGame *game, const Vector<string> &words)
+{
+   if(game->hasAdmin("!!! Need admin permissions"))
+   {
+      Vector<StringPtr> args;
+
+      for(S32 i = 1; i < words.size(); i++)
+         args.push_back(StringPtr(words[i]));
+
+      game->sendCommand(StringTableEntry(words[0], false), args);
+   }
+}
+
+
 void pmHandler(ClientGame *game, const Vector<string> &words)
 {
    if(words.size() < 3)
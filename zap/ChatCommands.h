@@ -103,6 +103,7 @@ void voiceMuteHandler          (ClientGame *game, const Vector<string> &args);
 void maxFpsHandler             (ClientGame *game, const Vector<string> &args);
 void lagHandler                (ClientGame *game, const Vector<string> &args);
 void clearCacheHandler         (ClientGame *game, const Vector<string> &args);
+void luaProfHandler            (ClientGame *game, const Vector<string> &args);
 void lineWidthHandler          (ClientGame *game, const Vector<string> &args);
 void idleHandler               (ClientGame *game, const Vector<string> &args);
 void showPresetsHandler        (ClientGame *game, const Vector<string> &args);
@@ -98,6 +98,7 @@ namespace Zap
    { "maxfps",     &ChatCommands::maxFpsHandler,        { xINT },    1, DEBUG_COMMANDS, 1,  1, {"<number>"},  "Set maximum speed of game in frames per second" },
    { "lag",        &ChatCommands::lagHandler, {xINT,xINT,xINT,xINT}, 4, DEBUG_COMMANDS, 1,  2, {"<send lag>", "[% of send drop packets]", "[receive lag]", "[% of receive drop packets]" }, "Set additional lag and dropped packets for testing bad networks" },
    { "clearcache", &ChatCommands::clearCacheHandler,    {  },        0, DEBUG_COMMANDS, 1,  1, { },           "Clear any cached scripts, forcing them to be reloaded" },
+   { "luaprof",    &ChatCommands::luaProfHandler,       { STR },     1, DEBUG_COMMANDS, 1,  1, {"[on | off | reset]"}, "Profile robot and levelgen scripts; show results if no arg" },
 
    // The following are only available in debug builds!
 #ifdef TNL_DEBUG
@@ -0,0 +1,345 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "CollisionBroadphase.h"
+
+#include "moveObject.h"
+#include "ship.h"       // For Ship::BoostMaxVelocity
+
+#include <algorithm>    // For lower_bound
+
+namespace Zap
+{
+
+const F32 CollisionBroadphase::MinSweepSpeed = (F32)Ship::BoostMaxVelocity;
+
+static const F32 SweepSlack = 2.0f;    // A little extra room, so rounding won't push objects out of their sweeps
+
+
+// Constructor
+CollisionBroadphase::CollisionBroadphase()
+{
+   mDatabase = NULL;
+   mEnabled = true;
+}
+
+
+// Destructor
+CollisionBroadphase::~CollisionBroadphase()
+{
+   endTick();
+}
+
+
+void CollisionBroadphase::setEnabled(bool enabled)
+{
+   mEnabled = enabled;
+}
+
+
+bool CollisionBroadphase::isEnabled() const
+{
+   return mEnabled;
+}
+
+
+bool CollisionBroadphase::isActive() const
+{
+   return mDatabase != NULL;
+}
+
+
+// Find everything the movers in database might run into during the next timeDelta ms, and start watching database for changes
+void CollisionBroadphase::beginTick(GridDatabase *database, U32 timeDelta)
+{
+   endTick();
+
+   if(!mEnabled || !database)
+      return;
+
+   mDatabase = database;
+   mDatabase->setBroadphase(this);
+
+   collectMovers(timeDelta * 0.001f);
+   collectCandidates();
+}
+
+
+void CollisionBroadphase::endTick()
+{
+   if(mDatabase)
+      mDatabase->setBroadphase(NULL);
+
+   mDatabase = NULL;
+
+   mMovers.clear();
+   mMoverLookup.clear();
+   mCandidates.clear();
+   mChangedObjects.clear();
+   mRemovedObjects.clear();
+   mChangedList.clear();
+}
+
+
+bool CollisionBroadphase::isLeftOf(const Mover &a, const Mover &b)
+{
+   return a.sweep.min.x < b.sweep.min.x;
+}
+
+
+void CollisionBroadphase::collectMovers(F32 timeDelta)
+{
+   const Vector<DatabaseObject *> *objects = mDatabase->findObjects_fast();
+
+   for(S32 i = 0; i < objects->size(); i++)
+   {
+      BfObject *obj = static_cast<BfObject *>(objects->get(i));
+
+      if(!obj->isMoveObject())
+         continue;
+
+      MoveObject *moveObject = static_cast<MoveObject *>(obj);
+
+      F32 travel = max(moveObject->getActualVel().len(), MinSweepSpeed) * timeDelta + SweepSlack;
+
+      Mover mover;
+      mover.sweep = moveObject->getExtent();
+      mover.sweep.expand(Point(travel, travel));
+      mover.object = moveObject;
+      mover.collideTypes = moveObject->collideTypes();
+      mover.types = mDatabase->getTypeMask(mover.collideTypes);
+      mover.firstCandidate = 0;
+      mover.candidateCount = 0;
+
+      mMovers.push_back(mover);
+   }
+
+   std::sort(mMovers.address(), mMovers.address() + mMovers.size(), isLeftOf);
+
+   mMoverLookup.resize(mMovers.size());
+
+   for(S32 i = 0; i < mMovers.size(); i++)
+   {
+      mMoverLookup[i].object = mMovers[i].object;
+      mMoverLookup[i].index = i;
+   }
+
+   std::sort(mMoverLookup.address(), mMoverLookup.address() + mMoverLookup.size());
+}
+
+
+// Visitor for collectCandidates -- other movers are found by sort-and-sweep, so we only want things that stay put
+bool CollisionBroadphase::addStaticCandidate(DatabaseObject *object, void *context)
+{
+   if(!static_cast<BfObject *>(object)->isMoveObject())
+      static_cast<Vector<DatabaseObject *> *>(context)->push_back(object);
+
+   return true;
+}
+
+
+void CollisionBroadphase::collectCandidates()
+{
+   // Sort-and-sweep: mMovers is ordered by the left edge of their sweeps, so each mover only needs to be checked against
+   // those that follow it, up until the first one that starts right of where it ends
+   mPairs.clear();
+   mPartnerOffsets.resize(mMovers.size() + 1);
+
+   for(S32 i = 0; i < mPartnerOffsets.size(); i++)
+      mPartnerOffsets[i] = 0;
+
+   for(S32 i = 0; i < mMovers.size(); i++)
+      for(S32 j = i; j < mMovers.size() && mMovers[j].sweep.min.x <= mMovers[i].sweep.max.x; j++)
+         if(j == i || mMovers[i].sweep.intersectsOrBorders(mMovers[j].sweep))
+         {
+            mPairs.push_back(i);
+            mPairs.push_back(j);
+
+            mPartnerOffsets[i + 1]++;
+            if(j != i)
+               mPartnerOffsets[j + 1]++;
+         }
+
+   // Turn the counts into offsets, then file each pair under both its movers.  Filing advances each mover's offset to 
+   // where the next mover's list starts, so we shift them all back down afterwards.
+   for(S32 i = 1; i < mPartnerOffsets.size(); i++)
+      mPartnerOffsets[i] += mPartnerOffsets[i - 1];
+
+   mPartners.resize(mPartnerOffsets.last());
+
+   for(S32 i = 0; i < mPairs.size(); i += 2)
+   {
+      S32 a = mPairs[i];
+      S32 b = mPairs[i + 1];
+
+      mPartners[mPartnerOffsets[a]++] = b;
+      if(b != a)
+         mPartners[mPartnerOffsets[b]++] = a;
+   }
+
+   for(S32 i = mPartnerOffsets.size() - 1; i > 0; i--)
+      mPartnerOffsets[i] = mPartnerOffsets[i - 1];
+   mPartnerOffsets[0] = 0;
+
+   // Now build each mover's candidate list: everything else in its sweep, from the database, then the movers it overlaps
+   mCandidates.clear();
+
+   for(S32 i = 0; i < mMovers.size(); i++)
+   {
+      Mover &mover = mMovers[i];
+      mover.firstCandidate = mCandidates.size();
+
+      mDatabase->visitObjects(mover.collideTypes, mover.sweep, addStaticCandidate, &mCandidates);
+
+      for(S32 j = mPartnerOffsets[i]; j < mPartnerOffsets[i + 1]; j++)
+         mCandidates.push_back(mMovers[mPartners[j]].object);
+
+      mover.candidateCount = mCandidates.size() - mover.firstCandidate;
+   }
+}
+
+
+const CollisionBroadphase::Mover *CollisionBroadphase::findMover(const DatabaseObject *object) const
+{
+   MoverRef key;
+   key.object = const_cast<DatabaseObject *>(object);
+
+   const MoverRef *end = mMoverLookup.address() + mMoverLookup.size();
+   const MoverRef *found = std::lower_bound(mMoverLookup.address(), end, key);
+
+   if(found == end || found->object != object)
+      return NULL;
+
+   return &mMovers[found->index];
+}
+
+
+static bool rectContains(const Rect &outer, const Rect &inner)
+{
+   return outer.contains(inner.min) && outer.contains(inner.max);
+}
+
+
+bool CollisionBroadphase::findCandidates(const MoveObject *object, TestFunc testFunc, const Rect &queryRect,
+                                         Vector<DatabaseObject *> &fillVector) const
+{
+   if(!mDatabase)
+      return false;
+
+   const Mover *mover = findMover(object);
+
+   // If the object has gone somewhere we didn't plan for, or changed what it collides with, we don't know the answer
+   if(!mover || mover->collideTypes != testFunc || !rectContains(mover->sweep, queryRect))
+      return false;
+
+   Rect rect(queryRect);      // Rect::intersects() isn't const
+
+   mFound.clear();
+
+   for(S32 i = mover->firstCandidate; i < mover->firstCandidate + mover->candidateCount; i++)
+   {
+      DatabaseObject *candidate = mCandidates[i];
+
+      // Removed objects may have been deleted, so check before touching them; changed objects get checked below
+      if(mRemovedObjects.isVisited(candidate) || mChangedObjects.isVisited(candidate))
+         continue;
+
+      if(mover->types.test(candidate->getObjectTypeNumber()) && candidate->getExtent().intersects(rect))
+         mFound.push_back(candidate);
+   }
+
+   const Vector<DatabaseObject *> &changed = mChangedList.getResults();
+
+   for(S32 i = 0; i < changed.size(); i++)
+   {
+      DatabaseObject *candidate = changed[i];
+
+      if(!mChangedObjects.isVisited(candidate))      // Removed since it changed
+         continue;
+
+      if(mover->types.test(candidate->getObjectTypeNumber()) && candidate->getExtent().intersects(rect))
+         mFound.push_back(candidate);
+   }
+
+   // Collisions are checked in the order the database would have found things, and that order decides what gets hit
+   mDatabase->sortInSearchOrder(queryRect, mFound);
+
+   for(S32 i = 0; i < mFound.size(); i++)
+      fillVector.push_back(mFound[i]);
+
+   return true;
+}
+
+
+void CollisionBroadphase::addChangedObject(DatabaseObject *object)
+{
+   if(mChangedObjects.markVisited(object) && mChangedList.markVisited(object))
+      mChangedList.addResult(object);
+}
+
+
+// New objects could be anywhere, so every search will check them
+void CollisionBroadphase::onObjectAdded(DatabaseObject *object)
+{
+   mRemovedObjects.unmarkVisited(object);      // Removed then readded, or a new object at the same address
+   addChangedObject(object);
+}
+
+
+void CollisionBroadphase::onObjectRemoved(DatabaseObject *object)
+{
+   mChangedObjects.unmarkVisited(object);
+   mRemovedObjects.markVisited(object);
+}
+
+
+// Objects that stay inside their sweeps are still on the candidate lists of everything they could touch; anything else
+// will have to be checked by every search
+void CollisionBroadphase::onExtentChanged(DatabaseObject *object, const Rect &newExtent)
+{
+   if(mChangedObjects.isVisited(object))
+      return;
+
+   const Mover *mover = findMover(object);
+
+   if(mover && rectContains(mover->sweep, newExtent))
+      return;
+
+   addChangedObject(object);
+}
+
+
+// Everything we know about is gone; searches will go to the database until the next tick
+void CollisionBroadphase::onDatabaseCleared()
+{
+   mMovers.clear();
+   mMoverLookup.clear();
+   mCandidates.clear();
+   mChangedObjects.clear();
+   mRemovedObjects.clear();
+   mChangedList.clear();
+}
+
+
+S32 CollisionBroadphase::getMoverCount() const
+{
+   return mMovers.size();
+}
+
+
+S32 CollisionBroadphase::getChangedObjectCount() const
+{
+   const Vector<DatabaseObject *> &changed = mChangedList.getResults();
+   S32 count = 0;
+
+   for(S32 i = 0; i < changed.size(); i++)
+      if(mChangedObjects.isVisited(changed[i]))
+         count++;
+
+   return count;
+}
+
+
+};
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _COLLISION_BROADPHASE_H_
+#define _COLLISION_BROADPHASE_H_
+
+#include "gridDB.h"      // For TestFunc
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class MoveObject;
+
+// Per-tick broadphase for MoveObject::findFirstCollision().  At the start of a server tick, we sweep the extents of every
+// MoveObject by how far it could travel during the tick, then find once, for each of them, everything it could possibly
+// run into: other movers by sort-and-sweep, everything else with a single database search.  Collision searches made
+// during the tick are then answered from these lists instead of from the database.
+//
+// Answers are exactly what a database search would return at that moment, in the same order.  To keep it that way,
+// the database tells us when objects are added, removed, or have their extents changed during the tick; objects that
+// leave the area we planned for them are checked by every search, and a search outside the planned area of the object
+// doing it returns false so the caller can search the database instead.
+class CollisionBroadphase
+{
+private:
+   struct Mover
+   {
+      MoveObject *object;
+      Rect sweep;             // Everywhere we expect this object to be during the tick
+      TestFunc collideTypes;  // What the object collided with when we made its candidate list
+      TypeMask types;         // Same thing, in a form that's quick to check
+      S32 firstCandidate;     // Index of this mover's candidate list in mCandidates
+      S32 candidateCount;
+   };
+
+   struct MoverRef
+   {
+      DatabaseObject *object;
+      S32 index;              // Index in mMovers
+
+      bool operator<(const MoverRef &other) const { return object < other.object; }
+   };
+
+   GridDatabase *mDatabase;     // Database we're watching; NULL when no tick is in progress
+   bool mEnabled;
+
+   Vector<Mover> mMovers;                       // Sorted by left edge of sweep, for sort-and-sweep
+   Vector<MoverRef> mMoverLookup;               // Sorted by object, for finding an object's Mover
+   Vector<DatabaseObject *> mCandidates;        // Candidate lists of all movers, back to back
+   Vector<S32> mPairs;                          // Scratch space for overlapping mover pairs, two indices per pair
+   Vector<S32> mPartnerOffsets;                 // Where each mover's list of overlapping movers starts in mPartners
+   Vector<S32> mPartners;                       // Indices of overlapping movers, grouped by mover
+
+   // We only use the visited sets of these, as sets of objects that are quick to check and to remove things from
+   DatabaseQuery mChangedObjects;      // Added, or moved outside their sweep, during the tick -- checked by every search
+   DatabaseQuery mRemovedObjects;      // Removed during the tick -- never returned, and never dereferenced
+   DatabaseQuery mChangedList;         // Results list everything ever in mChangedObjects this tick, once each
+
+   mutable Vector<DatabaseObject *> mFound;     // Scratch space for findCandidates()
+
+   const Mover *findMover(const DatabaseObject *object) const;
+   static bool isLeftOf(const Mover &a, const Mover &b);
+
+   void collectMovers(F32 timeDelta);
+   void collectCandidates();
+
+   static bool addStaticCandidate(DatabaseObject *object, void *context);
+   void addChangedObject(DatabaseObject *object);
+
+public:
+   CollisionBroadphase();     // Constructor
+   virtual ~CollisionBroadphase();    // Destructor
+
+   static const F32 MinSweepSpeed;    // Ships can speed up to this much during their idle, so always leave room for it
+
+   void setEnabled(bool enabled);     // When disabled, beginTick() does nothing, and all searches go to the database
+   bool isEnabled() const;
+
+   void beginTick(GridDatabase *database, U32 timeDelta);
+   void endTick();
+   bool isActive() const;
+
+   // Fills fillVector with the objects of types testFunc accepts whose extents overlap queryRect, in the order a database
+   // search would find them.  Returns false, and fills nothing, if we can't answer the question -- in that case, ask the
+   // database.
+   bool findCandidates(const MoveObject *object, TestFunc testFunc, const Rect &queryRect, Vector<DatabaseObject *> &fillVector) const;
+
+   // Called by the database we're watching
+   void onObjectAdded(DatabaseObject *object);
+   void onObjectRemoved(DatabaseObject *object);
+   void onExtentChanged(DatabaseObject *object, const Rect &newExtent);
+   void onDatabaseCleared();
+
+   S32 getMoverCount() const;             // For testing
+   S32 getChangedObjectCount() const;
+};
+
+
+};
+
+#endif
@@ -1360,6 +1360,7 @@ ForceFieldProjector::~ForceFieldProjector()
 void ForceFieldProjector::initialize()
 {
    mNetFlags.set(Ghostable);
+   mNetFlags.set(SharesUpdates);
    mObjectTypeNumber = ForceFieldProjectorTypeNumber;
    onGeomChanged();     // Can't be placed on parent, as parent constructor must initalized first
 
@@ -1664,6 +1665,7 @@ ForceField::ForceField(S32 team, Point start, Point end)
    mFieldUp = true;
    mObjectTypeNumber = ForceFieldTypeNumber;
    mNetFlags.set(Ghostable);
+   mNetFlags.set(SharesUpdates);
 }
 
 // Destructor
@@ -1905,6 +1907,7 @@ void Turret::initialize()
 
    mWeaponFireType = WeaponTurret;
    mNetFlags.set(Ghostable);
+   mNetFlags.set(SharesUpdates);
 
    onGeomChanged();
 
@@ -9,6 +9,7 @@
 #include "playerInfo.h"          // For RobotPlayerInfo constructor
 #include "robot.h"
 #include "Zone.h"
+#include "stringUtils.h"
 
 //#include "../lua/luaprofiler-2.0.2/src/luaprofiler.h"      // For... the profiler!
 
@@ -17,6 +18,8 @@
 #endif
 
 #include <math.h>
+#include <map>
+#include <set>
 
 
 #define hypot _hypot    // Kill some warnings
@@ -31,11 +34,84 @@ struct Subscription {
 };
 
 
+// Subscribers to one event type, in the order they'll be called, indexed so we can find anyone without a search
+class SubscriptionList
+{
+private:
+   Vector<Subscription> mSubscriptions;
+   map<LuaScriptRunner *, S32> mIndex;       // Where each subscriber is in mSubscriptions
+
+public:
+   S32 size() const
+   {
+      return mSubscriptions.size();
+   }
+
+   const Subscription &operator[](S32 i) const
+   {
+      return mSubscriptions[i];
+   }
+
+   bool contains(LuaScriptRunner *subscriber) const
+   {
+      return mIndex.find(subscriber) != mIndex.end();
+   }
+
+   void add(const Subscription &subscription)
+   {
+      map<LuaScriptRunner *, S32>::iterator it = mIndex.find(subscription.subscriber);
+
+      if(it != mIndex.end())
+      {
+         mSubscriptions[it->second] = subscription;
+         return;
+      }
+
+      mIndex[subscription.subscriber] = mSubscriptions.size();
+      mSubscriptions.push_back(subscription);
+   }
+
+   void remove(LuaScriptRunner *subscriber)
+   {
+      map<LuaScriptRunner *, S32>::iterator it = mIndex.find(subscriber);
+
+      if(it == mIndex.end())
+         return;
+
+      // Fill the hole with the last subscriber, as erase_fast() would
+      S32 index = it->second;
+      mIndex.erase(it);
+
+      if(index != mSubscriptions.size() - 1)
+         mIndex[mSubscriptions.last().subscriber] = index;
+
+      mSubscriptions.erase_fast(index);
+   }
+
+   void clear()
+   {
+      mSubscriptions.clear();
+      mIndex.clear();
+   }
+};
+
+
 // Statics:
 bool EventManager::anyPending = false; 
-static Vector<Subscription>      subscriptions         [EventManager::EventTypes];
-static Vector<Subscription>      pendingSubscriptions  [EventManager::EventTypes];
-static Vector<LuaScriptRunner *> pendingUnsubscriptions[EventManager::EventTypes];
+static SubscriptionList          subscriptions         [EventManager::EventTypes];
+static SubscriptionList          pendingSubscriptions  [EventManager::EventTypes];
+static set<LuaScriptRunner *>    pendingUnsubscriptions[EventManager::EventTypes];
+
+// How often each event has been fired at scripts, and how long that took, in high precision timer units
+static U32 dispatchCount[EventManager::EventTypes];
+static S64 dispatchTime [EventManager::EventTypes];
+
+// While an event is being fired, its arguments are kept in a table in the registry, so we can hand them to each
+// subscriber without pushing them again.  Handlers can fire events of their own, so each level of nesting gets its own
+// MaxEventArgs slots.
+static const char *EventArgsKey = "EventArgs";
+static const S32 MaxEventArgs = 4;
+static S32 fireDepth = 0;
 
 bool EventManager::mConstructed = false;  // Prevent duplicate instantiation
 
@@ -128,7 +204,7 @@ void EventManager::subscribe(LuaScriptRunner *subscriber, EventType eventType, S
    s.subscriber = subscriber;
    s.context = context;
 
-   pendingSubscriptions[eventType].push_back(s);
+   pendingSubscriptions[eventType].add(s);
    anyPending = true;
 
    lua_pop(L, -1);    // Remove function from stack                                  -- <<empty stack>>
@@ -141,7 +217,7 @@ void EventManager::unsubscribe(LuaScriptRunner *subscriber, EventType eventType)
    {
       removeFromPendingSubscribeList(subscriber, eventType);
 
-      pendingUnsubscriptions[eventType].push_back(subscriber);
+      pendingUnsubscriptions[eventType].insert(subscriber);
       anyPending = true;
    }
 }
@@ -149,34 +225,19 @@ void EventManager::unsubscribe(LuaScriptRunner *subscriber, EventType eventType)
 
 void EventManager::removeFromPendingSubscribeList(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < pendingSubscriptions[eventType].size(); i++)
-      if(pendingSubscriptions[eventType][i].subscriber == subscriber)
-      {
-         pendingSubscriptions[eventType].erase_fast(i);
-         return;
-      }
+   pendingSubscriptions[eventType].remove(subscriber);
 }
 
 
 void EventManager::removeFromPendingUnsubscribeList(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < pendingUnsubscriptions[eventType].size(); i++)
-      if(pendingUnsubscriptions[eventType][i] == subscriber)
-      {
-         pendingUnsubscriptions[eventType].erase_fast(i);
-         return;
-      }
+   pendingUnsubscriptions[eventType].erase(subscriber);
 }
 
 
 void EventManager::removeFromSubscribedList(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-      if(subscriptions[eventType][i].subscriber == subscriber)
-      {
-         subscriptions[eventType].erase_fast(i);
-         return;
-      }
+   subscriptions[eventType].remove(subscriber);
 }
 
 
@@ -192,31 +253,19 @@ void EventManager::unsubscribeImmediate(LuaScriptRunner *subscriber, EventType e
 // Check if we're subscribed to an event
 bool EventManager::isSubscribed(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-      if(subscriptions[eventType][i].subscriber == subscriber)
-         return true;
-
-   return false;
+   return subscriptions[eventType].contains(subscriber);
 }
 
 
 bool EventManager::isPendingSubscribed(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < pendingSubscriptions[eventType].size(); i++)
-      if(pendingSubscriptions[eventType][i].subscriber == subscriber)
-         return true;
-
-   return false;
+   return pendingSubscriptions[eventType].contains(subscriber);
 }
 
 
 bool EventManager::isPendingUnsubscribed(LuaScriptRunner *subscriber, EventType eventType)
 {
-   for(S32 i = 0; i < pendingUnsubscriptions[eventType].size(); i++)
-      if(pendingUnsubscriptions[eventType][i] == subscriber)
-         return true;
-
-   return false;
+   return pendingUnsubscriptions[eventType].find(subscriber) != pendingUnsubscriptions[eventType].end();
 }
 
 
@@ -226,12 +275,12 @@ void EventManager::update()
    if(anyPending)
    {
       for(S32 i = 0; i < EventTypes; i++)
-         for(S32 j = 0; j < pendingUnsubscriptions[i].size(); j++)     // Unsubscribing first means less searching!
-            removeFromSubscribedList(pendingUnsubscriptions[i][j], (EventType) i);
+         for(set<LuaScriptRunner *>::iterator it = pendingUnsubscriptions[i].begin(); it != pendingUnsubscriptions[i].end(); it++)
+            removeFromSubscribedList(*it, (EventType) i);
 
       for(S32 i = 0; i < EventTypes; i++)
          for(S32 j = 0; j < pendingSubscriptions[i].size(); j++)     
-            subscriptions[i].push_back(pendingSubscriptions[i][j]);
+            subscriptions[i].add(pendingSubscriptions[i][j]);
 
       for(S32 i = 0; i < EventTypes; i++)
       {
@@ -254,8 +303,7 @@ void EventManager::fireEvent(EventType eventType)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+   fireToSubscribers(L, eventType, 0);
 }
 
 
@@ -272,11 +320,8 @@ void EventManager::fireEvent(EventType eventType, U32 deltaT)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      lua_pushinteger(L, deltaT);   // -- deltaT
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   lua_pushinteger(L, deltaT);   // -- deltaT
+   fireToSubscribers(L, eventType, 1);
 }
 
 
@@ -290,11 +335,8 @@ void EventManager::fireEvent(EventType eventType, CoreItem *core)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      core->push(L);                // -- core
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   core->push(L);                // -- core
+   fireToSubscribers(L, eventType, 1);
 }
 
 
@@ -308,11 +350,8 @@ void EventManager::fireEvent(EventType eventType, Ship *ship)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      ship->push(L);                // -- ship
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   ship->push(L);                // -- ship
+   fireToSubscribers(L, eventType, 1);
 }
 
 
@@ -326,22 +365,19 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, BfObject *damaging
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      ship->push(L);                // -- ship
+   ship->push(L);                // -- ship
 
-      if(damagingObject)
-         damagingObject->push(L);   // -- ship, damagingObject
-      else
-         lua_pushnil(L);
+   if(damagingObject)
+      damagingObject->push(L);   // -- ship, damagingObject
+   else
+      lua_pushnil(L);
 
-      if(shooter)
-         shooter->push(L);          // -- ship, damagingObject, shooter
-      else
-         lua_pushnil(L);
+   if(shooter)
+      shooter->push(L);          // -- ship, damagingObject, shooter
+   else
+      lua_pushnil(L);
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   fireToSubscribers(L, eventType, 3);
 }
 
 
@@ -356,22 +392,16 @@ void EventManager::fireEvent(LuaScriptRunner *sender, EventType eventType, const
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      if(sender == subscriptions[eventType][i].subscriber)    // Don't alert sender about own message!
-         continue;
-
-      lua_pushstring(L, message);   // -- message
+   lua_pushstring(L, message);   // -- message
 
-      if(playerInfo)
-         playerInfo->push(L);       // -- message, playerInfo
-      else
-         lua_pushnil(L);            
+   if(playerInfo)
+      playerInfo->push(L);       // -- message, playerInfo
+   else
+      lua_pushnil(L);            
 
-      lua_pushboolean(L, global);   // -- message, player, isGlobal
+   lua_pushboolean(L, global);   // -- message, player, isGlobal
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   fireToSubscribers(L, eventType, 3, sender);     // Don't alert sender about own message!
 }
 
 
@@ -385,14 +415,8 @@ void EventManager::fireEvent(LuaScriptRunner *player, EventType eventType, LuaPl
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      if(player == subscriptions[eventType][i].subscriber)    // Don't trouble player with own joinage or leavage!
-         continue;
-
-      playerInfo->push(L);          // -- playerInfo
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-   }
+   playerInfo->push(L);          // -- playerInfo
+   fireToSubscribers(L, eventType, 1, player);     // Don't trouble player with own joinage or leavage!
 }
 
 
@@ -406,25 +430,13 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, Zone *zone)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      try   
-      {
-         // Passing ship, zone, zoneType, zoneId
-         ship->push(L);                                     // -- ship
-         zone->push(L);                                     // -- ship, zone   
-         lua_pushinteger(L, zone->getObjectTypeNumber());   // -- ship, zone, zone->objTypeNumber
-         lua_pushinteger(L, zone->getUserAssignedId());     // -- ship, zone, zone->objTypeNumber, zone->id
+   // Passing ship, zone, zoneType, zoneId
+   ship->push(L);                                     // -- ship
+   zone->push(L);                                     // -- ship, zone   
+   lua_pushinteger(L, zone->getObjectTypeNumber());   // -- ship, zone, zone->objTypeNumber
+   lua_pushinteger(L, zone->getUserAssignedId());     // -- ship, zone, zone->objTypeNumber, zone->id
 
-         fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-      }
-      catch(LuaException &e)
-      {
-         handleEventFiringError(L, subscriptions[eventType][i], eventType, e.what());
-         clearStack(L);
-         return;
-      }
-   }
+   fireToSubscribers(L, eventType, 4);
 }
 
 
@@ -438,25 +450,13 @@ void EventManager::fireEvent(EventType eventType, MoveObject *object, Zone *zone
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-   {
-      try   
-      {
-         // Passing object, zone, zoneType, zoneId
-         object->push(L);                                   // -- object
-         zone->push(L);                                     // -- object, zone   
-         lua_pushinteger(L, zone->getObjectTypeNumber());   // -- object, zone, zone->objTypeNumber
-         lua_pushinteger(L, zone->getUserAssignedId());     // -- object, zone, zone->objTypeNumber, zone->id
+   // Passing object, zone, zoneType, zoneId
+   object->push(L);                                   // -- object
+   zone->push(L);                                     // -- object, zone   
+   lua_pushinteger(L, zone->getObjectTypeNumber());   // -- object, zone, zone->objTypeNumber
+   lua_pushinteger(L, zone->getUserAssignedId());     // -- object, zone, zone->objTypeNumber, zone->id
 
-         fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
-      }
-      catch(LuaException &e)
-      {
-         handleEventFiringError(L, subscriptions[eventType][i], eventType, e.what());
-         clearStack(L);
-         return;
-      }
-   }
+   fireToSubscribers(L, eventType, 4);
 }
 
 
@@ -470,18 +470,100 @@ void EventManager::fireEvent(EventType eventType, S32 score, S32 team, LuaPlayer
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
+   lua_pushinteger(L, score);   // -- score
+   lua_pushinteger(L, team);    // -- score, team
+
+   if(playerInfo)
+      playerInfo->push(L);      // -- score, team, playerInfo
+   else
+      lua_pushnil(L);
+
+   fireToSubscribers(L, eventType, 3);
+}
+
+
+// Pushes the table we keep event arguments in, creating it if this is a new lua_State
+static void pushEventArgsTable(lua_State *L)
+{
+   lua_getfield(L, LUA_REGISTRYINDEX, EventArgsKey);     // -- eventArgs
+
+   if(lua_istable(L, -1))
+      return;
+
+   lua_pop(L, 1);
+   lua_createtable(L, MaxEventArgs, 0);                  // -- eventArgs
+   lua_pushvalue(L, -1);                                 // -- eventArgs, eventArgs
+   lua_setfield(L, LUA_REGISTRYINDEX, EventArgsKey);     // -- eventArgs
+}
+
+
+// Calls the handler for eventType on each subscriber, passing the argCount values on the top of the stack.  Those get
+// pushed only once, by the caller; each subscriber gets copies of them.  The subscriber skip, if any, is left out.
+void EventManager::fireToSubscribers(lua_State *L, EventType eventType, S32 argCount, LuaScriptRunner *skip)
+{
+   TNLAssert(argCount <= MaxEventArgs, "Too many event args!");
+
+   S64 start = Platform::getHighPrecisionTimerValue();
+
+   S32 base = fireDepth * MaxEventArgs;
+   fireDepth++;
+
+   // Move the args into their slots
+   pushEventArgsTable(L);                             // -- <<args>>, eventArgs
+   lua_insert(L, -argCount - 1);                      // -- eventArgs, <<args>>
+
+   for(S32 i = argCount; i > 0; i--)
+      lua_rawseti(L, -i - 1, base + i);
+
+   lua_pop(L, 1);                                     // -- <<empty stack>>
+
+   const char *function = eventDefs[eventType].function;
+
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
-      lua_pushinteger(L, score);   // -- score
-      lua_pushinteger(L, team);    // -- score, team
+      Subscription subscription = subscriptions[eventType][i];    // A copy; a handler could change the list
+
+      if(subscription.subscriber == skip)
+         continue;
+
+      // Scripts that went over their CPU budget sit out a tick
+      if(eventType == TickEvent && subscription.subscriber->isSkippingTick())
+         continue;
+
+      try   
+      {
+         pushEventArgsTable(L);                       // -- eventArgs
 
-      if(playerInfo)
-         playerInfo->push(L);      // -- score, team, playerInfo
-      else
-         lua_pushnil(L);
+         for(S32 j = 1; j <= argCount; j++)
+            lua_rawgeti(L, -j, base + j);             // -- eventArgs, <<args>>
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+         lua_remove(L, -argCount - 1);                // -- <<args>>
+
+         fire(L, subscription.subscriber, function, subscription.context);
+      }
+      catch(LuaException &e)
+      {
+         handleEventFiringError(L, subscription, eventType, e.what());
+         break;
+      }
+   }
+
+   // Let go of the args, so we're not hanging on to anything after the event is over
+   pushEventArgsTable(L);                             // -- eventArgs
+
+   for(S32 i = 1; i <= argCount; i++)
+   {
+      lua_pushnil(L);
+      lua_rawseti(L, -2, base + i);
    }
+
+   lua_pop(L, 1);                                     // -- <<empty stack>>
+
+   fireDepth--;
+
+   // Time spent on any events the handlers fired is counted here too
+   dispatchCount[eventType]++;
+   dispatchTime[eventType] += Platform::getHighPrecisionTimerValue() - start;
 }
 
 
@@ -511,6 +593,32 @@ void EventManager::handleEventFiringError(lua_State *L, const Subscription &subs
 }
 
 
+// Adds a line for each event that has been fired at scripts since the stats were last reset
+void EventManager::getDispatchStats(Vector<string> &lines) const
+{
+   for(S32 i = 0; i < EventTypes; i++)
+   {
+      if(dispatchCount[i] == 0)
+         continue;
+
+      F64 ms = Platform::getHighPrecisionMilliseconds(dispatchTime[i]);
+
+      lines.push_back(string(eventDefs[i].name) + " events: " + itos(dispatchCount[i]) + " fired, " +
+                      ftos(F32(ms), 1) + " ms, " + ftos(F32(ms * 1000 / dispatchCount[i]), 1) + " us each");
+   }
+}
+
+
+void EventManager::resetDispatchStats()
+{
+   for(S32 i = 0; i < EventTypes; i++)
+   {
+      dispatchCount[i] = 0;
+      dispatchTime[i] = 0;
+   }
+}
+
+
 // If true, events will not fire!
 bool EventManager::suppressEvents(EventType eventType)
 {
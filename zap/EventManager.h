@@ -81,6 +81,7 @@ private:
    void removeFromPendingUnsubscribeList(LuaScriptRunner *subscriber, EventType eventType);
 
    void handleEventFiringError(lua_State *L, const Subscription &subscriber, EventType eventType, const char *errorMsg);
+   void fireToSubscribers(lua_State *L, EventType eventType, S32 argCount, LuaScriptRunner *skip = NULL);
    bool fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context);
       
    bool mIsPaused;
@@ -121,6 +122,10 @@ public:
    void fireEvent(EventType eventType, S32 score, S32 team, LuaPlayerInfo *playerInfo);
    void fireEvent(EventType eventType, MoveObject *object, Zone *zone); // ObjectEnteredZoneEvent, ObjectLeftZoneEvent
 
+   // How much firing each type of event has cost; see /luaprof
+   void getDispatchStats(Vector<string> &lines) const;
+   void resetDispatchStats();
+
    // Allow the pausing of event firing for debugging purposes
    void setPaused(bool isPaused);
    void togglePauseStatus();
@@ -47,6 +47,7 @@ enum ParamId {
    HOST_DESCRIPTION,
    MAX_PLAYERS_PARAM,
    HOST_ADDRESS,
+   BUILD_NAV_MESHES,
 
    LEVEL_LIST,
    USE_FILE,
@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelInfoCache.h"
+
+#include "stringUtils.h"
+
+#include "tnlLog.h"
+#include "tnlThread.h"
+
+#include <sstream>
+
+
+namespace Zap
+{
+
+// Statics
+const string LevelInfoCache::FileName = "levelinfo.cache";
+const S32 LevelInfoCache::MaxScanThreads = 8;
+const S32 LevelInfoCache::FilesPerThread = 16;
+
+static const char *CacheHeader = "# Bitfighter level info cache, v1 -- safe to delete";
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// One file to look at during a scan
+struct LevelInfoScanItem
+{
+   string fullFilename;
+   LevelInfoCache::Entry entry;
+   bool found;
+};
+
+
+// Reads the headers of the scan items that need it.  Items are handed out one at a time, so a thread that gets
+// stuck on a slow file doesn't hold up the rest.  Only plain file reading and string parsing happens here; nothing
+// that touches the string table or any other shared state.
+class LevelInfoScanThread : public TNL::Thread
+{
+private:
+   Vector<LevelInfoScanItem *> &mItems;
+   S32 &mNextItem;
+   Mutex &mLock;
+   Semaphore &mDone;
+
+public:
+   LevelInfoScanThread(Vector<LevelInfoScanItem *> &items, S32 &nextItem, Mutex &lock, Semaphore &done) :
+      mItems(items), mNextItem(nextItem), mLock(lock), mDone(done)
+   {
+      // Do nothing
+   }
+
+   U32 run()
+   {
+      while(true)
+      {
+         mLock.lock();
+         S32 index = mNextItem < mItems.size() ? mNextItem++ : -1;
+         mLock.unlock();
+
+         if(index == -1)
+            break;
+
+         LevelInfoScanItem *item = mItems[index];
+         item->found = LevelSource::getLevelInfoHeaderFromFile(item->fullFilename, item->entry.header);
+      }
+
+      mDone.increment();
+      return 0;
+   }
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelInfoCache::LevelInfoCache()
+{
+   mChanged = false;
+}
+
+
+// Destructor
+LevelInfoCache::~LevelInfoCache()
+{
+   // Do nothing
+}
+
+
+// Strings we write can't have tabs or newlines in them; level names and script names never do, since they were split
+// on whitespace, but paths could
+static bool isSafeToWrite(const string &str)
+{
+   return str.find_first_of("\t\r\n") == string::npos;
+}
+
+
+// Lines are: path, modified time, size, game type, min players, max players, script, level name -- separated by tabs
+bool LevelInfoCache::load(const string &cacheFile)
+{
+   mEntries.clear();
+   mChanged = false;
+
+   string contents = readFile(cacheFile);
+
+   if(contents.compare(0, strlen(CacheHeader), CacheHeader) != 0)
+   {
+      if(contents != "")
+         logprintf(LogConsumer::LogWarning, "Ignoring level info cache %s; it's from a different version", cacheFile.c_str());
+      return false;
+   }
+
+   istringstream lines(contents);
+   string line;
+
+   getline(lines, line);      // Skip header
+
+   while(getline(lines, line))
+   {
+      Vector<string> fields;
+      size_t start = 0;
+
+      while(true)
+      {
+         size_t tab = line.find('\t', start);
+         fields.push_back(line.substr(start, tab == string::npos ? string::npos : tab - start));
+
+         if(tab == string::npos)
+            break;
+
+         start = tab + 1;
+      }
+
+      if(fields.size() != 8)     // Damaged somehow; we'll just read that file again
+         continue;
+
+      Entry entry;
+
+      istringstream(fields[1]) >> entry.modifiedTime;
+      istringstream(fields[2]) >> entry.size;
+      entry.header.gameTypeName   = fields[3];
+      entry.header.minRecPlayers  = atoi(fields[4].c_str());
+      entry.header.maxRecPlayers  = atoi(fields[5].c_str());
+      entry.header.scriptFileName = fields[6];
+      entry.header.levelName      = fields[7];
+
+      mEntries[fields[0]] = entry;
+   }
+
+   return mEntries.size() > 0;
+}
+
+
+bool LevelInfoCache::save(const string &cacheFile)
+{
+   if(!mChanged)
+      return true;
+
+   ostringstream out;
+   out << CacheHeader << "\n";
+
+   for(map<string, Entry>::const_iterator it = mEntries.begin(); it != mEntries.end(); it++)
+   {
+      const Entry &entry = it->second;
+
+      if(!isSafeToWrite(it->first) || !isSafeToWrite(entry.header.gameTypeName) ||
+         !isSafeToWrite(entry.header.scriptFileName) || !isSafeToWrite(entry.header.levelName))
+         continue;
+
+      out << it->first                    << "\t"
+          << entry.modifiedTime           << "\t"
+          << entry.size                   << "\t"
+          << entry.header.gameTypeName    << "\t"
+          << entry.header.minRecPlayers   << "\t"
+          << entry.header.maxRecPlayers   << "\t"
+          << entry.header.scriptFileName  << "\t"
+          << entry.header.levelName       << "\n";
+   }
+
+   // Not being able to write here (a read-only levels folder, say) only costs us time on the next startup
+   if(!writeFile(cacheFile, out.str()))
+   {
+      logprintf(LogConsumer::LogWarning, "Could not write level info cache %s", cacheFile.c_str());
+      return false;
+   }
+
+   mChanged = false;
+   return true;
+}
+
+
+S32 LevelInfoCache::getEntryCount() const
+{
+   return (S32)mEntries.size();
+}
+
+
+const LevelInfoCache::Entry *LevelInfoCache::findEntry(const string &fullFilename, S64 modifiedTime, S64 size) const
+{
+   map<string, Entry>::const_iterator it = mEntries.find(fullFilename);
+
+   if(it == mEntries.end() || it->second.modifiedTime != modifiedTime || it->second.size != size)
+      return NULL;
+
+   return &it->second;
+}
+
+
+void LevelInfoCache::setEntry(const string &fullFilename, const Entry &entry)
+{
+   mEntries[fullFilename] = entry;
+   mChanged = true;
+}
+
+
+void LevelInfoCache::scan(const Vector<string> &fullFilenames, Vector<LevelInfoHeader> &headers, Vector<bool> &found)
+{
+   Vector<LevelInfoScanItem> items;
+   items.resize(fullFilenames.size());
+
+   Vector<LevelInfoScanItem *> toRead;
+
+   // Sort out what we already know about; a stat is much cheaper than reading the file
+   for(S32 i = 0; i < items.size(); i++)
+   {
+      LevelInfoScanItem &item = items[i];
+
+      item.fullFilename = fullFilenames[i];
+      item.found = false;
+
+      if(item.fullFilename == "" || !getFileStats(item.fullFilename, item.entry.modifiedTime, item.entry.size))
+         continue;
+
+      const Entry *entry = findEntry(item.fullFilename, item.entry.modifiedTime, item.entry.size);
+
+      if(entry)
+      {
+         item.entry.header = entry->header;
+         item.found = true;
+      }
+      else
+         toRead.push_back(&item);
+   }
+
+   // Read the rest in parallel
+   S32 threadCount = min(MaxScanThreads, (toRead.size() + FilesPerThread - 1) / FilesPerThread);
+
+   if(threadCount > 0)
+   {
+      S32 nextItem = 0;
+      Mutex lock;
+      Semaphore done(0, threadCount);
+
+      Vector<LevelInfoScanThread *> threads;
+
+      for(S32 i = 0; i < threadCount; i++)
+      {
+         LevelInfoScanThread *thread = new LevelInfoScanThread(toRead, nextItem, lock, done);
+
+         if(thread->start())
+            threads.push_back(thread);
+         else
+            delete thread;
+      }
+
+      // If we couldn't get any threads going, do the work ourselves
+      if(threads.size() == 0)
+      {
+         LevelInfoScanThread thread(toRead, nextItem, lock, done);
+         thread.run();
+         done.wait();
+      }
+
+      for(S32 i = 0; i < threads.size(); i++)
+         done.wait();
+
+      threads.deleteAndClear();
+
+      logprintf(LogConsumer::ServerFilter, "Read %d level files with %d threads; %d more came from the level info cache",
+                toRead.size(), max(threads.size(), 1), items.size() - toRead.size());
+   }
+
+   // Rebuild the cache from what we found, which drops any levels that have gone away
+   bool changed = mChanged || toRead.size() > 0;
+   size_t oldEntryCount = mEntries.size();
+
+   mEntries.clear();
+   headers.resize(items.size());
+   found.resize(items.size());
+
+   for(S32 i = 0; i < items.size(); i++)
+   {
+      found[i] = items[i].found;
+
+      if(items[i].found)
+      {
+         headers[i] = items[i].entry.header;
+         mEntries[items[i].fullFilename] = items[i].entry;
+      }
+   }
+
+   mChanged = changed || mEntries.size() != oldEntryCount;
+}
+
+
+}
@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_INFO_CACHE_H_
+#define _LEVEL_INFO_CACHE_H_
+
+#include "LevelSource.h"      // For LevelInfoHeader
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+#include <map>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Remembers what we read from the top of each level file, so a server with a lot of levels doesn't have to open every
+// one of them every time it starts.  Entries are keyed on the file's full path, and are only used if the file's
+// modified time and size haven't changed since.
+class LevelInfoCache
+{
+public:
+   struct Entry
+   {
+      S64 modifiedTime;
+      S64 size;
+      LevelInfoHeader header;
+   };
+
+private:
+   map<string, Entry> mEntries;
+   bool mChanged;                // True if there's anything here that isn't on disk
+
+public:
+   static const string FileName;       // Lives in the levels folder
+   static const S32 MaxScanThreads;    // Most worker threads we'll use reading level files
+   static const S32 FilesPerThread;    // Don't bother with another thread unless it will have at least this many files
+
+   LevelInfoCache();             // Constructor
+   virtual ~LevelInfoCache();    // Destructor
+
+   bool load(const string &cacheFile);    // Returns false if there was nothing usable in the file
+   bool save(const string &cacheFile);    // Only writes if something has changed; returns false on error
+
+   S32 getEntryCount() const;
+
+   // Returns NULL unless we have an entry for the file, and it's still current
+   const Entry *findEntry(const string &fullFilename, S64 modifiedTime, S64 size) const;
+   void setEntry(const string &fullFilename, const Entry &entry);
+
+   // Gets headers for all the files, from the cache where possible, and by reading the rest in parallel.  found[i] will
+   // be false if fullFilenames[i] couldn't be read.  Afterwards the cache holds exactly the files that were found.
+   void scan(const Vector<string> &fullFilenames, Vector<LevelInfoHeader> &headers, Vector<bool> &found);
+};
+
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelPreloader.h"
+
+#include "BotNavMeshZone.h"
+#include "game.h"             // For Game::md5
+#include "stringUtils.h"
+
+#include <algorithm>     // For swap
+
+
+namespace Zap
+{
+
+// Does the reading for a LevelPreloader.  Only file I/O and hashing happens here.
+class LevelPreloadThread : public Thread
+{
+private:
+   LevelPreloader::Level &mLevel;
+   Semaphore &mDone;
+
+public:
+   LevelPreloadThread(LevelPreloader::Level &level, Semaphore &done) : mLevel(level), mDone(done)
+   {
+      // Do nothing
+   }
+
+   U32 run()
+   {
+      // Hash the file as it is on disk, byte order mark and all, so we come up with the same hash LevelSource would
+      mLevel.contents = readFileBytes(mLevel.fullFilename);
+      mLevel.hash = Game::md5.getHashFromString(mLevel.contents);
+      removeByteOrderMark(mLevel.contents);
+
+      if(mLevel.contents != "")
+         BotNavMeshZone::loadBotMeshZoneCacheData(BotNavMeshZone::getCacheFileName(mLevel.navMeshCacheDir, mLevel.hash),
+                                                  mLevel.navMeshData);
+      else
+         mLevel.hash = "";
+
+      mDone.increment();
+      return 0;
+   }
+};
+
+
+// Triangulates a nav mesh for a LevelPreloader.  Only touches the geometry it's given.
+class NavMeshTriangulateThread : public Thread
+{
+private:
+   BotNavMeshGeometry &mGeometry;
+   bool &mTriangulated;
+   Semaphore &mDone;
+
+public:
+   NavMeshTriangulateThread(BotNavMeshGeometry &geometry, bool &triangulated, Semaphore &done) :
+      mGeometry(geometry), mTriangulated(triangulated), mDone(done)
+   {
+      // Do nothing
+   }
+
+   U32 run()
+   {
+      mTriangulated = BotNavMeshZone::triangulateBotMeshZones(mGeometry);
+
+      mDone.increment();
+      return 0;
+   }
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelPreloader::LevelPreloader() : mDone(0, 1)
+{
+   mLevelStarted = false;
+   mNavMesh = NULL;
+   mNavMeshTriangulated = false;
+   mThread = NULL;
+}
+
+
+// Destructor
+LevelPreloader::~LevelPreloader()
+{
+   finish();      // The worker is using mLevel or mNavMesh; we can't go anywhere until it's done
+   delete mNavMesh;
+}
+
+
+void LevelPreloader::finish()
+{
+   if(!mThread)
+      return;
+
+   mDone.wait();
+
+   delete mThread;
+   mThread = NULL;
+}
+
+
+void LevelPreloader::start(S32 levelIndex, const string &levelFileName, const string &fullFilename, const string &navMeshCacheDir)
+{
+   finish();
+
+   mLevel = Level();
+   mLevel.levelIndex      = levelIndex;
+   mLevel.levelFileName   = levelFileName;
+   mLevel.fullFilename    = fullFilename;
+   mLevel.navMeshCacheDir = navMeshCacheDir;
+   mLevelStarted = true;
+
+   mThread = new LevelPreloadThread(mLevel, mDone);
+
+   // If we can't get a thread, do the work now; it's no worse than not preloading at all
+   if(!mThread->start())
+      mThread->run();
+}
+
+
+void LevelPreloader::cancel()
+{
+   finish();
+   mLevel = Level();
+   mLevelStarted = false;
+}
+
+
+bool LevelPreloader::isStarted() const
+{
+   return mLevelStarted;
+}
+
+
+bool LevelPreloader::take(S32 levelIndex, const string &levelFileName, Level &level)
+{
+   if(!mLevelStarted)
+      return false;
+
+   finish();
+   mLevelStarted = false;
+
+   bool found = mLevel.levelIndex == levelIndex && mLevel.levelFileName == levelFileName && mLevel.contents != "";
+
+   if(found)
+      swap(level, mLevel);    // Level files can be big; no need to copy them
+
+   mLevel = Level();
+
+   return found;
+}
+
+
+void LevelPreloader::startNavMesh(BotNavMeshGeometry *geometry)
+{
+   finish();
+
+   delete mNavMesh;
+   mNavMesh = geometry;
+   mNavMeshTriangulated = false;
+
+   mThread = new NavMeshTriangulateThread(*mNavMesh, mNavMeshTriangulated, mDone);
+
+   if(!mThread->start())
+      mThread->run();
+}
+
+
+BotNavMeshGeometry *LevelPreloader::takeNavMesh(bool &triangulated)
+{
+   if(!mNavMesh)
+      return NULL;
+
+   finish();
+
+   BotNavMeshGeometry *geometry = mNavMesh;
+   triangulated = mNavMeshTriangulated;
+
+   mNavMesh = NULL;
+
+   return geometry;
+}
+
+
+}
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_PRELOADER_H_
+#define _LEVEL_PRELOADER_H_
+
+#include "tnlTypes.h"
+#include "tnlThread.h"
+
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+struct BotNavMeshGeometry;
+
+// Reads the next level's file, works out its hash, and picks up its nav mesh from the cache, on a worker thread, so the
+// server can do all that while the scoreboard is showing instead of when it switches levels.  Turning the level into
+// objects still happens on the main thread; creating objects and string table entries isn't safe anywhere else.
+//
+// When a level isn't in the nav mesh cache, the same worker does the slow part of building its nav mesh, once the level
+// is loaded and we know where its walls are.
+class LevelPreloader
+{
+public:
+   struct Level
+   {
+      S32 levelIndex;
+      string levelFileName;      // As the LevelSource knows it, for making sure we're still talking about the same level
+      string fullFilename;
+      string navMeshCacheDir;
+
+      // Filled in by the worker
+      string contents;
+      string hash;
+      string navMeshData;        // Contents of the level's nav mesh cache file, if it had one
+   };
+
+private:
+   Level mLevel;
+   bool mLevelStarted;              // True if we've started a preload that hasn't been taken
+
+   BotNavMeshGeometry *mNavMesh;    // Nav mesh being triangulated, or waiting to be taken; NULL if none
+   bool mNavMeshTriangulated;
+
+   Thread *mThread;                 // NULL unless the worker is running, or finished and not yet collected
+   Semaphore mDone;
+
+   void finish();                   // Waits for the worker, if there is one
+
+public:
+   LevelPreloader();                // Constructor
+   virtual ~LevelPreloader();       // Destructor
+
+   // Starts reading the level in the background; any earlier preload is thrown away
+   void start(S32 levelIndex, const string &levelFileName, const string &fullFilename, const string &navMeshCacheDir);
+   void cancel();
+
+   bool isStarted() const;
+
+   // If we preloaded the specified level, hands it over, waiting for the worker to finish if need be, and returns true.
+   // Returns false if we preloaded something else, or nothing at all.  Either way, the preloader is empty afterwards.
+   bool take(S32 levelIndex, const string &levelFileName, Level &level);
+
+   // Triangulates the space around geometry's walls in the background; takes ownership of geometry
+   void startNavMesh(BotNavMeshGeometry *geometry);
+
+   // Hands back the geometry given to startNavMesh(), waiting for the worker to finish with it if need be; NULL if there
+   // isn't any.  triangulated is false if the worker couldn't make anything of it.
+   BotNavMeshGeometry *takeNavMesh(bool &triangulated);
+};
+
+
+}
+
+#endif
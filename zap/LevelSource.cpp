@@ -8,6 +8,7 @@
 #include "config.h"           // For FolderManager
 #include "gameType.h"
 #include "GameSettings.h"
+#include "LevelInfoCache.h"
 
 #include "md5wrapper.h"
 #include "stringUtils.h"
@@ -78,6 +79,45 @@ void LevelInfo::ensureLevelInfoHasValidName()
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelInfoHeader::LevelInfoHeader()
+{
+   minRecPlayers = 0;
+   maxRecPlayers = 0;
+}
+
+
+// Fills in levelInfo with whatever we found in the file
+void LevelInfoHeader::populateLevelInfo(LevelInfo &levelInfo) const
+{
+   if(gameTypeName != "")
+   {
+      // validateGameType() will return a valid GameType string -- either what's passed in, or the default if something bogus was specified
+      TNL::Object *theObject = TNL::Object::create(GameType::validateGameType(gameTypeName.c_str()));
+
+      GameType *gt = dynamic_cast<GameType *>(theObject); 
+      if(gt)
+         levelInfo.mLevelType = gt->getGameTypeId();
+
+      delete theObject;
+   }
+
+   if(levelName != "")
+      levelInfo.mLevelName = levelName;
+
+   if(scriptFileName != "")
+      levelInfo.mScriptFileName = scriptFileName;
+
+   levelInfo.minRecPlayers = minRecPlayers;
+   levelInfo.maxRecPlayers = maxRecPlayers;
+
+   levelInfo.ensureLevelInfoHasValidName();
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -114,8 +154,16 @@ LevelInfo LevelSource::getLevelInfo(S32 index)
 // Parse through the chunk of data passed in and find parameters to populate levelInfo with
 // This is only used on the server to provide quick level information without having to load the level
 // (like with playlists or menus)
-// Warning: Mungs chunk!
 void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &levelInfo)
+{
+   LevelInfoHeader header;
+   getLevelInfoHeaderFromCodeChunk(chunk, size, header);
+   header.populateLevelInfo(levelInfo);
+}
+
+
+// Does the actual parsing for getLevelInfoFromCodeChunk(); only touches header, so is safe to call from any thread
+void LevelSource::getLevelInfoHeaderFromCodeChunk(const char *chunk, S32 size, LevelInfoHeader &header)
 {
    S32 cur = 0;
    S32 startingCur = 0;
@@ -132,24 +180,12 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
       {
          if(cur - startingCur > 5)
          {
-            char c = chunk[cur];
-            chunk[cur] = 0;
-            Vector<string> list = parseString(&chunk[startingCur]);
-            chunk[cur] = c;
+            Vector<string> list = parseString(string(&chunk[startingCur], cur - startingCur));
 
             if(list.size() >= 1 && list[0].find("GameType") != string::npos)
             {
-               // validateGameType() will return a valid GameType string -- either what's passed in, or the default if something bogus was specified
-               TNL::Object *theObject = TNL::Object::create(GameType::validateGameType(list[0].c_str()));
-
-               GameType *gt = dynamic_cast<GameType *>(theObject); 
-               if(gt)
-               {
-                  levelInfo.mLevelType = gt->getGameTypeId();
-                  foundGameType = true;
-               }
-
-               delete theObject;
+               header.gameTypeName = list[0];
+               foundGameType = true;
             }
             else if(list.size() >= 2 && list[0] == "LevelName")
             {
@@ -159,23 +195,23 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
                for(S32 i = 2; i < list.size(); i++)   
                   levelName += " " + list[i];
 
-               levelInfo.mLevelName = levelName;
+               header.levelName = levelName;
 
                foundLevelName = true;
             }
             else if(list.size() >= 2 && list[0] == "MinPlayers")
             {
-               levelInfo.minRecPlayers = atoi(list[1].c_str());
+               header.minRecPlayers = atoi(list[1].c_str());
                foundMinPlayers = true;
             }
             else if(list.size() >= 2 && list[0] == "MaxPlayers")
             {
-               levelInfo.maxRecPlayers = atoi(list[1].c_str());
+               header.maxRecPlayers = atoi(list[1].c_str());
                foundMaxPlayers = true;
             }
             else if(list.size() >= 2 && list[0] == "Script")
             {
-               levelInfo.mScriptFileName = list[1];
+               header.scriptFileName = list[1];
                foundScriptFileName = true;
             }
          }
@@ -183,8 +219,24 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
       }
       cur++;
    }
+}
 
-   levelInfo.ensureLevelInfoHasValidName();
+
+// Reads the first 4kb of the file, which should hold all the parameters we're after -- returns false if the file
+// can't be opened.  Safe to call from any thread.
+bool LevelSource::getLevelInfoHeaderFromFile(const string &fullFilename, LevelInfoHeader &header)
+{
+   FILE *f = fopen(fullFilename.c_str(), "rb");
+   if(!f)
+      return false;
+
+   char data[1024 * 4];  // 4 kb should be enough to fit all parameters at the beginning of level; we don't need to read everything
+   S32 size = (S32)fread(data, 1, sizeof(data), f);
+   fclose(f);
+
+   getLevelInfoHeaderFromCodeChunk(data, size, header);
+
+   return true;
 }
 
 
@@ -218,6 +270,12 @@ string LevelSource::getLevelName(S32 index)
 }
 
 
+string LevelSource::findLevelFile(S32 index) const
+{
+   return "";
+}
+
+
 string LevelSource::getLevelFileName(S32 index)
 {
    if(index < 0 || index >= mLevelInfos.size())
@@ -274,6 +332,14 @@ bool LevelSource::loadLevels(FolderManager *folderManager)
 }
 
 
+// Populate all our levelInfos in one go, removing any that can't be read.  Returns false if this source doesn't
+// support that, in which case they'll need to be populated one at a time with populateLevelInfoFromSource().
+bool LevelSource::preloadLevelInfos(FolderManager *folderManager)
+{
+   return false;
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -319,7 +385,7 @@ string MultiLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObje
 
    LevelInfo *levelInfo = &mLevelInfos[index];
 
-   string filename = FolderManager::findLevelFile(levelInfo->folder, levelInfo->filename);
+   string filename = findLevelFile(index);
 
    if(filename == "")
    {
@@ -337,6 +403,12 @@ string MultiLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObje
 }
 
 
+string MultiLevelSource::findLevelFile(S32 index) const
+{
+   return FolderManager::findLevelFile(mLevelInfos[index].folder, mLevelInfos[index].filename);
+}
+
+
 // Returns a textual level descriptor good for logging and error messages and such
 string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 {
@@ -348,17 +420,11 @@ string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 // Reads 4kb of file and uses what it finds there to populate the levelInfo
 bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo)
 {
-   FILE *f = fopen(fullFilename.c_str(), "rb");
-   if(f)
-   {
-      char data[1024 * 4];  // 4 kb should be enough to fit all parameters at the beginning of level; we don't need to read everything
-      S32 size = (S32)fread(data, 1, sizeof(data), f);
-      fclose(f);
-
-       getLevelInfoFromCodeChunk(data, size, levelInfo);     // Fills levelInfo with data from file
-
-      levelInfo.ensureLevelInfoHasValidName();
+   LevelInfoHeader header;
 
+   if(getLevelInfoHeaderFromFile(fullFilename, header))
+   {
+      header.populateLevelInfo(levelInfo);     // Fills levelInfo with data from file
       return true;
    }
    else
@@ -370,6 +436,48 @@ bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, L
 }
 
 
+// Reads the info for every level at once.  Anything that hasn't changed since the last time comes from the level info
+// cache in the levels folder; the rest is read by a handful of worker threads.
+bool MultiLevelSource::preloadLevelInfos(FolderManager *folderManager)
+{
+   Vector<string> fullFilenames;
+   fullFilenames.resize(mLevelInfos.size());
+
+   for(S32 i = 0; i < mLevelInfos.size(); i++)
+      fullFilenames[i] = folderManager->findLevelFile(mLevelInfos[i].filename);
+
+   LevelInfoCache cache;
+   string cacheFile = joindir(folderManager->levelDir, LevelInfoCache::FileName);
+
+   cache.load(cacheFile);
+
+   Vector<LevelInfoHeader> headers;
+   Vector<bool> found;
+   cache.scan(fullFilenames, headers, found);
+
+   cache.save(cacheFile);
+
+   // Now the part that has to happen here on the main thread
+   S32 index = 0;
+   for(S32 i = 0; i < fullFilenames.size(); i++)
+   {
+      if(found[i])
+      {
+         headers[i].populateLevelInfo(mLevelInfos[index]);
+         index++;
+      }
+      else
+      {
+         logprintf(LogConsumer::LogWarning, "Could not load level %s [%s]... Skipping...",
+                                             mLevelInfos[index].filename.c_str(), fullFilenames[i].c_str());
+         mLevelInfos.erase(index);
+      }
+   }
+
+   return true;
+}
+
+
 bool MultiLevelSource::isEmptyLevelDirOk() const
 {
    return false;
@@ -414,27 +522,10 @@ FileListLevelSource::~FileListLevelSource()
 
 
 // Load specified level, put results in gameObjectDatabase.  Return md5 hash of level.
-string FileListLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObjectDatabase)
+// Playlist levels are all found relative to the levels folder
+string FileListLevelSource::findLevelFile(S32 index) const
 {
-   TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
-
-   LevelInfo *levelInfo = &mLevelInfos[index];
-
-   string filename = FolderManager::findLevelFile(GameSettings::getFolderManager()->levelDir, levelInfo->filename);
-
-   if(filename == "")
-   {
-      logprintf("Unable to find level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return "";
-   }
-
-   if(game->loadLevelFromFile(filename, gameObjectDatabase))
-      return Game::md5.getHashFromFile(filename);   
-   else
-   {
-      logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return "";
-   }
+   return FolderManager::findLevelFile(GameSettings::getFolderManager()->levelDir, mLevelInfos[index].filename);
 }
 
 
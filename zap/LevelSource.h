@@ -51,6 +51,23 @@ public:
 };
 
 
+// The parameters at the top of a level file, as plain text.  Reading these needs nothing but the file, so it can be
+// done off the main thread; turning them into a LevelInfo (which touches the string table and game type registry)
+// can't.
+struct LevelInfoHeader
+{
+   string gameTypeName;             // Empty if the file doesn't say
+   string levelName;
+   string scriptFileName;
+   S32 minRecPlayers;
+   S32 maxRecPlayers;
+
+   LevelInfoHeader();      // Constructor
+
+   void populateLevelInfo(LevelInfo &levelInfo) const;     // Main thread only
+};
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -86,7 +103,9 @@ public:
 
    virtual bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo) = 0;
    virtual string loadLevel(S32 index, Game *game, GridDatabase *gameObjDatabase) = 0;
+   virtual string findLevelFile(S32 index) const;     // Full path to the level's file, or "" if it doesn't have one
    virtual bool loadLevels(FolderManager *folderManager);
+   virtual bool preloadLevelInfos(FolderManager *folderManager);
    virtual string getLevelFileDescriptor(S32 index) const = 0;
    virtual bool isEmptyLevelDirOk() const = 0;
 
@@ -94,6 +113,8 @@ public:
 
    static Vector<string> findAllLevelFilesInFolder(const string &levelDir);
    static void getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &levelInfo);     // Populates levelInfo
+   static void getLevelInfoHeaderFromCodeChunk(const char *chunk, S32 size, LevelInfoHeader &header);
+   static bool getLevelInfoHeaderFromFile(const string &fullFilename, LevelInfoHeader &header);
 };
 
 
@@ -111,10 +132,12 @@ public:
 
    bool loadLevels(FolderManager *folderManager);
    string loadLevel(S32 index, Game *game, GridDatabase *gameObjDatabase);
+   string findLevelFile(S32 index) const;
    string getLevelFileDescriptor(S32 index) const;
    bool isEmptyLevelDirOk() const;
 
    bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo);
+   bool preloadLevelInfos(FolderManager *folderManager);
 };
 
 
@@ -148,7 +171,7 @@ public:
    FileListLevelSource(const Vector<string> &levelList, const string &folder);     // Constructor
    virtual ~FileListLevelSource();                                                                                                                // Destructor
 
-   string loadLevel(S32 index, Game *game, GridDatabase *gameObjDatabase);
+   string findLevelFile(S32 index) const;
 
    static Vector<string> findAllFilesInPlaylist(const string &fileName, const string &levelDir);
 };
@@ -21,6 +21,7 @@
 #include "Console.h"           // For gConsole
 
 #include "stringUtils.h"
+#include "version.h"           // For BUILD_VERSION
 
 #include <clipper.hpp>
 
@@ -41,16 +42,34 @@ namespace Zap
 // Declare and Initialize statics:
 lua_State *LuaScriptRunner::L = NULL;
 string LuaScriptRunner::mScriptingDir;
+string LuaScriptRunner::mBytecodeCacheDir;
 
-deque<string> LuaScriptRunner::mCachedScripts;
+const S32 LuaScriptRunner::HookInterval = 1000;
+
+Vector<LuaScriptRunner *> LuaScriptRunner::mCallStack;
+S64 LuaScriptRunner::mSliceStart = 0;
+S64 LuaScriptRunner::mCallStart = 0;
+U32 LuaScriptRunner::mCurrentTick = 0;
+F32 LuaScriptRunner::mSoftBudget = 0;
+F32 LuaScriptRunner::mHardBudget = 0;
+bool LuaScriptRunner::mProfiling = false;
+
+set<string> LuaScriptRunner::mCachedScripts;
+
+static const char *TickObjectsKey = "TickObjects";   // Registry key for the objects iterateObjects() has handed out this tick
 
 void LuaScriptRunner::clearScriptCache()
 {
-	while(mCachedScripts.size() != 0)
-	{
-		deleteScript(mCachedScripts.front().c_str());
-		mCachedScripts.pop_front();
-	}
+   for(set<string>::iterator it = mCachedScripts.begin(); it != mCachedScripts.end(); it++)
+      deleteScript(it->c_str());
+
+   mCachedScripts.clear();
+}
+
+
+void LuaScriptRunner::setBytecodeCacheDir(const string &dir)
+{
+   mBytecodeCacheDir = dir;
 }
 
 
@@ -70,6 +89,14 @@ LuaScriptRunner::LuaScriptRunner()
    mScriptId = "script" + itos(mNextScriptId++);
    mScriptType = ScriptTypeInvalid;
 
+   mTick = mCurrentTick;
+   mTickTime = 0;
+   mSkipTick = U32_MAX;
+   mSkippedTimerTime = 0;
+   mLastBudgetWarning = 0;
+   mHardBudgetExceeded = false;
+   resetProfile();
+
    LUAW_CONSTRUCTOR_INITIALIZATIONS;
 }
 
@@ -89,6 +116,11 @@ LuaScriptRunner::~LuaScriptRunner()
    // And delete the script's environment table from the Lua instance
    deleteScript(getScriptId());
 
+   // If we're being deleted from inside one of our own calls, there's no one left to charge the time to
+   for(S32 i = 0; i < mCallStack.size(); i++)
+      if(mCallStack[i] == this)
+         mCallStack[i] = NULL;
+
    LUAW_DESTRUCTOR_CLEANUP;
 }
 
@@ -217,8 +249,6 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
    if(mScriptName == "")
       return true;
 
-   static const S32 MAX_CACHE_SIZE = 16;
-
    // On a dedicated server, we'll always cache our scripts; on a regular server, we'll cache script except when the user is testing
    // from the editor.  In that case, we'll want to see script changes take place immediately, and we're willing to pay a small
    // performance penalty on level load to get that.
@@ -233,30 +263,12 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
          loadCompileScript(mScriptName.c_str());
       else  
       {
-         bool found = false;
-
-         // Check if script is in our cache
-         S32 cacheSize = (S32)mCachedScripts.size();
-
-         for(S32 i = 0; i < cacheSize; i++)
-            if(mCachedScripts[i] == mScriptName)
-            {
-               found = true;
-               break;
-            }
-
-         if(!found)     // Script is not (yet) cached
+         // Compiled chunks are small, so we keep every script we've seen until someone clears the cache
+         if(mCachedScripts.find(mScriptName) == mCachedScripts.end())
          {
-            if(cacheSize > MAX_CACHE_SIZE)
-            {
-               // Remove oldest script from the cache
-               deleteScript(mCachedScripts.front().c_str());
-               mCachedScripts.pop_front();
-            }
-
             // Load new script into cache using full name as registry key
             loadCompileSaveScript(mScriptName.c_str(), mScriptName.c_str());
-            mCachedScripts.push_back(mScriptName);
+            mCachedScripts.insert(mScriptName);
          }
 
          lua_getfield(L, LUA_REGISTRYINDEX, mScriptName.c_str());    // Load script from cache
@@ -353,7 +365,9 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
       lua_insert(L, 1);                                      // -- _stackTracer, function, <<args>>
    }
 
+   beginCall();
    S32 error = lua_pcall(L, args, returnValues, -2 - args);  // -- _stackTracer, <<return values>>
+   endCall();
 
    if(!error)
    {
@@ -363,6 +377,20 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
       return false;
    }
 
+   // If countHook() stopped the script, it's not really broken, it just needs to sit out a tick
+   if(mHardBudgetExceeded)
+   {
+      mHardBudgetExceeded = false;
+      mSkipTick = mCurrentTick + 1;
+      mOverBudgetCount++;
+
+      logprintf(LogConsumer::LogWarning, "%s Stopped %s() in %s after it ran for more than %s ms; skipping the script's next tick",
+                getErrorMessagePrefix(), function, mScriptName.c_str(), ftos(mHardBudget).c_str());
+
+      clearStack(L);
+      return true;
+   }
+
    // There was an error... handle it!
 
    string msg = lua_tostring(L, -1);
@@ -412,10 +440,239 @@ bool LuaScriptRunner::startLua(const string &scriptingDir)
       return false;
    }
 
+   updateHook();
+
    return true;
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+// CPU accounting
+//
+// Every call into a script goes through runCmd(), which times it.  Time spent in a nested call (e.g. a bot's chat
+// firing another script's onMsgReceived) is charged to the nested script.  A script that uses more than mSoftBudget
+// in a tick sits out its next tick.
+//
+// When there's a hard budget or we're profiling, countHook() also runs every HookInterval instructions.  It counts
+// instructions, samples which function is running, and stops calls that have run past mHardBudget.  LuaJIT doesn't
+// run hooks inside compiled code, so the JIT compiler is off while the hook is installed; otherwise a hot loop would
+// never be stopped.
+
+void LuaScriptRunner::setBudgets(F32 softBudget, F32 hardBudget)
+{
+   mSoftBudget = max(softBudget, 0.0f);
+   mHardBudget = max(hardBudget, 0.0f);
+   updateHook();
+}
+
+
+void LuaScriptRunner::setProfiling(bool profiling)
+{
+   mProfiling = profiling;
+   updateHook();
+}
+
+
+bool LuaScriptRunner::isProfiling()
+{
+   return mProfiling;
+}
+
+
+void LuaScriptRunner::beginTick()
+{
+   mCurrentTick++;
+
+   // Let go of last tick's objects, and start holding this tick's
+   if(L)
+   {
+      lua_newtable(L);                                      // -- table
+      lua_setfield(L, LUA_REGISTRYINDEX, TickObjectsKey);   // --
+   }
+}
+
+
+// Calls jit.on() or jit.off(), and throws out any compiled code; does nothing if we're not running on LuaJIT
+static void setJitEnabled(lua_State *L, bool enabled)
+{
+   lua_getglobal(L, "jit");                              // -- jit
+
+   if(lua_istable(L, -1))
+   {
+      lua_getfield(L, -1, enabled ? "on" : "off");       // -- jit, on/off
+      lua_call(L, 0, 0);                                 // -- jit
+
+      lua_getfield(L, -1, "flush");                      // -- jit, flush
+      lua_call(L, 0, 0);                                 // -- jit
+   }
+
+   lua_pop(L, 1);                                        // --
+}
+
+
+// The hook slows down the interpreter, and keeps the JIT compiler from running, so we only install it when we need it
+void LuaScriptRunner::updateHook()
+{
+   if(!L)
+      return;
+
+   bool hook = mProfiling || mHardBudget > 0;
+
+   if(hook)
+      lua_sethook(L, countHook, LUA_MASKCOUNT, HookInterval);
+   else
+      lua_sethook(L, NULL, 0, 0);
+
+   setJitEnabled(L, !hook);
+}
+
+
+void LuaScriptRunner::countHook(lua_State *L, lua_Debug *ar)
+{
+   if(mCallStack.size() == 0 || !mCallStack.last())    // Not running on behalf of any script we know about
+      return;
+
+   LuaScriptRunner *script = mCallStack.last();
+
+   script->mInstructionCount += HookInterval;
+
+   if(mProfiling && lua_getinfo(L, "Sn", ar))
+   {
+      FunctionProfile &profile = script->mFunctionProfiles[string(ar->short_src) + ":" + itos(ar->linedefined)];
+
+      if(profile.name == "" && ar->name)
+         profile.name = ar->name;
+
+      profile.instructions += HookInterval;
+   }
+
+   if(mHardBudget > 0 &&
+         Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - mCallStart) > mHardBudget)
+   {
+      script->mHardBudgetExceeded = true;
+      luaL_error(L, "Script exceeded its CPU budget");
+   }
+}
+
+
+void LuaScriptRunner::beginCall()
+{
+   S64 now = Platform::getHighPrecisionTimerValue();
+
+   // Pause the clock on whoever we interrupted
+   if(mCallStack.size() > 0 && mCallStack.last())
+      mCallStack.last()->addTime(Platform::getHighPrecisionMilliseconds(now - mSliceStart));
+
+   mCallStack.push_back(this);
+   mHardBudgetExceeded = false;
+   mSliceStart = now;
+   mCallStart = now;
+}
+
+
+void LuaScriptRunner::endCall()
+{
+   S64 now = Platform::getHighPrecisionTimerValue();
+
+   if(mCallStack.last())
+      mCallStack.last()->addTime(Platform::getHighPrecisionMilliseconds(now - mSliceStart));
+
+   mCallStack.pop_back();
+
+   // Whoever we interrupted gets the clock back, and a fresh start on the hard budget
+   mSliceStart = now;
+   mCallStart = now;
+}
+
+
+void LuaScriptRunner::addTime(F32 ms)
+{
+   updateTick();
+
+   mTickTime += ms;
+   mTotalTime += ms;
+}
+
+
+void LuaScriptRunner::updateTick()
+{
+   if(mTick == mCurrentTick)
+      return;
+
+   if(mSoftBudget > 0 && mTickTime > mSoftBudget)
+   {
+      mSkipTick = mCurrentTick;
+      mOverBudgetCount++;
+
+      U32 now = Platform::getRealMilliseconds();
+
+      if(mLastBudgetWarning == 0 || now - mLastBudgetWarning > 10000)
+      {
+         logprintf(LogConsumer::LogWarning, "%s %s used %s ms in one tick, over its budget of %s ms; skipping its next tick "
+                   "(%d ticks skipped so far)", getErrorMessagePrefix(), mScriptName.c_str(), ftos(mTickTime, 2).c_str(),
+                   ftos(mSoftBudget).c_str(), mOverBudgetCount);
+         mLastBudgetWarning = now;
+      }
+   }
+
+   mTick = mCurrentTick;
+   mTickTime = 0;
+}
+
+
+bool LuaScriptRunner::isSkippingTick()
+{
+   updateTick();
+   return mSkipTick == mCurrentTick;
+}
+
+
+F64 LuaScriptRunner::getTotalTime() const
+{
+   return mTotalTime;
+}
+
+
+void LuaScriptRunner::resetProfile()
+{
+   mTotalTime = 0;
+   mInstructionCount = 0;
+   mOverBudgetCount = 0;
+   mFunctionProfiles.clear();
+}
+
+
+static bool instructionsGreaterThan(const pair<string, U64> &a, const pair<string, U64> &b)
+{
+   return a.second > b.second;
+}
+
+
+// Adds a summary line for this script, then a line for each of its busiest functions
+void LuaScriptRunner::getProfile(Vector<string> &lines, S32 maxFunctions) const
+{
+   lines.push_back(mScriptName + " [" + mScriptId + "]: " + ftos(F32(mTotalTime), 1) + " ms, " +
+                   itos(U64(mInstructionCount)) + " instructions, " + itos(mOverBudgetCount) + " ticks skipped");
+
+   Vector<pair<string, U64> > functions;
+
+   for(map<string, FunctionProfile>::const_iterator it = mFunctionProfiles.begin(); it != mFunctionProfiles.end(); it++)
+   {
+      string name = (it->second.name != "" ? it->second.name : "?") + " (" + it->first + ")";
+      functions.push_back(pair<string, U64>(name, it->second.instructions));
+   }
+
+   functions.sort(instructionsGreaterThan);
+
+   for(S32 i = 0; i < functions.size() && i < maxFunctions; i++)
+   {
+      F32 percent = mInstructionCount > 0 ? 100.0f * functions[i].second / mInstructionCount : 0;
+      lines.push_back("   " + ftos(percent, 1) + "%  " + functions[i].first);
+   }
+}
+
+
 // Prepare a new Lua environment ("L") for use -- called from startLua(), and testing.
 bool LuaScriptRunner::configureNewLuaInstance(lua_State *L)
 {
@@ -502,8 +759,85 @@ void LuaScriptRunner::loadCompileScript(const char *filename)
    // LUA_ERRSYNTAX: syntax error during pre-compilation;  [[ err == 3 ]]
    // LUA_ERRMEM: memory allocation error.  [[ err == 4 ]]
 
-   if(filename[0] != '\0' && luaL_loadfile(L, filename) != 0)
+   if(filename[0] == '\0')
+      return;
+
+   string cacheFile;
+
+   if(loadCachedBytecode(filename, cacheFile))
+      return;
+
+   if(luaL_loadfile(L, filename) != 0)
       throw LuaException("Error compiling script " + string(filename) + "\n" + string(lua_tostring(L, -1)));
+
+   if(cacheFile != "")
+      saveCachedBytecode(cacheFile);
+}
+
+
+// The bytecode cache holds the compiled version of every script we've loaded, in mBytecodeCacheDir, named for a hash of the
+// script's name and contents.  An edited script gets a new hash, so there's never any question of whether a file is stale.
+// Note that Lua doesn't check bytecode the way it checks source, so we only ever load bytecode that we wrote ourselves.
+
+// Puts the cached compiled version of filename on the stack, if there is one.  Otherwise, sets cacheFile to where it should
+// go once it's been compiled, or to "" if it shouldn't be cached.
+bool LuaScriptRunner::loadCachedBytecode(const char *filename, string &cacheFile)
+{
+   cacheFile = "";
+
+   if(mBytecodeCacheDir == "")
+      return false;
+
+   string source = readFile(filename);
+
+   if(source == "")
+      return false;     // Let luaL_loadfile() report the problem
+
+   // Bytecode from another build, or from a different Lua engine, may not load; we'd just replace it, but we might as well not try
+   string hash = Game::md5.getHashFromString(itos(BUILD_VERSION) + "\n" + LUA_RELEASE + "\n" + filename + "\n" + source);
+   cacheFile = joindir(mBytecodeCacheDir, hash + ".luac");
+
+   string bytecode = readFile(cacheFile);
+
+   // Compiled chunks start with an escape character; anything else would be taken as source, so leave it alone
+   if(bytecode == "" || bytecode[0] != '\033')
+      return false;
+
+   if(luaL_loadbuffer(L, bytecode.c_str(), bytecode.size(), filename) != 0)
+   {
+      lua_pop(L, 1);    // Remove the error message; we'll compile the source and overwrite the file
+      return false;
+   }
+
+   return true;
+}
+
+
+static int bytecodeWriter(lua_State *L, const void *p, size_t size, void *data)
+{
+   static_cast<string *>(data)->append(static_cast<const char *>(p), size);
+   return 0;
+}
+
+
+// Saves the compiled chunk on top of the stack to cacheFile.  The cache is only there to save time, so we don't complain if
+// this doesn't work out.
+void LuaScriptRunner::saveCachedBytecode(const string &cacheFile)
+{
+   string bytecode;
+
+   if(lua_dump(L, bytecodeWriter, &bytecode) != 0 || bytecode == "" || !makeSureFolderExists(mBytecodeCacheDir))
+      return;
+
+   FILE *f = fopen(cacheFile.c_str(), "wb");
+   if(!f)
+      return;
+
+   bool ok = fwrite(bytecode.c_str(), 1, bytecode.size(), f) == bytecode.size();
+   fclose(f);
+
+   if(!ok)
+      remove(cacheFile.c_str());    // Don't leave half a file lying around
 }
 
 
@@ -978,6 +1312,8 @@ void LuaScriptRunner::setGlobalObjectArrays(lua_State *L)
       METHOD(CLASS, findObjectById,        ARRAYDEF({{ INT, END }}), 1 )    \
       METHOD(CLASS, findAllObjects,        ARRAYDEF({{ TABLE, INTS, END }, { TABLE, END }, { INTS, END }, { END }}), 4 ) \
       METHOD(CLASS, findAllObjectsInArea,  ARRAYDEF({{ TABLE, PT, PT, INTS, END }, { PT, PT, INTS, END }}), 2 ) \
+      METHOD(CLASS, iterateObjects,        ARRAYDEF({{ INTS, END }, { END }}), 2 ) \
+      METHOD(CLASS, iterateObjectsInArea,  ARRAYDEF({{ PT, PT, INTS, END }}), 1 ) \
       METHOD(CLASS, addItem,               ARRAYDEF({{ BFOBJ, END }}), 1 )  \
       METHOD(CLASS, getGameInfo,           ARRAYDEF({{ END }}), 1 )         \
       METHOD(CLASS, getPlayerCount,        ARRAYDEF({{ END }}), 1 )         \
@@ -1111,42 +1447,9 @@ S32 LuaScriptRunner::lua_findAllObjects(lua_State *L)
 {
    checkArgList(L, functionArgs, luaClassName, "findAllObjects");
 
-   TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
-
-   fillVector.clear();
-   static Vector<U8> types;
-
-   types.clear();
-
-   // We expect the stack to look like this: -- objType1, objType2, ...
-   // or this, if using the deprecated fill table option -- [fillTable], objType1, objType2, ...
-   // We'll work our way down from the top of the stack (element -1) until we find something that is not a number.
-   // We expect that when we find something that is not a number, the stack will only contain a fillTable.  If the stack
-   // is empty at that point, we'll add a table later.
-   // Note that even if stack is empty, lua_isnumber will return a value... which makes no sense!
-   while(lua_gettop(L) > 0 && lua_isnumber(L, -1))
-   {
-      U8 typenum = (U8)lua_tointeger(L, -1);
-
-      // Requests for botzones have to be handled separately; not a problem, we'll just do the search here, and add them to
-      // fillVector, where they'll be merged with the rest of our search results.
-      if(typenum != BotNavMeshZoneTypeNumber)
-         types.push_back(typenum);
-      else
-         mLuaGame->getBotZoneDatabase()->findObjects(BotNavMeshZoneTypeNumber, fillVector);
-
-      lua_pop(L, 1);
-   }
-
-   const Vector<DatabaseObject *> * results;
-
-   if(types.size() == 0)
-      results = mLuaGridDatabase->findObjects_fast();
-   else
-   {
-      mLuaGridDatabase->findObjects(types, fillVector);
-      results = &fillVector;
-   }
+   // We expect that once the object types are gone, the stack will only contain a fillTable.  If the stack is empty at that
+   // point, we'll add a table later.
+   const Vector<DatabaseObject *> *results = findObjects(L);
 
    // This will guarantee a table at the top of the stack to return our found objects
    if(!lua_istable(L, -1))
@@ -1198,30 +1501,149 @@ S32 LuaScriptRunner::lua_findAllObjectsInArea(lua_State *L)
 {
    checkArgList(L, functionArgs, luaClassName, "findAllObjectsInArea");
 
-   TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
+   // Once the points and object types are gone, we should be left with nothing, or a table
+   const Vector<DatabaseObject *> &results = *findObjectsInArea(L);
+
+   // This will guarantee a table at the top of the stack to return our found objects
+   if(!lua_istable(L, -1))
+   {
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack not cleared!");
+
+      lua_createtable(L, results.size(), 0);    // Create a table, with enough slots pre-allocated for our data
+   }
+   else
+      logprintf(LogConsumer::LuaBotMessage, "Usage of a fill table with findAllObjectsInArea() "
+            "is deprecated and will be removed in the future.  Instead, don't use one");
+
+   S32 pushed = 0;      // Count of items we put into our table
+
+   for(S32 i = 0; i < results.size(); i++)
+   {
+      static_cast<BfObject *>(results[i])->push(L);
+      pushed++;      // Increment pushed before using it because Lua uses 1-based arrays
+      lua_rawseti(L, 1, pushed);
+   }
+
+   TNLAssert(lua_gettop(L) == 1 || dumpStack(L), "Stack has unexpected items on it!");
 
-   static Vector<U8> types;
+   return 1;
+}
+
+
+/**
+ * @luafunc function LuaScriptRunner::iterateObjects(ObjType objType, ...)
+ *
+ * @brief Loops over all items of the specified object type anywhere on the level,
+ * without building a table.
+ *
+ * @descr Works like \ref findAllObjects(), but hands the objects out one at a
+ * time, for use in a `for` loop.  Nothing is made for objects you don't get to,
+ * so this is the cheaper choice for scripts that scan every tick, especially if
+ * they stop once they find what they're looking for.
+ *
+ * Objects removed from the game during the loop are skipped.
+ *
+ * @param [objType] ObjTypes specifying what types of objects to find.
+ *
+ * @return An iterator function for a `for` loop.
+ *
+ * @code
+ * for item in bf:iterateObjects(ObjType.ResourceItem) do
+ *   if item:getPos().x > 0 then
+ *     target = item
+ *     break
+ *   end
+ * end
+ * @endcode
+ */
+S32 LuaScriptRunner::lua_iterateObjects(lua_State *L)
+{
+   checkArgList(L, functionArgs, luaClassName, "iterateObjects");
 
-   types.clear();
-   fillVector.clear();
+   return pushObjectIterator(L, findObjects(L));
+}
 
-   bool hasBotZoneType = false;
 
-   // We expect the stack to look like this: -- point1, point2, objType1, objType2, ...
-   // or this, if using the deprecated fill table option -- [fillTable], point1, point2, objType1, objType2, ...
+/**
+ * @luafunc function LuaScriptRunner::iterateObjectsInArea(point point1, point point2, ObjType objType, ...)
+ *
+ * @brief Loops over all items of the specified type(s) in a given search area,
+ * without building a table.
+ *
+ * @descr Works like \ref findAllObjectsInArea(); see \ref iterateObjects() for
+ * how to use it.
+ *
+ * @param point1 One corner of a search rectangle.
+ * @param point2 Another corner of a search rectangle diagonally opposite to the
+ * first.
+ * @param objType The \ref ObjTypeEnum to look for. Multiple can be specified.
+ *
+ * @return An iterator function for a `for` loop.
+ */
+S32 LuaScriptRunner::lua_iterateObjectsInArea(lua_State *L)
+{
+   checkArgList(L, functionArgs, luaClassName, "iterateObjectsInArea");
+
+   return pushObjectIterator(L, findObjectsInArea(L));
+}
+
+
+// Pops the object types at the top of the stack into mFindTypes, except for botzones, which live in their own database
+void LuaScriptRunner::popFindTypes(lua_State *L, bool &hasBotZoneType)
+{
+   mFindQuery.clear();
+   mFindTypes.clear();
+
+   hasBotZoneType = false;
+
    // We'll work our way down from the top of the stack (element -1) until we find something that is not a number.
+   // Note that even if stack is empty, lua_isnumber will return a value... which makes no sense!
    while(lua_gettop(L) > 0 && lua_isnumber(L, -1))
    {
       U8 typenum = (U8)lua_tointeger(L, -1);
 
-      // Requests for botzones have to be handled separately
       if(typenum != BotNavMeshZoneTypeNumber)
-         types.push_back(typenum);
+         mFindTypes.push_back(typenum);
       else
          hasBotZoneType = true;
 
       lua_pop(L, 1);
    }
+}
+
+
+// Does the search for findAllObjects() and iterateObjects().  We expect the stack to look like this:
+// -- objType1, objType2, ...   or this, if using the deprecated fill table option -- [fillTable], objType1, objType2, ...
+// Pops the object types; the results are good until the next search.
+const Vector<DatabaseObject *> *LuaScriptRunner::findObjects(lua_State *L)
+{
+   TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
+
+   bool hasBotZoneType;
+   popFindTypes(L, hasBotZoneType);
+
+   // Requests for botzones have to be handled separately; not a problem, we'll just do the search here, and add them to
+   // mFindQuery, where they'll be merged with the rest of our search results.
+   if(hasBotZoneType)
+      mLuaGame->getBotZoneDatabase()->findObjects(BotNavMeshZoneTypeNumber, mFindQuery);
+
+   if(mFindTypes.size() == 0)
+      return mLuaGridDatabase->findObjects_fast();
+
+   mLuaGridDatabase->findObjects(mFindTypes, mFindQuery);
+   return &mFindQuery.getResults();
+}
+
+
+// Does the search for findAllObjectsInArea() and iterateObjectsInArea().  We expect the stack to look like this:
+// -- point1, point2, objType1, objType2, ...   or this, if using the deprecated fill table option -- [fillTable], point1, ...
+// Pops the points and object types; the results are good until the next search.
+const Vector<DatabaseObject *> *LuaScriptRunner::findObjectsInArea(lua_State *L)
+{
+   TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
+
+   bool hasBotZoneType;
+   popFindTypes(L, hasBotZoneType);
 
    // We should be left with 2 points and maybe a table
    Point p1 = getPointOrXY(L, -1);
@@ -1231,36 +1653,106 @@ S32 LuaScriptRunner::lua_findAllObjectsInArea(lua_State *L)
    Rect searchArea = Rect(p1, p2);
 
    if(hasBotZoneType)
-      mLuaGame->getBotZoneDatabase()->findObjects(BotNavMeshZoneTypeNumber, fillVector, searchArea);
+      mLuaGame->getBotZoneDatabase()->findObjects(BotNavMeshZoneTypeNumber, mFindQuery, searchArea);
 
-   mLuaGridDatabase->findObjects(types, fillVector, searchArea);
+   mLuaGridDatabase->findObjects(mFindTypes, mFindQuery, searchArea);
 
-   // This will guarantee a table at the top of the stack to return our found objects
-   if(!lua_istable(L, -1))
-   {
-      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack not cleared!");
+   return &mFindQuery.getResults();
+}
+
+
+// Where an iterateObjects() loop is up to.  Lives in a userdata that's an upvalue of the loop's iterator function.  We hold
+// SafePtrs rather than the search results themselves, because the loop might remove objects from the game as it goes.
+struct ObjectIterator
+{
+   Vector<SafePtr<BfObject> > objects;
+   S32 next;
+};
+
+static const char *ObjectIteratorMetatable = "ObjectIterator";
 
-      lua_createtable(L, fillVector.size(), 0);    // Create a table, with enough slots pre-allocated for our data
+
+static S32 deleteObjectIterator(lua_State *L)
+{
+   static_cast<ObjectIterator *>(lua_touserdata(L, 1))->~ObjectIterator();
+   return 0;
+}
+
+
+// Pushes a function that returns the next of objects each time it's called, and nil when it runs out
+S32 LuaScriptRunner::pushObjectIterator(lua_State *L, const Vector<DatabaseObject *> *objects)
+{
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack not cleared!");
+
+   ObjectIterator *iterator = new (lua_newuserdata(L, sizeof(ObjectIterator))) ObjectIterator;   // -- iterator
+   iterator->next = 0;
+
+   if(luaL_newmetatable(L, ObjectIteratorMetatable))                                                 // -- iterator, mt
+   {
+      lua_pushcfunction(L, deleteObjectIterator);                                                    // -- iterator, mt, fn
+      lua_setfield(L, -2, "__gc");                                                                   // -- iterator, mt
    }
-   else
-      logprintf(LogConsumer::LuaBotMessage, "Usage of a fill table with findAllObjectsInArea() "
-            "is deprecated and will be removed in the future.  Instead, don't use one");
 
-   S32 pushed = 0;      // Count of items we put into our table
+   lua_setmetatable(L, -2);                                                                          // -- iterator
 
-   for(S32 i = 0; i < fillVector.size(); i++)
+   iterator->objects.reserve(objects->size());
+
+   for(S32 i = 0; i < objects->size(); i++)
    {
-      static_cast<BfObject *>(fillVector[i])->push(L);
-      pushed++;      // Increment pushed before using it because Lua uses 1-based arrays
-      lua_rawseti(L, 1, pushed);
+      // Botzones aren't BfObjects, so they can't go in a SafePtr; use findAllObjects() for those
+      if(objects->get(i)->getObjectTypeNumber() == BotNavMeshZoneTypeNumber)
+         continue;
+
+      iterator->objects.push_back(static_cast<BfObject *>(objects->get(i)));
    }
 
-   TNLAssert(lua_gettop(L) == 1 || dumpStack(L), "Stack has unexpected items on it!");
+   lua_pushcclosure(L, nextObject, 1);                                                               // -- nextObject
 
    return 1;
 }
 
 
+// LuaWrapper's userdata cache is meant to be weak (see luaW_initialize()), so it doesn't promise that an object keeps its
+// userdata from one push to the next; if the collector freed it, the push would make a new proxy and userdata.  We keep a
+// strong reference to everything iterateObjects() hands out until the next tick starts, so the scans that robots do in one
+// tick share a single userdata per object.  Outside of the server's tick (e.g. in the editor) there's no table, and we hold
+// nothing.
+static void holdForTick(lua_State *L)
+{
+   lua_getfield(L, LUA_REGISTRYINDEX, TickObjectsKey);      // -- obj, table
+
+   if(lua_istable(L, -1))
+   {
+      lua_pushvalue(L, -2);                                 // -- obj, table, obj
+      lua_pushboolean(L, 1);                                // -- obj, table, obj, true
+      lua_rawset(L, -3);                                    // -- obj, table
+   }
+
+   lua_pop(L, 1);                                           // -- obj
+}
+
+
+S32 LuaScriptRunner::nextObject(lua_State *L)
+{
+   ObjectIterator *iterator = static_cast<ObjectIterator *>(lua_touserdata(L, lua_upvalueindex(1)));
+
+   while(iterator->next < iterator->objects.size())
+   {
+      BfObject *obj = iterator->objects[iterator->next++];
+
+      if(obj && !obj->isDeleted())
+      {
+         obj->push(L);                                            // -- obj
+         holdForTick(L);
+         return 1;
+      }
+   }
+
+   iterator->objects.clear();    // Done; no need to wait for the collector to free these
+   return 0;
+}
+
+
 /**
  * @luafunc LuaScriptRunner::addItem(BfObject obj)
  *
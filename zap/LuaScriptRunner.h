@@ -9,11 +9,13 @@
 #include "LuaBase.h"          // Parent class
 #include "EventManager.h"
 #include "LuaWrapper.h"
+#include "gridDB.h"           // For DatabaseQuery
 
 #include "tnl.h"
 #include "tnlVector.h"
 
-#include <deque>
+#include <map>
+#include <set>
 #include <string>
 
 using namespace std;
@@ -47,9 +49,10 @@ class LuaScriptRunner
 {
 
 private:
-   static deque<string> mCachedScripts;
+   static set<string> mCachedScripts;       // Scripts whose compiled chunks are in the registry, keyed by filename
 
    static string mScriptingDir;
+   static string mBytecodeCacheDir;
 
    void setLuaArgs(const Vector<string> &args);
    static void setModulePath();
@@ -58,6 +61,8 @@ private:
    static void loadCompileRunHelper(const string &scriptName);
    static void loadCompileSaveScript(const char *filename, const char *registryKey);
    static void loadCompileScript(const char *filename);
+   static bool loadCachedBytecode(const char *filename, string &cacheFile);
+   static void saveCachedBytecode(const string &cacheFile);
 
    void pushStackTracer();      // Put error handler function onto the stack
 
@@ -65,6 +70,42 @@ private:
    static void setGlobalObjectArrays(lua_State *L);          // And some objects
    static void logErrorHandler(const char *msg, const char *prefix);
 
+   // CPU accounting; see runCmd() and countHook()
+   struct FunctionProfile
+   {
+      string name;
+      U64 instructions;
+
+      FunctionProfile() { instructions = 0; }
+   };
+
+   static Vector<LuaScriptRunner *> mCallStack;    // Scripts with calls under way, innermost last; NULL if deleted since
+   static S64 mSliceStart;          // When the innermost call started, or last got control back from a nested call
+   static S64 mCallStart;           // When the innermost call started
+   static U32 mCurrentTick;
+   static F32 mSoftBudget;          // ms a script can use in one tick before it has to sit out the next, 0 for no limit
+   static F32 mHardBudget;          // ms one call can run before we stop it, 0 for no limit
+   static bool mProfiling;
+
+   U32 mTick;                       // Tick mTickTime is for
+   F32 mTickTime;                   // ms used during mTick
+   U32 mSkipTick;                   // Tick this script sits out, after going over budget
+   U32 mSkippedTimerTime;           // Time tickTimer() didn't get to pass on while we were sitting out
+   F64 mTotalTime;                  // ms used since the profile was last reset
+   U64 mInstructionCount;           // Only counted while the hook is installed
+   U32 mOverBudgetCount;            // Ticks skipped since the profile was last reset
+   U32 mLastBudgetWarning;          // So a script that's always over budget doesn't flood the log
+   bool mHardBudgetExceeded;
+   map<string, FunctionProfile> mFunctionProfiles;   // Sampled instruction counts, keyed by where the function is defined
+
+   static void updateHook();
+   static void countHook(lua_State *L, lua_Debug *ar);
+
+   void beginCall();
+   void endCall();
+   void addTime(F32 ms);
+   void updateTick();               // Wraps up the last tick's accounting if a new one has begun
+
 protected:
    enum ScriptType {
       ScriptTypeLevelgen,
@@ -79,6 +120,15 @@ protected:
                                     // ClientGame depending on where the script is called from
    GridDatabase *mLuaGridDatabase;  // Pointer to our current grid database with objects to manipulate
 
+   DatabaseQuery mFindQuery;        // Reused by the findAllObjects family, so scripts don't share search state
+   Vector<U8> mFindTypes;
+
+   void popFindTypes(lua_State *L, bool &hasBotZoneType);
+   const Vector<DatabaseObject *> *findObjects(lua_State *L);
+   const Vector<DatabaseObject *> *findObjectsInArea(lua_State *L);
+   static S32 pushObjectIterator(lua_State *L, const Vector<DatabaseObject *> *objects);
+   static S32 nextObject(lua_State *L);
+
    static lua_State *L;          // Main Lua state variable
    string mScriptName;           // Fully qualified script name, with path and everything
    Vector<string> mScriptArgs;   // List of arguments passed to the script
@@ -130,6 +180,19 @@ public:
    virtual ~LuaScriptRunner();      // Destructor
 
    static void clearScriptCache();
+   static void setBytecodeCacheDir(const string &dir);     // Set before startLua(); "" turns the bytecode cache off
+
+   static const S32 HookInterval;                     // Instructions between calls to countHook()
+
+   static void setBudgets(F32 softBudget, F32 hardBudget);
+   static void setProfiling(bool profiling);
+   static bool isProfiling();
+   static void beginTick();                           // Call each time the server fires TickEvent
+
+   bool isSkippingTick();                             // True if we went over budget last tick
+   F64 getTotalTime() const;
+   void resetProfile();
+   void getProfile(Vector<string> &lines, S32 maxFunctions) const;
 
    virtual const char *getErrorMessagePrefix();
 
@@ -162,6 +225,16 @@ public:
    template <class T>
    void tickTimer(U32 deltaT)          
    {
+      // Sitting out a tick shouldn't make the script's timers run slow, so they get the time when we come back
+      if(isSkippingTick())
+      {
+         mSkippedTimerTime += deltaT;
+         return;
+      }
+
+      deltaT += mSkippedTimerTime;
+      mSkippedTimerTime = 0;
+
       TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
       clearStack(L);
 
@@ -186,6 +259,8 @@ public:
 
    S32 lua_findAllObjects(lua_State *L);
    S32 lua_findAllObjectsInArea(lua_State *L);
+   S32 lua_iterateObjects(lua_State *L);
+   S32 lua_iterateObjectsInArea(lua_State *L);
    S32 lua_findObjectById(lua_State *L);
 
    S32 lua_addItem(lua_State *L);
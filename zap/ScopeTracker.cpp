@@ -0,0 +1,283 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ScopeTracker.h"
+
+#include "BfObject.h"
+
+#include <algorithm>    // For min, max
+
+
+namespace Zap
+{
+
+// Constructor
+ScopeTracker::ScopeTracker()
+{
+   mDatabase = NULL;
+   mUpdateStamp = 0;
+   mEnterCount = 0;
+   mLeaveCount = 0;
+}
+
+
+// Destructor
+ScopeTracker::~ScopeTracker()
+{
+   setDatabase(NULL);
+}
+
+
+void ScopeTracker::setDatabase(GridDatabase *database)
+{
+   if(mDatabase)
+      mDatabase->setScopeTracker(NULL);
+
+   onDatabaseCleared();    // Whatever we knew was about the old database
+
+   mDatabase = database;
+
+   if(mDatabase)
+      mDatabase->setScopeTracker(this);
+}
+
+
+bool ScopeTracker::isActive() const
+{
+   return mDatabase != NULL;
+}
+
+
+// Splits the part of a that's outside b into up to four rects; returns how many
+static S32 subtractRect(const Rect &a, const Rect &b, Rect *parts)
+{
+   if(a.min.x >= b.max.x || a.max.x <= b.min.x || a.min.y >= b.max.y || a.max.y <= b.min.y)
+   {
+      parts[0] = a;
+      return 1;
+   }
+
+   S32 count = 0;
+
+   // Full-width strips above and below b, then whatever's left on either side of it
+   if(a.min.y < b.min.y)
+      parts[count++] = Rect(a.min.x, a.min.y, a.max.x, b.min.y);
+
+   if(a.max.y > b.max.y)
+      parts[count++] = Rect(a.min.x, b.max.y, a.max.x, a.max.y);
+
+   F32 minY = max(a.min.y, b.min.y);
+   F32 maxY = min(a.max.y, b.max.y);
+
+   if(a.min.x < b.min.x)
+      parts[count++] = Rect(a.min.x, minY, b.min.x, maxY);
+
+   if(a.max.x > b.max.x)
+      parts[count++] = Rect(b.max.x, minY, a.max.x, maxY);
+
+   return count;
+}
+
+
+void ScopeTracker::updateConnection(GhostConnection *connection, const Rect &range)
+{
+   TNLAssert(mDatabase, "Not watching a database!");
+
+   ConnectionScope &scope = mScopes[connection];
+
+   // A new connection, or a new one that got the address of one that's gone
+   if(scope.connection.isNull())
+   {
+      scope.connection = connection;
+      scope.synced = false;
+      scope.objects.clear();
+   }
+
+   scope.updateStamp = mUpdateStamp;
+
+   // Start with everything in range; anything that has changed was found too
+   if(!scope.synced)
+   {
+      mQuery.clear();
+      mDatabase->findObjects((TestFunc)isAnyObjectType, mQuery, range);
+
+      for(S32 i = 0; i < mQuery.getResultCount(); i++)
+         enter(scope, mQuery.getResult(i));
+
+      scope.range = range;
+      scope.synced = true;
+      return;
+   }
+
+   if(!(range == scope.range))
+   {
+      Rect parts[4];
+
+      // What the range has moved onto...
+      mQuery.clear();
+      S32 count = subtractRect(range, scope.range, parts);
+      for(S32 i = 0; i < count; i++)
+         mDatabase->findObjects((TestFunc)isAnyObjectType, mQuery, parts[i]);
+
+      for(S32 i = 0; i < mQuery.getResultCount(); i++)
+         enter(scope, mQuery.getResult(i));
+
+      // ...and off of
+      mQuery.clear();
+      count = subtractRect(scope.range, range, parts);
+      for(S32 i = 0; i < count; i++)
+         mDatabase->findObjects((TestFunc)isAnyObjectType, mQuery, parts[i]);
+
+      for(S32 i = 0; i < mQuery.getResultCount(); i++)
+         if(!mQuery.getResult(i)->getExtent().intersects(range))
+            leave(scope, mQuery.getResult(i));
+
+      scope.range = range;
+   }
+
+   for(S32 i = 0; i < mChanged.getResultCount(); i++)
+   {
+      DatabaseObject *object = mChanged.getResult(i);
+
+      if(mRemoved.find(object) != mRemoved.end())
+         continue;
+
+      if(object->getExtent().intersects(range))
+         enter(scope, object);
+      else
+         leave(scope, object);
+   }
+}
+
+
+void ScopeTracker::endUpdate()
+{
+   map<GhostConnection *, ConnectionScope>::iterator it = mScopes.begin();
+
+   while(it != mScopes.end())
+   {
+      if(it->second.updateStamp == mUpdateStamp)
+      {
+         it++;
+         continue;
+      }
+
+      // Connection has lost its ship, stopped ghosting, or gone away
+      forget(it->second);
+      mScopes.erase(it++);
+   }
+
+   mChanged.clear();
+   mRemoved.clear();
+
+   mUpdateStamp++;
+}
+
+
+void ScopeTracker::enter(ConnectionScope &scope, DatabaseObject *object)
+{
+   BfObject *obj = static_cast<BfObject *>(object);
+
+   // Objects that don't move stay in scope for good, so we needn't remember them
+   if(!isStationaryType(obj->getObjectTypeNumber()) && !scope.objects.insert(obj).second)
+      return;     // Already in scope
+
+   scope.connection->objectLocalScopeAlways(obj);
+   mEnterCount++;
+}
+
+
+void ScopeTracker::leave(ConnectionScope &scope, DatabaseObject *object)
+{
+   BfObject *obj = static_cast<BfObject *>(object);
+
+   if(scope.objects.erase(obj) == 0)
+      return;
+
+   // Once it's no longer always in scope, the connection drops it like anything else that's out of scope
+   scope.connection->objectLocalClearAlways(obj);
+   mLeaveCount++;
+}
+
+
+void ScopeTracker::forget(ConnectionScope &scope)
+{
+   if(scope.connection.isValid())
+      for(set<BfObject *>::iterator it = scope.objects.begin(); it != scope.objects.end(); it++)
+         scope.connection->objectLocalClearAlways(*it);
+
+   scope.objects.clear();
+   scope.synced = false;
+}
+
+
+void ScopeTracker::onObjectAdded(DatabaseObject *object)
+{
+   mRemoved.erase(object);    // A new object can get the address of one removed since the last update
+
+   if(mChanged.markVisited(object))
+      mChanged.addResult(object);
+}
+
+
+void ScopeTracker::onObjectRemoved(DatabaseObject *object)
+{
+   mRemoved.insert(object);
+
+   // The object might not be on its way to being deleted, so take it out of scope ourselves; otherwise it would stay in
+   // scope always, even after it comes back somewhere else
+   BfObject *obj = static_cast<BfObject *>(object);
+
+   for(map<GhostConnection *, ConnectionScope>::iterator it = mScopes.begin(); it != mScopes.end(); it++)
+   {
+      ConnectionScope &scope = it->second;
+
+      if(scope.objects.erase(obj) > 0 && scope.connection.isValid())
+         scope.connection->objectLocalClearAlways(obj);
+   }
+}
+
+
+void ScopeTracker::onExtentChanged(DatabaseObject *object)
+{
+   if(mChanged.markVisited(object))
+      mChanged.addResult(object);
+}
+
+
+void ScopeTracker::onDatabaseCleared()
+{
+   // The objects are about to be deleted, which will take them out of every connection's scope
+   for(map<GhostConnection *, ConnectionScope>::iterator it = mScopes.begin(); it != mScopes.end(); it++)
+   {
+      it->second.objects.clear();
+      it->second.synced = false;
+   }
+
+   mChanged.clear();
+   mRemoved.clear();
+}
+
+
+U32 ScopeTracker::getEnterCount() const
+{
+   return mEnterCount;
+}
+
+
+U32 ScopeTracker::getLeaveCount() const
+{
+   return mLeaveCount;
+}
+
+
+void ScopeTracker::resetCounts()
+{
+   mEnterCount = 0;
+   mLeaveCount = 0;
+}
+
+
+};
@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _SCOPE_TRACKER_H_
+#define _SCOPE_TRACKER_H_
+
+#include "gridDB.h"
+#include "Rect.h"
+
+#include "tnlGhostConnection.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <map>
+#include <set>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+class BfObject;
+
+// Keeps the objects around each connection's ship in scope as they come and go, rather than searching the whole scope
+// range for every packet.  The database tells us about objects added, removed, or moved; each update we check just those
+// against every connection's range, plus whatever the range itself has moved onto or off of since the last update.
+//
+// Objects we put in scope are marked to stay there (GhostConnection::objectLocalScopeAlways()) until we see them leave.
+// Objects that never move -- walls, zones, turrets and the like -- are left in scope for good once a connection has seen
+// them.
+class ScopeTracker
+{
+private:
+   struct ConnectionScope
+   {
+      SafePtr<GhostConnection> connection;   // NULL if the connection has gone away
+      Rect range;                            // Where we were scoping at the last update
+      bool synced;                           // False until we've searched the whole range
+      U32 updateStamp;                       // mUpdateStamp when last updated
+      set<BfObject *> objects;               // Moving objects we put in scope, and will need to take out again
+   };
+
+   GridDatabase *mDatabase;
+   map<GhostConnection *, ConnectionScope> mScopes;
+
+   DatabaseQuery mChanged;                   // Objects added or moved since the last update
+   set<DatabaseObject *> mRemoved;           // Objects in mChanged that have since been removed
+   DatabaseQuery mQuery;                     // For searches during updates
+
+   U32 mUpdateStamp;
+   U32 mEnterCount;                          // For benchmarking
+   U32 mLeaveCount;
+
+   void enter(ConnectionScope &scope, DatabaseObject *object);
+   void leave(ConnectionScope &scope, DatabaseObject *object);
+   void forget(ConnectionScope &scope);
+
+public:
+   ScopeTracker();            // Constructor
+   virtual ~ScopeTracker();   // Destructor
+
+   void setDatabase(GridDatabase *database);    // Start watching database; NULL to stop
+   bool isActive() const;
+
+   // Brings connection's scope up to date for a ship scoping range.  Call for every connection with a ship, then call
+   // endUpdate().
+   void updateConnection(GhostConnection *connection, const Rect &range);
+
+   // Takes out of scope what we put in for connections that weren't updated, and forgets what has changed
+   void endUpdate();
+
+   // Called by the database we're watching
+   void onObjectAdded(DatabaseObject *object);
+   void onObjectRemoved(DatabaseObject *object);
+   void onExtentChanged(DatabaseObject *object);
+   void onDatabaseCleared();
+
+   U32 getEnterCount() const;
+   U32 getLeaveCount() const;
+   void resetCounts();
+};
+
+
+};
+
+#endif
@@ -55,6 +55,7 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mVoteNumber = 0;
    mVoteType = VoteLevelChange;  // Arbitrary
    mLevelLoadIndex = 0;
+   mLevelInfosPreloaded = false;
    mShutdownOriginator = NULL;
    mHostOnServer = hostOnServer;
 
@@ -68,6 +69,12 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
 
    mShuttingDown = false;
 
+   mUnsimulatedTime = 0;
+   mSimulationOverruns = 0;
+   mBotZonesPending = false;
+   mUnreportedOverruns = 0;
+   mUnreportedSkippedTime = 0;
+
    EventManager::get()->setPaused(false);
 
    mInfoFlags = 0;                           // Currently used to specify test mode and debug builds
@@ -118,10 +125,15 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
 
    botControlTickTimer.reset(BotControlTickInterval);
 
+   LuaScriptRunner::setBudgets(mSettings->getIniSettings()->luaSoftBudget, mSettings->getIniSettings()->luaHardBudget);
+
    mLevelSwitchTimer.setPeriod(LevelSwitchTime);
    GameManager::setHostingModePhase(GameManager::NotHosting);
 
    mGameRecorderServer = NULL;
+
+   if(mSettings->getIniSettings()->incrementalScoping)
+      mScopeTracker.setDatabase(getGameObjDatabase());
 }
 
 
@@ -144,6 +156,8 @@ ServerGame::~ServerGame()
 
    if(mGameRecorderServer)
       delete mGameRecorderServer;
+
+   mScopeTracker.setDatabase(NULL);
 }
 
 
@@ -310,6 +324,7 @@ AbstractTeam *ServerGame::getNewTeam()
 void ServerGame::resetLevelLoadIndex()
 {
    mLevelLoadIndex = 0;
+   mLevelInfosPreloaded = false;
 }
 
 
@@ -375,18 +390,35 @@ string ServerGame::loadNextLevelInfo()
 
    FolderManager *folderManager = getSettings()->getFolderManager();
 
-   string filename = folderManager->findLevelFile(mLevelSource->getLevelFileName(mLevelLoadIndex));
-   TNLAssert(filename != "", "Expected a filename here!");
+   // On the first pass, let the level source read everything it can in one go -- much quicker than a level per call.
+   // We still hand out the names one at a time below, so the hosting UI looks the same.
+   if(mLevelLoadIndex == 0 && !mLevelInfosPreloaded)
+      mLevelInfosPreloaded = mLevelSource->preloadLevelInfos(folderManager);
 
-   // populateLevelInfoFromSource() will return true if the level was processed successfully
    string levelName;
-   if(mLevelSource->populateLevelInfoFromSource(filename, mLevelLoadIndex))
+
+   if(mLevelInfosPreloaded)
    {
-      levelName = mLevelSource->getLevelName(mLevelLoadIndex);    // This will be the name specified in the level file we just populated
-      mLevelLoadIndex++;
+      if(mLevelLoadIndex < mLevelSource->getLevelCount())      // Preloading drops unreadable levels, so could leave none
+      {
+         levelName = mLevelSource->getLevelName(mLevelLoadIndex);
+         mLevelLoadIndex++;
+      }
+   }
+   else
+   {
+      string filename = folderManager->findLevelFile(mLevelSource->getLevelFileName(mLevelLoadIndex));
+      TNLAssert(filename != "", "Expected a filename here!");
+
+      // populateLevelInfoFromSource() will return true if the level was processed successfully
+      if(mLevelSource->populateLevelInfoFromSource(filename, mLevelLoadIndex))
+      {
+         levelName = mLevelSource->getLevelName(mLevelLoadIndex);    // This will be the name specified in the level file we just populated
+         mLevelLoadIndex++;
+      }
+      else     // Failed to process level; remove it from the list
+         mLevelSource->remove(mLevelLoadIndex);
    }
-   else     // Failed to process level; remove it from the list
-      mLevelSource->remove(mLevelLoadIndex);
 
    // Last level to process?
    if(mLevelLoadIndex == mLevelSource->getLevelCount())
@@ -647,46 +679,8 @@ void ServerGame::cycleLevel(S32 nextLevel)
       mGameRecorderServer = new GameRecorderServer(this);
 
 
-   ////// This block could easily be moved off somewhere else   
-   fillVector.clear();
-   getGameObjDatabase()->findObjects(TeleporterTypeNumber, fillVector);
-
-   Vector<pair<Point, const Vector<Point> *> > teleporterData(fillVector.size());
-   pair<Point, const Vector<Point> *> teldat;
-
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      Teleporter *teleporter = static_cast<Teleporter *>(fillVector[i]);
-
-      teldat.first  = teleporter->getPos();
-      teldat.second = teleporter->getDestList();
-
-      teleporterData.push_back(teldat);
-   }
-
-   // Get our parameters together
-   Vector<DatabaseObject *> barrierList;
-   getGameObjDatabase()->findObjects((TestFunc)isWallType, barrierList, *getWorldExtents());
-
-   Vector<DatabaseObject *> turretList;
-   getGameObjDatabase()->findObjects(TurretTypeNumber, turretList, *getWorldExtents());
-
-   Vector<DatabaseObject *> forceFieldProjectorList;
-   getGameObjDatabase()->findObjects(ForceFieldProjectorTypeNumber, forceFieldProjectorList, *getWorldExtents());
-
-   bool triangulate;
-
-   // Try and load Bot Zones for this level, set flag if failed
-   // We need to run buildBotMeshZones in order to set mAllZones properly, which is why I (sort of) disabled the use of hand-built zones in level files
-#ifdef ZAP_DEDICATED
-   triangulate = false;
-#else
-   triangulate = !isDedicated();
-#endif
+   buildBotMeshZones();
 
-   mGameType->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mBotZoneDatabase, &mAllZones,
-                                                                          getWorldExtents(), barrierList, turretList,
-                                                                          forceFieldProjectorList, teleporterData, triangulate);
    // Clear team info for all clients
    resetAllClientTeams();
 
@@ -813,6 +807,45 @@ void ServerGame::setAutoLeveling(bool enabled)
 }
 
 
+static bool totalTimeGreaterThan(LuaScriptRunner * const &a, LuaScriptRunner * const &b)
+{
+   return a->getTotalTime() > b->getTotalTime();
+}
+
+
+// Describes where our levelgens and robots have been spending their time, busiest first
+void ServerGame::getLuaProfile(Vector<string> &lines, S32 maxFunctionsPerScript)
+{
+   Vector<LuaScriptRunner *> scripts;
+
+   for(S32 i = 0; i < mLevelGens.size(); i++)
+      scripts.push_back(mLevelGens[i]);
+
+   for(S32 i = 0; i < getBotCount(); i++)
+      scripts.push_back(getBot(i));
+
+   scripts.sort(totalTimeGreaterThan);
+
+   for(S32 i = 0; i < scripts.size(); i++)
+      scripts[i]->getProfile(lines, maxFunctionsPerScript);
+
+   if(scripts.size() > 0)
+      EventManager::get()->getDispatchStats(lines);
+}
+
+
+void ServerGame::resetLuaProfile()
+{
+   for(S32 i = 0; i < mLevelGens.size(); i++)
+      mLevelGens[i]->resetProfile();
+
+   for(S32 i = 0; i < getBotCount(); i++)
+      getBot(i)->resetProfile();
+
+   EventManager::get()->resetDispatchStats();
+}
+
+
 // Make sure level metadata fits with our current game situation; i.e. check playerCount against min/max players,
 // skip uploaded levels if the settings tell us to, etc.  Can expand this to incorporate other metadata as we 
 // develop it.
@@ -1058,6 +1091,184 @@ inline string getPathFromFilename(const string &filename)
 }
 
 
+// Builds the bot nav zones for the level we just loaded, or gets them from the nav mesh cache if we've built them before.
+// Returns true if they came from the cache.
+bool ServerGame::buildBotMeshZones()
+{
+   // Paths from the old zones are no use with the new ones
+   if(mBotPathCache.getHits() + mBotPathCache.getMisses() > 0)
+      logprintf(LogConsumer::ServerFilter, "Bot path cache: %d hits, %d misses, %d of %d paths in use", mBotPathCache.getHits(),
+                mBotPathCache.getMisses(), mBotPathCache.getSize(), mBotPathCache.getCapacity());
+
+   mBotPathCache.clear();
+   mBotPathCache.resetStats();
+
+   if(mBotFlowFields.getHits() + mBotFlowFields.getMisses() > 0)
+      logprintf(LogConsumer::ServerFilter, "Bot flow fields: %d hits, %d misses, %d of %d fields in use", mBotFlowFields.getHits(),
+                mBotFlowFields.getMisses(), mBotFlowFields.getSize(), mBotFlowFields.getCapacity());
+
+   mBotFlowFields.clear();
+   mBotFlowFields.resetStats();
+
+   // If the worker is still busy with the last level's zones, we don't want them now
+   bool triangulated;
+   delete mLevelPreloader.takeNavMesh(triangulated);
+   mBotZonesPending = false;
+
+   bool triangulate = shouldTriangulateBotZones();
+
+   // The cache is keyed on the level file, so we only use it for levels that came from one.  Not for levels whose walls
+   // also came from a levelgen (which might not make the same ones every time), or for the editor's test levels, which
+   // change constantly.
+   string cacheFile;
+   if(mLevelFileHash != "" && mLevelSource->getLevelFileName(mCurrentLevelIndex) != "" && mLevelGens.size() == 0 && 
+      !isTestServer())
+      cacheFile = BotNavMeshZone::getCacheFileName(getBotNavMeshCacheDir(), mLevelFileHash);
+
+   bool fromCache = false;
+
+   if(cacheFile != "")
+   {
+      if(mPreloadedNavMeshData != "")
+         fromCache = BotNavMeshZone::readBotMeshZoneCacheData(mPreloadedNavMeshData, mBotZoneDatabase, &mAllZones, triangulate);
+      else
+         fromCache = BotNavMeshZone::readBotMeshZoneCache(cacheFile, mBotZoneDatabase, &mAllZones, triangulate);
+   }
+
+   mPreloadedNavMeshData.clear();
+
+   if(fromCache)
+   {
+      mGameType->mBotZoneCreationFailed = false;
+      mBotZoneClusters.build(&mAllZones);
+      return true;
+   }
+
+   fillVector.clear();
+   getGameObjDatabase()->findObjects(TeleporterTypeNumber, fillVector);
+
+   Vector<pair<Point, const Vector<Point> *> > teleporterData(fillVector.size());
+   pair<Point, const Vector<Point> *> teldat;
+
+   for(S32 i = 0; i < fillVector.size(); i++)
+   {
+      Teleporter *teleporter = static_cast<Teleporter *>(fillVector[i]);
+
+      teldat.first  = teleporter->getPos();
+      teldat.second = teleporter->getDestList();
+
+      teleporterData.push_back(teldat);
+   }
+
+   // Get our parameters together
+   Vector<DatabaseObject *> barrierList;
+   getGameObjDatabase()->findObjects((TestFunc)isWallType, barrierList, *getWorldExtents());
+
+   Vector<DatabaseObject *> turretList;
+   getGameObjDatabase()->findObjects(TurretTypeNumber, turretList, *getWorldExtents());
+
+   Vector<DatabaseObject *> forceFieldProjectorList;
+   getGameObjDatabase()->findObjects(ForceFieldProjectorTypeNumber, forceFieldProjectorList, *getWorldExtents());
+
+   // A level we're going to cache zones for can't have a levelgen, so nothing will look at its zones until a robot does.
+   // Have the preloader's worker do the triangulating in the meantime; finishBotMeshZones() takes it from there.
+   if(cacheFile != "")
+   {
+      mAllZones.deleteAndClear();
+
+      BotNavMeshGeometry *geometry = new BotNavMeshGeometry;     // Preloader will own it
+
+      if(!BotNavMeshZone::getBotMeshGeometry(getWorldExtents(), barrierList, turretList, forceFieldProjectorList,
+                                             teleporterData, *geometry))
+      {
+         delete geometry;
+         mGameType->mBotZoneCreationFailed = true;
+         mBotZoneClusters.build(&mAllZones);
+         return false;
+      }
+
+      mLevelPreloader.startNavMesh(geometry);
+      mPendingBotZonesCacheFile = cacheFile;
+      mBotZonesPending = true;
+
+      mGameType->mBotZoneCreationFailed = false;     // As far as we know
+      return false;
+   }
+
+   // Try and load Bot Zones for this level, set flag if failed
+   // We need to run buildBotMeshZones in order to set mAllZones properly, which is why I (sort of) disabled the use of hand-built zones in level files
+   mGameType->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mBotZoneDatabase, &mAllZones,
+                                                                          getWorldExtents(), barrierList, turretList,
+                                                                          forceFieldProjectorList, teleporterData, triangulate);
+   mBotZoneClusters.build(&mAllZones);
+
+   return false;
+}
+
+
+// Turns the geometry the preloader triangulated into zones, waiting for it if need be, and saves them in the nav mesh cache
+void ServerGame::finishBotMeshZones()
+{
+   if(!mBotZonesPending)
+      return;
+
+   mBotZonesPending = false;
+
+   bool triangulated = false;
+   BotNavMeshGeometry *geometry = mLevelPreloader.takeNavMesh(triangulated);
+
+   if(triangulated)
+      BotNavMeshZone::addBotMeshZones(mBotZoneDatabase, &mAllZones, *geometry, shouldTriangulateBotZones());
+
+   delete geometry;
+
+   mBotZoneClusters.build(&mAllZones);
+
+   if(getGameType())
+      getGameType()->mBotZoneCreationFailed = !triangulated;
+
+   if(triangulated && makeSureFolderExists(getBotNavMeshCacheDir()))
+   {
+      if(!BotNavMeshZone::writeBotMeshZoneCache(mPendingBotZonesCacheFile, &mAllZones))
+         logprintf(LogConsumer::LogWarning, "Could not write nav mesh cache %s", mPendingBotZonesCacheFile.c_str());
+   }
+}
+
+
+// Zones are only triangulated for display, on a local client
+bool ServerGame::shouldTriangulateBotZones() const
+{
+#ifdef ZAP_DEDICATED
+   return false;
+#else
+   return !isDedicated();
+#endif
+}
+
+
+// Where the nav mesh cache lives
+string ServerGame::getBotNavMeshCacheDir() const
+{
+   return joindir(getSettings()->getFolderManager()->levelDir, "navmesh");
+}
+
+
+// Starts reading the specified level in the background.  If it turns out to be the next level we load, loadLevel() will
+// use what we read; if not, no harm done.
+void ServerGame::preloadLevel(S32 levelIndex)
+{
+   if(levelIndex < 0 || levelIndex >= mLevelSource->getLevelCount())
+      return;
+
+   string fullFilename = mLevelSource->findLevelFile(levelIndex);
+
+   if(fullFilename == "")     // Not from a file, or the file is gone; either way, nothing to read
+      return;
+
+   mLevelPreloader.start(levelIndex, mLevelSource->getLevelFileName(levelIndex), fullFilename, getBotNavMeshCacheDir());
+}
+
+
 bool ServerGame::loadLevel()
 {
    resetLevelInfo();    // Resets info about the level, not a LevelInfo...  In case you were wondering.
@@ -1065,7 +1276,18 @@ bool ServerGame::loadLevel()
    mObjectsLoaded = 0;
    setLevelDatabaseId(LevelDatabase::NOT_IN_DATABASE);
 
-   mLevelFileHash = mLevelSource->loadLevel(mCurrentLevelIndex, this, getGameObjDatabase());
+   mPreloadedNavMeshData.clear();
+
+   LevelPreloader::Level preloaded;
+
+   if(mLevelPreloader.take(mCurrentLevelIndex, mLevelSource->getLevelFileName(mCurrentLevelIndex), preloaded))
+   {
+      loadLevelFromString(preloaded.contents, getGameObjDatabase(), preloaded.fullFilename);
+      mLevelFileHash = preloaded.hash;
+      mPreloadedNavMeshData.swap(preloaded.navMeshData);
+   }
+   else
+      mLevelFileHash = mLevelSource->loadLevel(mCurrentLevelIndex, this, getGameObjDatabase());
 
    // Empty hash means file was not loaded.  Danger Will Robinson!
    if(mLevelFileHash == "")
@@ -1420,6 +1642,8 @@ void ServerGame::idle(U32 timeDelta)
       /*if(getPlayerCount() == 0 && !mGameSuspended && mCurrentTime != 0)
          suspendGame();
    */
+   U32 elapsedTime = timeDelta;    // Unclamped, for fixed-step simulation, which does its own catching up
+
    if(timeDelta > MaxTimeDelta)   // Prevents timeDelta from going too high, usually when after the server was frozen
       timeDelta = 100;
 
@@ -1445,11 +1669,86 @@ void ServerGame::idle(U32 timeDelta)
 
    if(mGameSuspended)     // If game is suspended, we need do nothing more
    {
+      mUnsimulatedTime = 0;
+      updateScopes();
       mNetInterface->processConnections();
       return;
    }
 
+   U32 fixedTimeStep = getFixedTimeStep();
+
+   if(fixedTimeStep == 0)
+   {
+      if(!simulate(timeDelta) && mShuttingDown)
+         return;
+   }
+   else
+   {
+      mUnsimulatedTime += elapsedTime;
+
+      // After a stall, catch up with as many steps as fit in our budget; anything beyond that, we'll never get back.
+      // The unary + passes max() a copy; binding its reference to MaxCatchUpTime would need an out-of-class definition.
+      U32 maxCatchUpTime = max(+MaxCatchUpTime, fixedTimeStep);
+
+      if(mUnsimulatedTime > maxCatchUpTime)
+      {
+         mSimulationOverruns++;
+         mUnreportedOverruns++;
+         mUnreportedSkippedTime += mUnsimulatedTime - maxCatchUpTime;
+
+         mUnsimulatedTime = maxCatchUpTime;
+      }
+
+      // The first overrun gets logged right away; any that follow are rolled up and logged together once in a while
+      mOverrunReportTimer.update(elapsedTime);
+
+      if(mUnreportedOverruns > 0 && mOverrunReportTimer.getCurrent() == 0)
+      {
+         logprintf(LogConsumer::ServerFilter, "Server fell behind %d time%s; skipped %d ms of game time (%d overruns in all)", 
+                   mUnreportedOverruns, mUnreportedOverruns == 1 ? "" : "s", mUnreportedSkippedTime, mSimulationOverruns);
+
+         mUnreportedOverruns = 0;
+         mUnreportedSkippedTime = 0;
+         mOverrunReportTimer.reset(OverrunReportInterval);
+      }
+
+      while(mUnsimulatedTime >= fixedTimeStep)
+      {
+         mUnsimulatedTime -= fixedTimeStep;
+
+         if(!simulate(fixedTimeStep))
+         {
+            mUnsimulatedTime = 0;      // Time from the old level doesn't carry over to the new one
+
+            if(mShuttingDown)
+               return;
+
+            break;
+         }
+      }
+   }
+
+   updateScopes();
+   mNetInterface->processConnections(); // Update to other clients right after idling everything else, so clients get more up to date information
+}
+
+
+U32 ServerGame::getFixedTimeStep() const
+{
+   return mSettings->getIniSettings()->fixedTimeStep;
+}
+
+
+U32 ServerGame::getSimulationOverruns() const
+{
+   return mSimulationOverruns;
+}
+
 
+// Advance the game by timeDelta ms -- returns false if the level changed or we started shutting down, in which case
+// there's no point in simulating any more time this tick
+bool ServerGame::simulate(U32 timeDelta)
+{
    mCurrentTime += timeDelta;
 
    for(S32 i = 0; i < getClientCount(); i++)
@@ -1489,6 +1788,9 @@ void ServerGame::idle(U32 timeDelta)
       // Clear all old bot moves, so that if the bot does nothing, it doesn't just continue with what it was doing before
       mRobotManager.clearMoves();
 
+      // As far as script CPU budgets are concerned, a tick lasts from one TickEvent to the next
+      LuaScriptRunner::beginTick();
+
       // Fire TickEvent, in case anyone is listening
       EventManager::get()->fireEvent(EventManager::TickEvent, botControlTickElapsed + timeDelta);
 
@@ -1497,6 +1799,8 @@ void ServerGame::idle(U32 timeDelta)
    
    const Vector<DatabaseObject *> *gameObjects = mGameObjDatabase->findObjects_fast();
 
+   mCollisionBroadphase.beginTick(mGameObjDatabase.get(), timeDelta);
+
    // Visit each game object, handling moves and running its idle method
    for(S32 i = gameObjects->size() - 1; i >= 0; i--)
    {
@@ -1514,11 +1818,15 @@ void ServerGame::idle(U32 timeDelta)
       obj->idle(BfObject::ServerIdleMainLoop);
    }
 
+   mCollisionBroadphase.endTick();
+
    if(mGameType)
       mGameType->idle(BfObject::ServerIdleMainLoop, timeDelta);
 
    processDeleteList(timeDelta);
 
+   bool levelChanged = false;
+
    // Load a new level if the time is out on the current one
    if(mLevelSwitchTimer.update(timeDelta))
    {
@@ -1544,6 +1852,8 @@ void ServerGame::idle(U32 timeDelta)
       getGameType()->updateRatings();
       cycleLevel(mNextLevel);
       mNextLevel = getSettings()->getIniSettings()->randomLevels ? +RANDOM_LEVEL : +NEXT_LEVEL;
+
+      levelChanged = true;
    }
 
    // The host could leave the game in a middle of next level upload, then we have to shut down
@@ -1552,14 +1862,14 @@ void ServerGame::idle(U32 timeDelta)
       mShutdownTimer.reset(1);
       mShuttingDown = true;
       mShutdownReason = "Host left game";
-      return;
+      return false;
    }
 
 
    if(mGameRecorderServer)
       mGameRecorderServer->idle(timeDelta);
 
-   mNetInterface->processConnections(); // Update to other clients right after idling everything else, so clients get more up to date information
+   return !levelChanged;
 }
 
 
@@ -1855,6 +2165,16 @@ bool ServerGame::startHosting()
 void ServerGame::gameEnded()
 {
    mLevelSwitchTimer.reset();
+
+   // Get a head start on the next level while the scores are up.  Not when hosting someone else's levels, though; they
+   // might still be uploading.
+   if(!mHostOnServer)
+   {
+      if(mNextLevel == RANDOM_LEVEL)      // Pick now, so we know which one to read
+         mNextLevel = getAbsoluteLevelIndex(mNextLevel);
+
+      preloadLevel(getAbsoluteLevelIndex(mNextLevel));
+   }
 }
 
 
@@ -1956,14 +2276,24 @@ LuaGameInfo *ServerGame::getGameInfo()
 ///// 
 //BotNavMeshZone management
 
+// The zones for a level that missed the nav mesh cache might still be on their way; see buildBotMeshZones()
+void ServerGame::waitForBotZones() const
+{
+   if(mBotZonesPending)
+      const_cast<ServerGame *>(this)->finishBotMeshZones();    // They're the zones we'd have had all along, so this is const enough
+}
+
+
 GridDatabase *ServerGame::getBotZoneDatabase() const
 {
+   waitForBotZones();
    return mBotZoneDatabase;
 }
 
 
 const Vector<BotNavMeshZone *> *ServerGame::getBotZones() const
 {
+   waitForBotZones();
    return &mAllZones;
 }
 
@@ -1971,6 +2301,8 @@ const Vector<BotNavMeshZone *> *ServerGame::getBotZones() const
 // Returns ID of zone containing specified point
 U16 ServerGame::findZoneContaining(const Point &p) const
 {
+   waitForBotZones();
+
    fillVector.clear();
    mBotZoneDatabase->findObjects(BotNavMeshZoneTypeNumber, fillVector,
                                 Rect(p - Point(0.1f, 0.1f), p + Point(0.1f, 0.1f)));  // Slightly extend Rect, it can be on the edge of zone
@@ -1991,6 +2323,95 @@ U16 ServerGame::findZoneContaining(const Point &p) const
 }
 
 
+// Returns a path between the zones for a robot headed for target, in the form AStar::findPath() gives it.  Robots all
+// share the paths we've found.
+Vector<Point> ServerGame::findBotPath(U16 startZone, U16 targetZone, const Point &target)
+{
+   waitForBotZones();
+
+   Vector<Point> path;
+   const Vector<Point> *cachedPath = mBotPathCache.find(startZone, targetZone);
+
+   if(cachedPath)
+      path = *cachedPath;
+   else
+   {
+      path = AStar::findPath(&mAllZones, startZone, targetZone, target, mBotPathContext, &mBotZoneClusters);
+      mBotPathCache.add(startZone, targetZone, path);
+   }
+
+   if(path.size() > 0)
+      path[0] = target;       // Cached paths end at the first asker's target; make this one end at ours
+
+   return path;
+}
+
+
+// Returns the flow field leading to targetZone, which all robots headed there share
+const BotFlowField *ServerGame::getBotFlowField(U16 targetZone)
+{
+   waitForBotZones();
+   return mBotFlowFields.get(&mAllZones, targetZone);
+}
+
+
+// Loads every level in levelSource and builds its bot zones, which leaves them in the nav mesh cache, ready for when
+// the server plays that level for real.  Static method.
+void ServerGame::buildBotNavMeshCaches(GameSettingsPtr settings, LevelSourcePtr levelSource)
+{
+   ServerGame *game = new ServerGame(Address(), settings, levelSource, false, true);
+
+   S32 built = 0, cached = 0, skipped = 0;
+
+   for(S32 i = 0; i < levelSource->getLevelCount(); i++)
+   {
+      string descr = levelSource->getLevelFileDescriptor(i);
+
+      game->cleanUp();
+      game->mRobotManager.onLevelChanged();
+      game->mCurrentLevelIndex = i;
+
+      if(!game->loadLevel())      // Will log the reason
+      {
+         skipped++;
+         continue;
+      }
+
+      game->computeWorldObjectExtents();
+
+      if(game->mLevelGens.size() > 0)
+      {
+         logprintf(LogConsumer::ServerFilter, "Skipping %s; it has a levelgen", descr.c_str());
+         skipped++;
+      }
+      else if(game->buildBotMeshZones())
+      {
+         logprintf(LogConsumer::ServerFilter, "Nav mesh for %s is already cached", descr.c_str());
+         cached++;
+      }
+      else
+      {
+         game->waitForBotZones();
+
+         if(game->getGameType()->mBotZoneCreationFailed)
+         {
+            logprintf(LogConsumer::LogWarning, "Could not build nav mesh for %s", descr.c_str());
+            skipped++;
+         }
+         else
+         {
+            logprintf(LogConsumer::ServerFilter, "Built nav mesh for %s", descr.c_str());
+            built++;
+         }
+      }
+   }
+
+   delete game;
+
+   logprintf(LogConsumer::ServerFilter, "Nav meshes: %d built, %d already cached, %d skipped", built, cached, skipped);
+}
+
+
 void ServerGame::setGameType(GameType *gameType)
 {
    Parent::setGameType(gameType);
@@ -2018,5 +2439,51 @@ GameRecorderServer *ServerGame::getGameRecorder()
 }
 
 
+CollisionBroadphase *ServerGame::getCollisionBroadphase()
+{
+   return &mCollisionBroadphase;
+}
+
+
+bool ServerGame::isTrackingScope() const
+{
+   return mScopeTracker.isActive();
+}
+
+
+// Bring what each player's ship can see up to date with what has moved, ahead of the connections writing their packets
+void ServerGame::updateScopes()
+{
+   if(!mScopeTracker.isActive())
+      return;
+
+   for(S32 i = 0; i < getClientCount(); i++)
+   {
+      ClientInfo *clientInfo = getClientInfo(i);
+
+      if(clientInfo->isRobot())
+         continue;
+
+      GameConnection *conn = clientInfo->getConnection();
+
+      if(!conn || !conn->isReadyForRegularGhosts())
+         continue;
+
+      Ship *ship = dynamic_cast<Ship *>(conn->getControlObject());
+
+      if(!ship)
+         continue;
+
+      Point pos = ship->getPos();
+      Rect range(pos, pos);
+      range.expand(getScopeRange(ship->hasModule(ModuleSensor)));
+
+      mScopeTracker.updateConnection(conn, range);
+   }
+
+   mScopeTracker.endUpdate();
+}
+
+
 };
 
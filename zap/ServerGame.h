@@ -9,8 +9,12 @@
 #include "game.h"                // Parent class
 
 #include "BotNavMeshZone.h"
+#include "BotPathCache.h"
+#include "CollisionBroadphase.h"
+#include "ScopeTracker.h"
 #include "dataConnection.h"
 #include "LevelSource.h"         // For LevelSourcePtr def
+#include "LevelPreloader.h"
 #include "LevelSpecifierEnum.h"
 #include "RobotManager.h"
 
@@ -64,6 +68,17 @@ private:
 
    bool mDedicated;
    S32 mLevelLoadIndex;                   // For keeping track of where we are in the level loading process.  NOT CURRENT LEVEL IN PLAY!
+   bool mLevelInfosPreloaded;             // True if mLevelSource has already read the info for all its levels
+
+   BotZoneClusters mBotZoneClusters;      // Rebuilt along with the zones, for planning long paths
+   BotPathCache mBotPathCache;            // Paths robots have asked for; cleared when the zones change
+   BotFlowFieldCache mBotFlowFields;      // Flow fields for zones robots are heading to; also cleared when the zones change
+   AStar::Context mBotPathContext;        // Scratch space for path searches
+
+   LevelPreloader mLevelPreloader;        // Reads the next level while the scoreboard is up
+   string mPreloadedNavMeshData;          // Nav mesh cache for the level we're loading, if the preloader found one
+   bool mBotZonesPending;                 // True while the preloader is triangulating this level's zones
+   string mPendingBotZonesCacheFile;      // Where to save them once they're done
 
    SafePtr<GameConnection> mSuspendor;    // Player requesting suspension if game suspended by request
    Timer mTimeToSuspend;
@@ -86,6 +101,14 @@ private:
    U32 mAccumulatedSleepTime;
 
    RobotManager mRobotManager;
+   CollisionBroadphase mCollisionBroadphase;    // Collision candidates for everything that moves, rebuilt every tick
+   ScopeTracker mScopeTracker;                  // What each player's ship can see, if IncrementalScoping is on
+
+   U32 mUnsimulatedTime;                  // In fixed-step mode, time that has passed but isn't yet a whole step
+   U32 mSimulationOverruns;               // Times we've fallen so far behind that we had to skip game time
+   U32 mUnreportedOverruns;               // Overruns, and game time they skipped, since we last logged them
+   U32 mUnreportedSkippedTime;
+   Timer mOverrunReportTimer;             // Keeps a server that's stuck behind from logging every tick
 
    Vector<LuaLevelGenerator *> mLevelGens;
    Vector<LuaLevelGenerator *> mLevelGenDeleteList;
@@ -96,6 +119,7 @@ private:
    void updateStatusOnMaster();           // Give master a status report for this server
    void processVoting(U32 timeDelta);     // Manage any ongoing votes
    void processSimulatedStutter(U32 timeDelta);
+   bool simulate(U32 timeDelta);          // Runs one step of the game simulation
 
    string getLevelFileNameFromIndex(S32 indx);
 
@@ -106,6 +130,11 @@ private:
 
    void cleanUp();
    bool loadLevel();                                  // Load the level pointed to by mCurrentLevelIndex
+   bool buildBotMeshZones();                          // Returns true if the zones came from the nav mesh cache
+   void finishBotMeshZones();
+   bool shouldTriangulateBotZones() const;
+   string getBotNavMeshCacheDir() const;
+   void preloadLevel(S32 levelIndex);
    void runLevelGenScript(const string &scriptName);  // Run any levelgens specified by the level or in the INI
 
    AbstractTeam *getNewTeam();
@@ -137,6 +166,8 @@ public:
 
    // These are public so this can be accessed by tests
    static const U32 MaxTimeDelta = TWO_SECONDS;     
+   static const U32 MaxCatchUpTime = 250;           // Most game time fixed-step mode will simulate in one idle
+   static const U32 OverrunReportInterval = TEN_SECONDS;
    static const U32 LevelSwitchTime = FIVE_SECONDS;
 
    U32 mVoteTimer;
@@ -209,6 +240,9 @@ public:
    bool getAutoLevelingEnabled() const;
    void setAutoLeveling(bool enabled);
 
+   void getLuaProfile(Vector<string> &lines, S32 maxFunctionsPerScript);
+   void resetLuaProfile();
+
    /////
 
    StringTableEntry getLevelNameFromIndex(S32 indx);
@@ -221,6 +255,8 @@ public:
 
    bool isServer() const;
    void idle(U32 timeDelta);
+   U32 getFixedTimeStep() const;                   // Step length from the INI, or 0 if steps follow the clock
+   U32 getSimulationOverruns() const;
    bool isReadyToShutdown(U32 timeDelta, string &shutdownReason);
    void gameEnded();
 
@@ -262,14 +298,23 @@ public:
 
    /////
    // BotNavMeshZone management
+   void waitForBotZones() const;                   // Anything that looks at the zones needs to call this first
    GridDatabase *getBotZoneDatabase() const;
    const Vector<BotNavMeshZone *> *getBotZones() const;
    U16 findZoneContaining(const Point &p) const;
+   Vector<Point> findBotPath(U16 startZone, U16 targetZone, const Point &target);   // From the path cache, if we can
+   const BotFlowField *getBotFlowField(U16 targetZone);
+
+   static void buildBotNavMeshCaches(GameSettingsPtr settings, LevelSourcePtr levelSource);   // For -buildnavmeshes
 
    void setGameType(GameType *gameType);
    void onObjectAdded(BfObject *obj);
    void onObjectRemoved(BfObject *obj);
    GameRecorderServer *getGameRecorder();
+   CollisionBroadphase *getCollisionBroadphase();
+
+   bool isTrackingScope() const;          // True if the scope tracker, not GameType, searches around players' ships
+   void updateScopes();
 
    friend class ObjectTest;
 };
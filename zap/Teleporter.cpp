@@ -181,6 +181,7 @@ void Teleporter::initialize(const Point &pos, const Point &dest, Ship *engineeri
 {
    mObjectTypeNumber = TeleporterTypeNumber;
    mNetFlags.set(Ghostable);
+   mNetFlags.set(SharesUpdates);
 
    mTime = 0;
    mTeleporterCooldown = TeleporterCooldown;    // Teleporters can have non-standard cooldown periods, but start with default
@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickScheduler.h"
+
+#include "tnlLog.h"
+
+
+namespace Zap
+{
+
+const U32 TickScheduler::MaxLateness = 250;
+const U32 TickScheduler::ReportInterval = 5 * 60 * 1000;
+
+
+TickScheduler::TickScheduler(U32 tickRate)
+{
+   mTickRate = tickRate > 0 ? tickRate : 1;
+   mStarted = false;
+   mStartTime = 0;
+   mTickCount = 0;
+   mLastTickTime = 0;
+
+   resetStats(0);
+}
+
+
+TickScheduler::~TickScheduler()
+{
+   // Do nothing
+}
+
+
+void TickScheduler::resetStats(U32 currentTime)
+{
+   mStatsStartTime = currentTime;
+   mStatsTicks = 0;
+   mStatsTotalLateness = 0;
+   mStatsMaxLateness = 0;
+   mStatsResyncs = 0;
+}
+
+
+void TickScheduler::setTickRate(U32 tickRate)
+{
+   if(tickRate == 0)
+      tickRate = 1;
+
+   if(tickRate == mTickRate)
+      return;
+
+   mTickRate = tickRate;
+
+   // Start a new schedule, counting from the last tick
+   mStartTime = mLastTickTime;
+   mTickCount = 0;
+}
+
+
+U32 TickScheduler::getTickRate() const
+{
+   return mTickRate;
+}
+
+
+U32 TickScheduler::getNextTickTime() const
+{
+   return mStartTime + U32(U64(mTickCount + 1) * 1000 / mTickRate);
+}
+
+
+U32 TickScheduler::getTimeUntilNextTick(U32 currentTime) const
+{
+   if(!mStarted)
+      return 0;
+
+   S32 timeLeft = S32(getNextTickTime() - currentTime);
+   return timeLeft > 0 ? U32(timeLeft) : 0;
+}
+
+
+U32 TickScheduler::beginTick(U32 currentTime)
+{
+   if(!mStarted)
+   {
+      mStarted = true;
+      mStartTime = currentTime;
+      mTickCount = 0;
+      mLastTickTime = currentTime - 1000 / mTickRate;    // As if there had been a tick right on time before this one
+      resetStats(currentTime);
+   }
+   else
+   {
+      S32 lateness = S32(currentTime - getNextTickTime());
+
+      if(lateness < 0)     // Early; we'll go with it, but the schedule stays put
+         lateness = 0;
+
+      if(U32(lateness) > MaxLateness)
+      {
+         // Too far behind to catch up without running a burst of back-to-back ticks; start over from here
+         mStartTime = currentTime;
+         mTickCount = 0;
+         mStatsResyncs++;
+      }
+      else
+      {
+         mTickCount++;
+
+         mStatsTicks++;
+         mStatsTotalLateness += lateness;
+         if(U32(lateness) > mStatsMaxLateness)
+            mStatsMaxLateness = lateness;
+      }
+
+      // Move the start of the schedule up every second, so mTickCount stays small.  1000 ms is exactly mTickRate ticks,
+      // so no deadlines move.
+      if(mTickCount >= mTickRate)
+      {
+         mStartTime += 1000;
+         mTickCount -= mTickRate;
+      }
+   }
+
+   U32 elapsed = currentTime - mLastTickTime;
+   mLastTickTime = currentTime;
+
+   return elapsed;
+}
+
+
+U32 TickScheduler::getTicks() const
+{
+   return mStatsTicks;
+}
+
+
+F32 TickScheduler::getMeanLateness() const
+{
+   return mStatsTicks > 0 ? F32(mStatsTotalLateness) / mStatsTicks : 0;
+}
+
+
+U32 TickScheduler::getMaxLateness() const
+{
+   return mStatsMaxLateness;
+}
+
+
+U32 TickScheduler::getResyncs() const
+{
+   return mStatsResyncs;
+}
+
+
+bool TickScheduler::isReportDue(U32 currentTime) const
+{
+   return mStarted && currentTime - mStatsStartTime >= ReportInterval;
+}
+
+
+void TickScheduler::logReport(U32 currentTime)
+{
+   logprintf(LogConsumer::ServerFilter, "Tick timing: %d ticks in %d secs at %d/sec; started %.2f ms late on average, "
+             "%d ms at worst; %d schedule resets", mStatsTicks, (currentTime - mStatsStartTime) / 1000, mTickRate,
+             getMeanLateness(), mStatsMaxLateness, mStatsResyncs);
+
+   resetStats(currentTime);
+}
+
+
+} /* namespace Zap */
@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TICK_SCHEDULER_H_
+#define _TICK_SCHEDULER_H_
+
+#include "tnlTypes.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Works out when game ticks are due, on a fixed schedule that doesn't drift, and keeps track of how closely we kept to
+// it.  Times are in ms, from Platform::getRealMilliseconds() or anything like it; it's fine for them to wrap.
+class TickScheduler
+{
+private:
+   U32 mTickRate;          // Ticks per second
+   bool mStarted;          // False until the first tick
+   U32 mStartTime;         // When tick 0 was due; deadlines are counted from here, so rounding never adds up
+   U32 mTickCount;         // Ticks since mStartTime
+   U32 mLastTickTime;      // When the last tick actually started
+
+   // Timing stats, since the last report
+   U32 mStatsStartTime;
+   U32 mStatsTicks;
+   U32 mStatsTotalLateness;
+   U32 mStatsMaxLateness;
+   U32 mStatsResyncs;
+
+   void resetStats(U32 currentTime);
+
+public:
+   static const U32 MaxLateness;       // If we fall further behind than this, start a new schedule
+   static const U32 ReportInterval;    // How often the server log hears about our timing
+
+   explicit TickScheduler(U32 tickRate = 100);     // Constructor
+   virtual ~TickScheduler();                       // Destructor
+
+   // A new rate takes effect from the last tick
+   void setTickRate(U32 tickRate);
+   U32 getTickRate() const;
+
+   U32 getNextTickTime() const;                       // When the next tick is due
+   U32 getTimeUntilNextTick(U32 currentTime) const;   // 0 if a tick is due now
+
+   // Call when starting a tick -- returns the time since the previous one started
+   U32 beginTick(U32 currentTime);
+
+   U32 getTicks() const;               // Ticks since the last report
+   F32 getMeanLateness() const;        // How long after its deadline the average tick started
+   U32 getMaxLateness() const;
+   U32 getResyncs() const;             // Number of times we fell so far behind we gave up on the schedule
+
+   bool isReportDue(U32 currentTime) const;
+   void logReport(U32 currentTime);    // Writes the stats to the server log, and starts collecting them anew
+};
+
+} /* namespace Zap */
+#endif
@@ -93,6 +93,8 @@ IniSettings::IniSettings()
 
    maxDedicatedFPS = 100;             // Max FPS on dedicated server
    maxFPS = 100;                      // Max FPS on client/non-dedicated server
+   fixedTimeStep = 0;                 // Server simulates in variable-length steps
+   incrementalScoping = false;        // Search each ship's whole scope range for every packet
 
    masterAddress = MASTER_SERVER_LIST_ADDRESS;   // Default address of our master server
    name = "";                         // Player name (none by default)
@@ -105,6 +107,8 @@ IniSettings::IniSettings()
    maxBots = 10;
    playWithBots = false;
    minBalancedPlayers = 6;
+   luaSoftBudget = 0;
+   luaHardBudget = 0;
    enableServerVoiceChat = true;
    allowTeamChanging = true;
    serverPassword = "";               // Passwords empty by default
@@ -647,6 +651,8 @@ static void loadHostConfiguration(CIniFile *ini, IniSettings *iniSettings)
    iniSettings->maxBots                = ini->GetValueI (section, "MaxBots", iniSettings->maxBots);
    iniSettings->playWithBots           = ini->GetValueYN(section, "AddRobots", iniSettings->playWithBots);
    iniSettings->minBalancedPlayers     = ini->GetValueI (section, "MinBalancedPlayers", iniSettings->minBalancedPlayers);
+   iniSettings->luaSoftBudget          = ini->GetValueF(section, "LuaSoftBudget", iniSettings->luaSoftBudget);
+   iniSettings->luaHardBudget          = ini->GetValueF(section, "LuaHardBudget", iniSettings->luaHardBudget);
    iniSettings->enableServerVoiceChat  = ini->GetValueYN (section, "EnableServerVoiceChat", iniSettings->enableServerVoiceChat);
 
    iniSettings->alertsVolLevel       = (F32) ini->GetValueI(section, "AlertsVolume", (S32) (iniSettings->alertsVolLevel * 10)) / 10.0f;
@@ -658,6 +664,10 @@ static void loadHostConfiguration(CIniFile *ini, IniSettings *iniSettings)
       iniSettings->maxDedicatedFPS = fps; 
    // TODO: else warn?
 
+   iniSettings->fixedTimeStep = (U32) max(ini->GetValueI(section, "FixedTimeStep", S32(iniSettings->fixedTimeStep)), 0);
+
+   iniSettings->incrementalScoping = ini->GetValueYN(section, "IncrementalScoping", iniSettings->incrementalScoping);
+
    iniSettings->logStats = ini->GetValueYN(section, "LogStats", iniSettings->logStats);
 
    //iniSettings->SendStatsToMaster = (lcase(ini->GetValue(section, "SendStatsToMaster", "yes")) != "no");
@@ -1784,9 +1794,17 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
       addComment(" MaxBots - The max number of bots allowed on this server.");
       addComment(" AddRobots - Add robot players to this server.");
       addComment(" MinBalancedPlayers - The minimum number of players ensured in each map.  Bots will be added up to this number.");
+      addComment(" LuaSoftBudget - ms of CPU a robot or levelgen script can use in one bot tick; a script that uses more sits out its next");
+      addComment("                 tick, and a warning is logged.  0 means no limit (default = 0).");
+      addComment(" LuaHardBudget - ms a single call into a robot or levelgen script can run before it is stopped and the script sits out");
+      addComment("                 its next tick.  Turns off the LuaJIT compiler, so scripts run slower.  0 means no limit (default = 0).");
       addComment(" EnableServerVoiceChat - If false, prevents any voice chat in a server.");
       addComment(" AlertsVolume - Volume of audio alerts when players join or leave game from 0 (mute) to 10 (full bore).");
       addComment(" MaxFPS - Maximum FPS the dedicaetd server will run at.  Higher values use more CPU, lower may increase lag (default = 100).");
+      addComment(" FixedTimeStep - Simulate the game in steps of exactly this many ms, catching up after stalls (e.g. 16).  0 simulates");
+      addComment("                 however much time has passed since the last frame (default = 0).");
+      addComment(" IncrementalScoping - Work out what each player can see from what has moved, rather than searching around every");
+      addComment("                      player's ship for every packet.  Experimental (default = No).");
       addComment(" RandomLevels - When current level ends, this can enable randomly switching to any available levels.");
       addComment(" SkipUploads - When current level ends, enables skipping all uploaded levels.");
       addComment(" AllowGetMap - When getmap is allowed, anyone can download the current level using the /getmap command.");
@@ -1816,12 +1834,16 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
    ini->SetValueI (section, "MaxBots", iniSettings->maxBots);
    ini->setValueYN(section, "AddRobots", iniSettings->playWithBots);
    ini->SetValueI (section, "MinBalancedPlayers", iniSettings->minBalancedPlayers);
+   ini->SetValueF (section, "LuaSoftBudget", iniSettings->luaSoftBudget);
+   ini->SetValueF (section, "LuaHardBudget", iniSettings->luaHardBudget);
    ini->setValueYN(section, "EnableServerVoiceChat", iniSettings->enableServerVoiceChat);
    ini->setValueYN(section, "AllowTeamChanging", iniSettings->allowTeamChanging);
    ini->SetValueI (section, "AlertsVolume", (S32) (iniSettings->alertsVolLevel * 10));
    ini->setValueYN(section, "AllowGetMap", iniSettings->allowGetMap);
    ini->setValueYN(section, "AllowDataConnections", iniSettings->allowDataConnections);
    ini->SetValueI (section, "MaxFPS", iniSettings->maxDedicatedFPS);
+   ini->SetValueI (section, "FixedTimeStep", iniSettings->fixedTimeStep);
+   ini->setValueYN(section, "IncrementalScoping", iniSettings->incrementalScoping);
    ini->setValueYN(section, "LogStats", iniSettings->logStats);
 
    ini->setValueYN(section, "RandomLevels", S32(iniSettings->randomLevels) );
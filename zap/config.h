@@ -200,6 +200,8 @@ public:
 
    U32 maxDedicatedFPS;
    U32 maxFPS;
+   U32 fixedTimeStep;               // Length of each server simulation step in ms, or 0 to simulate however much time has passed
+   bool incrementalScoping;         // Keep scope up to date from object movement rather than searching every packet
 
 
    string masterAddress;            // Default address of our master server
@@ -222,6 +224,8 @@ public:
    S32 maxBots;
    bool playWithBots;               // Should the server add bots
    S32 minBalancedPlayers;          // If bot auto-balance, make sure there are at least this many players
+   F32 luaSoftBudget;               // ms of CPU a robot or levelgen can use per tick before sitting out the next, 0 for no limit
+   F32 luaHardBudget;               // ms a single script call can run before it's stopped, 0 for no limit
    bool enableServerVoiceChat;      // No voice chat allowed in server if disabled
    bool allowTeamChanging;
    bool enableGameRecording;
@@ -38,7 +38,7 @@ ControlObjectConnection::ControlObjectConnection()
 // Destructor
 ControlObjectConnection::~ControlObjectConnection()
 {
-   // Do nothing
+   clearAllPacketNotifies();     // Parent destructors can't free our GamePacketNotifies
 }
 
 
@@ -120,9 +120,27 @@ void ControlObjectConnection::addPendingMove(Move *theMove)
 
 
 
+ClassChunker<ControlObjectConnection::GamePacketNotify> ControlObjectConnection::mPacketNotifyChunker;
+
 ControlObjectConnection::PacketNotify *ControlObjectConnection::allocNotify()
 {
-   return new GamePacketNotify;
+   return mPacketNotifyChunker.alloc();
+}
+
+
+void ControlObjectConnection::freeNotify(PacketNotify *notify)
+{
+   mPacketNotifyChunker.free(static_cast<GamePacketNotify *>(notify));
+}
+
+
+// Logs how many of each kind of pooled packet record are in use; helps spot leaks on long-running servers
+void ControlObjectConnection::logPoolUsage()
+{
+   Parent::logPoolUsage();
+
+   logprintf(LogConsumer::LogNetBase, "GamePacketNotify pool - In use: %d   Pooled: %d", 
+             mPacketNotifyChunker.getAllocatedCount(), mPacketNotifyChunker.getPooledCount());
 }
 
 static U8 CLIENTCONTROLBITS = 16;
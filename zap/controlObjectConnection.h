@@ -75,6 +75,8 @@ public:
    ControlObjectConnection();
    virtual ~ControlObjectConnection();
 
+   static void logPoolUsage();
+
    void setControlObject(BfObject *theObject);
    BfObject *getControlObject() const;
    U32 getControlCRC();
@@ -88,7 +90,10 @@ public:
       GamePacketNotify();
    };
 
+   static ClassChunker<GamePacketNotify> mPacketNotifyChunker;    // Pool for our PacketNotifies
+
    PacketNotify *allocNotify();
+   void freeNotify(PacketNotify *notify);
 
    void writePacket(BitStream *bstream, PacketNotify *notify);
    void readPacket(BitStream *bstream);
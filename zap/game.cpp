@@ -78,6 +78,9 @@ Game::Game(const Address &theBindAddress, GameSettingsPtr settings) : mGameObjDa
    mLevelDatabaseId = 0;
    mSettings = settings;
 
+   // Size the game's spatial grid to each level as it loads, rather than wrapping everything onto a fixed 16x16 grid
+   mGameObjDatabase->setBucketMode(GridDatabase::LevelBuckets);
+
    mNextMasterTryTime = 0;
    mReadyToConnectToMaster = false;
 
@@ -1170,6 +1173,7 @@ void Game::deleteObjects(TestFunc testFunc)
 void Game::computeWorldObjectExtents()
 {
    mWorldExtents = mGameObjDatabase->getExtents();
+   mGameObjDatabase->fitBucketsToExtents(mWorldExtents);
 }
 
 
@@ -82,6 +82,7 @@ GameType::GameType(S32 winningScore) : mScoreboardUpdateTimer(THREE_SECONDS), mG
    mLevelHasPredeployedFlags = false;
    mLevelHasFlagSpawns = false;
    mShowAllBots = false;
+   mScopeTick = 1;
    mHaveSoccer = false;
    mBotZoneCreationFailed = false;
 
@@ -537,19 +538,14 @@ void GameType::idle(BfObject::IdleCallPath path, U32 deltaT)
 
 void GameType::idle_server(U32 deltaT)
 {
+   mScopeTick++;        // Things have moved; team scopes need rebuilding
    queryItemsOfInterest();
 
    bool needsScoreboardUpdate = mScoreboardUpdateTimer.update(deltaT);
 
    if(needsScoreboardUpdate)
-   {
       mScoreboardUpdateTimer.reset();
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         updateClientScoreboard(gc);
-   }
-
    for(S32 i = 0; i < mGame->getClientCount(); i++)
    {
       ClientInfo *clientInfo = mGame->getClientInfo(i);
@@ -570,10 +566,6 @@ void GameType::idle_server(U32 deltaT)
                if(clientInfo->getPing() > MaxPing || conn->lostContact())
                   clientInfo->setPing(MaxPing);
             }
-
-            // Send scores/pings to client if game is over, or client has requested them
-            if(mGameOver || conn->wantsScoreboardUpdates())
-               updateClientScoreboard(clientInfo->getConnection());
          }
 
          if(getGame()->getSettings()->getIniSettings()->allowTeamChanging)
@@ -591,6 +583,9 @@ void GameType::idle_server(U32 deltaT)
    }
 
 
+   if(needsScoreboardUpdate)
+      broadcastScoreboard();
+
    // Periodically send time-remaining updates to the clients to keep everyone in sync
    if(mGameTimeUpdateTimer.update(deltaT))
    {
@@ -1331,6 +1326,59 @@ static void markAllMountedItemsAsBeingInScope(Ship *ship, GameConnection *conn)
 }
 
 
+struct SpyBugScope
+{
+   GameConnection *connection;      // Objects seen go straight into this connection's scope...
+   DatabaseQuery *query;            // ...or, if connection is NULL, into this
+   Point pos;
+};
+
+
+// Visitor for performScopeQuery -- puts objects within a spy bug's hexagon in scope
+static bool scopeObjectSeenBySpyBug(DatabaseObject *object, void *context)
+{
+   SpyBugScope *scope = static_cast<SpyBugScope *>(context);
+   BfObject *obj = static_cast<BfObject *>(object);
+
+   // Some objects don't have geometry (ForceFields).  Is this a bug?
+   if(!obj->hasGeometry())
+      return true;
+
+   if(!pointInHexagon(obj->getPos(), scope->pos, SpyBug::SPY_BUG_RADIUS))
+      return true;
+
+   if(!scope->connection)
+   {
+      if(scope->query->markVisited(obj))     // Bugs can overlap
+         scope->query->addResult(obj);
+
+      return true;
+   }
+
+   scope->connection->objectInScope(obj);
+   if(isShipType(obj->getObjectTypeNumber()))
+      markAllMountedItemsAsBeingInScope(static_cast<Ship *>(obj), scope->connection);
+
+   return true;
+}
+
+
+static void putInScope(const Vector<SafePtr<BfObject> > &objects, GameConnection *connection)
+{
+   for(S32 i = 0; i < objects.size(); i++)
+   {
+      BfObject *obj = objects[i];
+
+      if(!obj)
+         continue;
+
+      connection->objectInScope(obj);
+      if(isShipType(obj->getObjectTypeNumber()))
+         markAllMountedItemsAsBeingInScope(static_cast<Ship *>(obj), connection);
+   }
+}
+
+
 // Runs only on server, I think
 void GameType::performScopeQuery(GhostConnection *connection)
 {
@@ -1362,8 +1410,14 @@ void GameType::performScopeQuery(GhostConnection *connection)
       conn->objectInScope(co);            // Put controlObject in scope ==> This is where the update mask gets set to 0xFFFFFFFF
    }
 
-   // What does the spy bug see?
-   bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
+   // What does the spy bug see?  In team games, everyone on a team sees the same bugs, so we can share the work.
+   TeamScope *teamScope = isTeamGame() ? getTeamScope(clientInfo->getTeamIndex()) : NULL;
+
+   if(teamScope)
+   {
+      putInScope(getTeamSpyBugObjects(teamScope, clientInfo->getTeamIndex()), conn);
+      return;
+   }
 
    const Vector<DatabaseObject *> *spyBugs = mGame->getGameObjDatabase()->findObjects_fast(SpyBugTypeNumber);
    const Point scopeRange(SpyBug::SPY_BUG_RADIUS, SpyBug::SPY_BUG_RADIUS * FloatSqrt3Half);  // Bounding box of hexagon
@@ -1374,30 +1428,119 @@ void GameType::performScopeQuery(GhostConnection *connection)
 
       if(sb->isVisibleToPlayer(clientInfo, isTeamGame()))
       {
-         Point pos = sb->getActualPos();
-         Rect queryRect(pos, pos);
+         SpyBugScope scope;
+         scope.connection = conn;
+         scope.query = NULL;
+         scope.pos = sb->getActualPos();
 
+         Rect queryRect(scope.pos, scope.pos);
          queryRect.expand(scopeRange);
 
-         fillVector.clear();
-         mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect, sameQuery);
-         sameQuery = true;
+         mGame->getGameObjDatabase()->visitObjects((TestFunc)isAnyObjectType, queryRect, scopeObjectSeenBySpyBug, &scope);
+      }
+   }
+}
 
-         for(S32 j = 0; j < fillVector.size(); j++)
-         {
-            // Some objects don't have geometry (ForceFields).  Is this a bug?
-            if(!fillVector[j]->hasGeometry())
-               continue;
 
-            if(!pointInHexagon(fillVector[j]->getPos(), pos, SpyBug::SPY_BUG_RADIUS))
-               continue;
+// Constructor
+GameType::TeamScope::TeamScope()
+{
+   cmdrsMapTick = 0;
+   spyBugTick = 0;
+}
+
 
-            connection->objectInScope(static_cast<BfObject *>(fillVector[j]));
-            if(isShipType(fillVector[j]->getObjectTypeNumber()))
-               markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[j]), conn);
-         }
+// Returns NULL if teamIndex isn't a real team
+GameType::TeamScope *GameType::getTeamScope(S32 teamIndex)
+{
+   if(teamIndex < 0 || teamIndex >= mGame->getTeamCount())
+      return NULL;
+
+   if(mTeamScopes.size() < mGame->getTeamCount())
+      mTeamScopes.resize(mGame->getTeamCount());
+
+   return &mTeamScopes[teamIndex];
+}
+
+
+// Everything that any of the team's ships can see on the commander's map
+const Vector<SafePtr<BfObject> > &GameType::getTeamCmdrsMapObjects(TeamScope *teamScope, S32 teamIndex)
+{
+   if(teamScope->cmdrsMapTick == mScopeTick)
+      return teamScope->cmdrsMapObjects;
+
+   mTeamScopeQuery.clear();
+
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
+   {
+      ClientInfo *clientInfo = mGame->getClientInfo(i);
+
+      if(clientInfo->getTeamIndex() != teamIndex)      // Wrong team
+         continue;
+
+      Ship *ship = clientInfo->getShip();
+      if(!ship)       // Can happen!
+         continue;
+
+      Rect queryRect(ship->getActualPos(), ship->getActualPos());
+      queryRect.expand(mGame->getScopeRange(ship->hasModule(ModuleSensor)));
+
+      TestFunc testFunc = ship->hasModule(ModuleSensor) ? &isVisibleOnCmdrsMapWithSensorType : &isVisibleOnCmdrsMapType;
+
+      // mTeamScopeQuery won't return objects already found for another teammate
+      mGame->getGameObjDatabase()->findObjects(testFunc, mTeamScopeQuery, queryRect);
+   }
+
+   const Vector<DatabaseObject *> &found = mTeamScopeQuery.getResults();
+
+   teamScope->cmdrsMapObjects.resize(found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      teamScope->cmdrsMapObjects[i] = static_cast<BfObject *>(found[i]);
+
+   teamScope->cmdrsMapTick = mScopeTick;
+
+   return teamScope->cmdrsMapObjects;
+}
+
+
+// Everything the spy bugs the team can see are watching
+const Vector<SafePtr<BfObject> > &GameType::getTeamSpyBugObjects(TeamScope *teamScope, S32 teamIndex)
+{
+   if(teamScope->spyBugTick == mScopeTick)
+      return teamScope->spyBugObjects;
+
+   mTeamScopeQuery.clear();
+
+   const Vector<DatabaseObject *> *spyBugs = mGame->getGameObjDatabase()->findObjects_fast(SpyBugTypeNumber);
+   const Point scopeRange(SpyBug::SPY_BUG_RADIUS, SpyBug::SPY_BUG_RADIUS * FloatSqrt3Half);  // Bounding box of hexagon
+
+   for(S32 i = spyBugs->size()-1; i >= 0; i--)
+   {
+      SpyBug *sb = static_cast<SpyBug *>(spyBugs->get(i));
+
+      if(sb->isVisibleToPlayer(teamIndex, true))
+      {
+         SpyBugScope scope;
+         scope.connection = NULL;
+         scope.query = &mTeamScopeQuery;
+         scope.pos = sb->getActualPos();
+
+         Rect queryRect(scope.pos, scope.pos);
+         queryRect.expand(scopeRange);
+
+         mGame->getGameObjDatabase()->visitObjects((TestFunc)isAnyObjectType, queryRect, scopeObjectSeenBySpyBug, &scope);
       }
    }
+
+   const Vector<DatabaseObject *> &found = mTeamScopeQuery.getResults();
+
+   teamScope->spyBugObjects.resize(found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      teamScope->spyBugObjects[i] = static_cast<BfObject *>(found[i]);
+
+   teamScope->spyBugTick = mScopeTick;
+
+   return teamScope->spyBugObjects;
 }
 
 
@@ -1423,65 +1566,52 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
    //   }
    //}
 
-   // If we're in commander's map mode, then we can see what our teammates can see.  
-   // This will also scope what we can see.
-
    GameConnection *connection = clientInfo->getConnection();
    TNLAssert(connection, "NULL gameConnection!");
 
-   if(isTeamGame() && connection->isInCommanderMap())
-   {
-      S32 teamId = clientInfo->getTeamIndex();
-      fillVector.clear();
-      bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
-
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-      {
-         ClientInfo *clientInfo = mGame->getClientInfo(i);
+   mScopeQuery.clear();
 
-         if(clientInfo->getTeamIndex() != teamId)      // Wrong team
-            continue;
+   // Start with a simple query of the objects within scope range of the ship
+   // Note that if we make mine visibility controlled by server, here's where we'd put the code
+   Point pos = scopeObject->getPos();
+   TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object not a ship!");
+   Ship *co = static_cast<Ship *>(scopeObject);
 
-         Ship *ship = clientInfo->getShip();
-         if(!ship)       // Can happen!
-            continue;
+   // Unless the ServerGame is keeping what's around our ship in scope as things move
+   if(!static_cast<ServerGame *>(mGame)->isTrackingScope())
+   {
+      Rect queryRect(pos, pos);
+      queryRect.expand( mGame->getScopeRange(co->hasModule(ModuleSensor)) );
 
-         Rect queryRect(ship->getActualPos(), ship->getActualPos());
-         queryRect.expand(mGame->getScopeRange(ship->hasModule(ModuleSensor)));
+      mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, mScopeQuery, queryRect);
+   }
 
-         TestFunc testFunc;
-         if(scopeObject == ship)    
-            testFunc = &isAnyObjectType;
-         else
-            if(ship && ship->hasModule(ModuleSensor))
-               testFunc = &isVisibleOnCmdrsMapWithSensorType;
-            else     // No sensor
-               testFunc = &isVisibleOnCmdrsMapType;
+   // If we're in commander's map mode, then we can also see what our teammates can see
+   TeamScope *teamScope = NULL;
+   if(isTeamGame() && connection->isInCommanderMap())
+      teamScope = getTeamScope(clientInfo->getTeamIndex());
 
-         mGame->getGameObjDatabase()->findObjects(testFunc, fillVector, queryRect, sameQuery);
-         sameQuery = true;
-      }
-   }
-   else     // Not a team game OR not in commander's map -- Do a simple query of the objects within scope range of the ship
+   if(teamScope)
    {
-      // Note that if we make mine visibility controlled by server, here's where we'd put the code
-      Point pos = scopeObject->getPos();
-      TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object not a ship!");
-      Ship *co = static_cast<Ship *>(scopeObject);
+      const Vector<SafePtr<BfObject> > &teamObjects = getTeamCmdrsMapObjects(teamScope, clientInfo->getTeamIndex());
 
-      Rect queryRect(pos, pos);
-      queryRect.expand( mGame->getScopeRange(co->hasModule(ModuleSensor)) );
+      for(S32 i = 0; i < teamObjects.size(); i++)
+      {
+         BfObject *obj = teamObjects[i];
 
-      fillVector.clear();
-      mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
+         if(obj && mScopeQuery.markVisited(obj))      // Skip what our ship already found
+            mScopeQuery.addResult(obj);
+      }
    }
 
    // Set object-in-scope for all objects found above
-   for(S32 i = 0; i < fillVector.size(); i++)
+   const Vector<DatabaseObject *> &found = mScopeQuery.getResults();
+
+   for(S32 i = 0; i < found.size(); i++)
    {
-      connection->objectInScope(static_cast<BfObject *>(fillVector[i]));
-      if(isShipType(fillVector[i]->getObjectTypeNumber()))
-         markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[i]), connection);
+      connection->objectInScope(static_cast<BfObject *>(found[i]));
+      if(isShipType(found[i]->getObjectTypeNumber()))
+         markAllMountedItemsAsBeingInScope(static_cast<Ship *>(found[i]), connection);
    }
 
    // Make bots visible if showAllBots has been activated
@@ -2648,6 +2778,64 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cAddWalls, (Vector<F32> verts, F32 width
 }
 
 
+// /luaprof on|off|reset turns the Lua profiler on or off, or starts it over; /luaprof on its own shows what it has found
+void GameType::processLuaProfCommand(ClientInfo *clientInfo, const Vector<StringPtr> &args)
+{
+   static const S32 MaxFunctionsPerScript = 5;
+   static const S32 MaxLinesShown = 30;      // The full report goes to the log
+
+   ServerGame *serverGame = static_cast<ServerGame *>(mGame);
+   GameConnection *conn = clientInfo->getConnection();
+
+   if(args.size() > 0)
+   {
+      const char *arg = args[0].getString();
+
+      if(stricmp(arg, "on") == 0 || stricmp(arg, "off") == 0)
+      {
+         LuaScriptRunner::setProfiling(stricmp(arg, "on") == 0);
+         serverGame->resetLuaProfile();
+         conn->s2cDisplayMessage(0, 0, LuaScriptRunner::isProfiling() ? "Lua profiling on" : "Lua profiling off");
+      }
+      else if(stricmp(arg, "reset") == 0)
+      {
+         serverGame->resetLuaProfile();
+         conn->s2cDisplayMessage(0, 0, "Lua profile reset");
+      }
+      else
+         conn->s2cDisplayErrorMessage("!!! Usage: /luaprof [on|off|reset]");
+
+      return;
+   }
+
+   Vector<string> lines;
+   serverGame->getLuaProfile(lines, LuaScriptRunner::isProfiling() ? MaxFunctionsPerScript : 0);
+
+   if(lines.size() == 0)
+   {
+      conn->s2cDisplayMessage(0, 0, "No scripts are running");
+      return;
+   }
+
+   logprintf(LogConsumer::ServerFilter, "Lua profile requested by %s:", clientInfo->getName().getString());
+
+   Vector<StringTableEntry> message;
+
+   for(S32 i = 0; i < lines.size(); i++)
+   {
+      logprintf(LogConsumer::ServerFilter, "   %s", lines[i].c_str());
+
+      if(i < MaxLinesShown)
+         message.push_back(lines[i].c_str());
+   }
+
+   if(lines.size() > MaxLinesShown)
+      message.push_back("... see the server log for the rest");
+
+   conn->s2cDisplayMessageBox("Lua Profile", "Press [[Esc]] to continue", message);
+}
+
+
 extern void writeServerBanList(CIniFile *ini, BanList *banList);
 
 // Runs the server side commands, which the client may or may not know about
@@ -2691,6 +2879,13 @@ void GameType::processServerCommand(ClientInfo *clientInfo, const char *cmd, Vec
       else
          clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
    }
+   else if(stricmp(cmd, "luaprof") == 0)
+   {
+      if(clientInfo->isAdmin())
+         processLuaProfCommand(clientInfo, args);
+      else
+         clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
+   }
    else
       clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Invalid Command");
 }
@@ -2702,6 +2897,8 @@ bool GameType::canClientAddBots(GameConnection *conn, bool checkDefaultBot)
    GameSettings *settings = getGame()->getSettings();
    S32 maxBots = RobotManager::getMaxBots(settings, clientInfo->isAdmin());
 
+   static_cast<ServerGame *>(getGame())->waitForBotZones();    // So we know whether they worked
+
    if(mBotZoneCreationFailed)
       conn->s2cDisplayErrorMessage("!!! Bots are disabled because zone creation failed for this level");
 
@@ -3340,17 +3537,7 @@ void GameType::sendPrivateChat(const StringTableEntry &senderName, const StringT
 // Send private chat from Controller
 void GameType::sendAnnouncementFromController(const StringPtr &message)
 {
-   for(S32 i = 0; i < mGame->getClientCount(); i++)
-   {
-      ClientInfo *clientInfo = mGame->getClientInfo(i);
-
-      if(clientInfo->isRobot())
-         continue;
-
-      RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayAnnouncement, (message.getString()));
-
-      clientInfo->getConnection()->postNetEvent(theEvent);
-   }
+   broadcastNetEvent(TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayAnnouncement, (message.getString())));
 }
 
 
@@ -3372,27 +3559,17 @@ GAMETYPE_RPC_C2S(GameType, c2sSendChatSTE, (bool global, StringTableEntry messag
 // Note that sender may be NULL, if the message has been sent by a LevelController script
 void GameType::sendChat(const StringTableEntry &senderName, ClientInfo *senderClientInfo, const StringPtr &message, bool global, S32 teamIndex)
 {
-   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayChatMessage, (global, senderName, message));
-
-   for(S32 i = 0; i < mGame->getClientCount(); i++)
-   {
-      ClientInfo *clientInfo = mGame->getClientInfo(i);
+   NetEvent *theEvent = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayChatMessage, (global, senderName, message));
 
-      if(global || clientInfo->getTeamIndex() == teamIndex)
-      {
-         if(clientInfo->getConnection())
-            clientInfo->getConnection()->postNetEvent(theEvent);
-      }
-   }
+   if(global)
+      broadcastNetEvent(theEvent);
+   else
+      broadcastNetEventToTeam(theEvent, teamIndex);
 
    // And fire an event handler...
    // But don't add event if called by robot - it is already called in Robot::globalMsg/teamMsg
    if(senderClientInfo && !senderClientInfo->isRobot())
       EventManager::get()->fireEvent(NULL, EventManager::MsgReceivedEvent, message, senderClientInfo->getPlayerInfo(), global);
-
-   GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-   if(gc)
-      gc->postNetEvent(theEvent);
 }
 
 
@@ -3578,9 +3755,11 @@ GAMETYPE_RPC_C2S(GameType, c2sSelectWeapon, (RangedU32<0, ShipWeaponCount> indx)
 Vector<RangedU32<0, GameType::MaxPing> > GameType::mPingTimes; ///< Static vector used for constructing update RPCs
 Vector<SignedInt<24> > GameType::mScores;
 Vector<SignedFloat<8> > GameType::mRatings;  // 8 bits for 255 gradations between -1 and 1 ~ about 1 value per .01
+Vector<EventConnection *> GameType::mBroadcastConnections;
 
 
-void GameType::updateClientScoreboard(GameConnection *gc)
+// Fills mPingTimes and mRatings for s2cScoreboardUpdate
+void GameType::buildScoreboard()
 {
    mPingTimes.clear();
    mScores.clear();
@@ -3599,6 +3778,12 @@ void GameType::updateClientScoreboard(GameConnection *gc)
       // Players rating = cumulative score / total score played while this player was playing, ranks from 0 to 1
       mRatings.push_back(info->getCalculatedRating());
    }
+}
+
+
+void GameType::updateClientScoreboard(GameConnection *gc)
+{
+   buildScoreboard();
 
    NetObject::setRPCDestConnection(gc);
    s2cScoreboardUpdate(mPingTimes, mRatings);
@@ -3606,6 +3791,20 @@ void GameType::updateClientScoreboard(GameConnection *gc)
 }
 
 
+static bool wantsScoreboard(ClientInfo *clientInfo, void *gameOver)
+{
+   return *(bool *)gameOver || clientInfo->getConnection()->wantsScoreboardUpdates();
+}
+
+
+// Send scores and pings to everyone who has asked for them, or everyone if the game is over, and to the recording
+void GameType::broadcastScoreboard()
+{
+   buildScoreboard();
+   broadcastNetEvent(TNL_RPC_CONSTRUCT_NETEVENT(this, s2cScoreboardUpdate, (mPingTimes, mRatings)), wantsScoreboard, &mGameOver);
+}
+
+
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cScoreboardUpdate,
                  (Vector<RangedU32<0, GameType::MaxPing> > pingTimes, Vector<SignedFloat<8> > ratings),
                  (pingTimes, ratings), NetClassGroupGameMask, RPCGuaranteedOrderedBigData, RPCToGhost, 0)
@@ -3662,6 +3861,23 @@ GAMETYPE_RPC_S2C(GameType, s2cKillMessage, (StringTableEntry victim, StringTable
 }
 
 
+struct VoiceChatListeners
+{
+   GameConnection *source;
+   S32 teamIndex;
+   bool echo;
+};
+
+
+static bool isVoiceChatListener(ClientInfo *clientInfo, void *context)
+{
+   VoiceChatListeners *listeners = (VoiceChatListeners *)context;
+   GameConnection *dest = clientInfo->getConnection();
+
+   return dest->mVoiceChatEnabled && clientInfo->getTeamIndex() == listeners->teamIndex && (dest != listeners->source || listeners->echo);
+}
+
+
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sVoiceChat, (bool echo, ByteBufferPtr voiceBuffer), (echo, voiceBuffer),
    NetClassGroupGameMask, RPCUnguaranteed, RPCToGhostParent, 0)
 {
@@ -3676,20 +3892,10 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sVoiceChat, (bool echo, ByteBufferPtr vo
 
    if(source)
    {
-      RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cVoiceChat, (sourceClientInfo->getName(), voiceBuffer));
-
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-      {
-         ClientInfo *clientInfo = mGame->getClientInfo(i);
-         GameConnection *dest = clientInfo->getConnection();
-
-         if(dest && dest->mVoiceChatEnabled && clientInfo->getTeamIndex() == sourceClientInfo->getTeamIndex() && (dest != source || echo))
-            dest->postNetEvent(event);
-      }
+      VoiceChatListeners listeners = { source, sourceClientInfo->getTeamIndex(), echo };
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         gc->postNetEvent(event);
+      broadcastNetEvent(TNL_RPC_CONSTRUCT_NETEVENT(this, s2cVoiceChat, (sourceClientInfo->getName(), voiceBuffer)), 
+                        isVoiceChatListener, &listeners);
    }
 }
 
@@ -3977,20 +4183,65 @@ const Vector<WallRec> *GameType::getBarrierList()
 }
 
 
-// Send a message to all clients
-void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &message)
+// Fills mBroadcastConnections with the players filter accepts (everyone if filter is NULL), and the game recorder
+void GameType::findBroadcastConnections(ClientFilter filter, void *context)
 {
-   if(!isGameOver())  // Avoid flooding messages on game over.
+   mBroadcastConnections.clear();
+
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
    {
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-         if(!mGame->getClientInfo(i)->isRobot())
-            mGame->getClientInfo(i)->getConnection()->s2cDisplayMessage(color, sfx, message);
+      ClientInfo *clientInfo = mGame->getClientInfo(i);
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         gc->s2cDisplayMessage(color, sfx, message);
+      if(clientInfo->isRobot() || !clientInfo->getConnection())
+         continue;
+
+      if(!filter || filter(clientInfo, context))
+         mBroadcastConnections.push_back(clientInfo->getConnection());
    }
 
+   GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
+   if(gc)
+      mBroadcastConnections.push_back(gc);
+}
+
+
+// Send theEvent to every player filter accepts, or everyone if filter is NULL, and to the game recorder
+void GameType::broadcastNetEvent(NetEvent *theEvent, ClientFilter filter, void *context)
+{
+   RefPtr<NetEvent> event = theEvent;     // Cleans up if there's nobody to send it to
+
+   findBroadcastConnections(filter, context);
+   EventConnection::broadcastNetEvent(theEvent, mBroadcastConnections);
+}
+
+
+static bool isOnTeam(ClientInfo *clientInfo, void *teamIndex)
+{
+   return clientInfo->getTeamIndex() == *(S32 *)teamIndex;
+}
+
+
+void GameType::broadcastNetEventToTeam(NetEvent *theEvent, S32 teamIndex)
+{
+   broadcastNetEvent(theEvent, isOnTeam, &teamIndex);
+}
+
+
+// Send a message to all clients
+void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &message)
+{
+   if(isGameOver())   // Avoid flooding messages on game over
+      return;
+
+   findBroadcastConnections();
+
+   // GameConnection RPCs need a connection to construct them
+   if(mBroadcastConnections.size() > 0)
+   {
+      GameConnection *conn = static_cast<GameConnection *>(mBroadcastConnections[0]);
+      EventConnection::broadcastNetEvent(TNL_RPC_CONSTRUCT_NETEVENT(conn, s2cDisplayMessage, (color, sfx, message)), 
+                                         mBroadcastConnections);
+   }
 }
 
 
@@ -3998,15 +4249,16 @@ void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles
 void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, 
                                 const StringTableEntry &formatString, const Vector<StringTableEntry> &e)
 {
-   if(!isGameOver())  // Avoid flooding messages on game over
-   {
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-         if(!mGame->getClientInfo(i)->isRobot())
-            mGame->getClientInfo(i)->getConnection()->s2cDisplayMessageE(color, sfx, formatString, e);
+   if(isGameOver())   // Avoid flooding messages on game over
+      return;
+
+   findBroadcastConnections();
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         gc->s2cDisplayMessageE(color, sfx, formatString, e);
+   if(mBroadcastConnections.size() > 0)
+   {
+      GameConnection *conn = static_cast<GameConnection *>(mBroadcastConnections[0]);
+      EventConnection::broadcastNetEvent(TNL_RPC_CONSTRUCT_NETEVENT(conn, s2cDisplayMessageE, (color, sfx, formatString, e)), 
+                                         mBroadcastConnections);
    }
 }
 
@@ -62,6 +62,27 @@ private:
 
    bool mShowAllBots;
 
+   DatabaseQuery mScopeQuery;       // Reused by scope queries, so they needn't allocate or touch the global fillVector
+
+   // What a team can see, worked out once per tick and shared by every connection on the team
+   struct TeamScope
+   {
+      U32 cmdrsMapTick;                            // mScopeTick when cmdrsMapObjects was last built
+      U32 spyBugTick;                              // Same, for spyBugObjects
+      Vector<SafePtr<BfObject> > cmdrsMapObjects;  // What the team's ships show on the commander's map
+      Vector<SafePtr<BfObject> > spyBugObjects;    // What the spy bugs the team can see are watching
+
+      TeamScope();      // Constructor
+   };
+
+   Vector<TeamScope> mTeamScopes;
+   U32 mScopeTick;                  // Bumped every server tick, so team scopes know they're out of date
+   DatabaseQuery mTeamScopeQuery;   // For building team scopes
+
+   TeamScope *getTeamScope(S32 teamIndex);
+   const Vector<SafePtr<BfObject> > &getTeamCmdrsMapObjects(TeamScope *teamScope, S32 teamIndex);
+   const Vector<SafePtr<BfObject> > &getTeamSpyBugObjects(TeamScope *teamScope, S32 teamIndex);
+
    Vector<WallRec> mWalls;
 
    S32 mWinningScore;               // Game over when team (or player in individual games) gets this score
@@ -215,6 +236,13 @@ public:
 
    void addItemOfInterest(MoveItem *theItem);
 
+   // Decides which players get a broadcast; context is whatever was passed along with the filter
+   typedef bool (*ClientFilter)(ClientInfo *clientInfo, void *context);
+
+   // Send one event to many players -- it's only constructed, and its arguments only packed, once
+   void broadcastNetEvent(NetEvent *theEvent, ClientFilter filter = NULL, void *context = NULL);
+   void broadcastNetEventToTeam(NetEvent *theEvent, S32 teamIndex);
+
    void broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &formatString);
 
    void broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, 
@@ -265,6 +293,9 @@ public:
    static Vector<SignedInt<24> > mScores;
    static Vector<SignedFloat<8> > mRatings;
 
+   static Vector<EventConnection *> mBroadcastConnections;     // Who gets the event we're broadcasting
+   void findBroadcastConnections(ClientFilter filter = NULL, void *context = NULL);
+
    explicit GameType(S32 winningScore = DefaultWinningScore);    // Constructor
    virtual ~GameType();                                 // Destructor
 
@@ -431,7 +462,9 @@ public:
    TNL_DECLARE_RPC(c2sRequestScoreboardUpdates, (bool updates));
    TNL_DECLARE_RPC(s2cScoreboardUpdate, (Vector<RangedU32<0, MaxPing> > pingTimes, Vector<SignedFloat<8> > ratings));
 
+   void buildScoreboard();
    void updateClientScoreboard(GameConnection *gc);
+   void broadcastScoreboard();
 
    TNL_DECLARE_RPC(c2sChooseNextWeapon, ());
    TNL_DECLARE_RPC(c2sChoosePrevWeapon, ());
@@ -508,10 +541,9 @@ public:
    virtual void majorScoringEventOcurred(S32 team);    // Gets called when touchdown is scored...  currently only used by zone control & retrieve
 
    void processServerCommand(ClientInfo *clientInfo, const char *cmd, Vector<StringPtr> args);
+   void processLuaProfCommand(ClientInfo *clientInfo, const Vector<StringPtr> &args);
    bool canClientAddBots(GameConnection *source, bool checkDefaultBot = true);
    bool addBotFromClient(Vector<StringTableEntry> args);
-
-   map <pair<U16,U16>, Vector<Point> > cachedBotFlightPlans;  // cache of zone-to-zone flight plans, shared for all bots
 };
 
 #define GAMETYPE_RPC_S2C(className, methodName, args, argNames) \
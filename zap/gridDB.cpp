@@ -4,6 +4,8 @@
 //------------------------------------------------------------------------------
 
 #include "gridDB.h"
+#include "CollisionBroadphase.h"
+#include "ScopeTracker.h"
 #include "moveObject.h"    // For def of ActualState
 #include "WallSegmentManager.h"
 #include "GeomUtils.h"
@@ -31,9 +33,22 @@ GridDatabase::GridDatabase(bool createWallSegmentManager)
 
    mCountGridDatabase++;
 
-   for(U32 i = 0; i < BucketRowCount; i++)
-      for(U32 j = 0; j < BucketRowCount; j++)
-         mBuckets[i][j].nextInBucket = NULL;
+   mBucketMode = HashedBuckets;
+   mBucketWidthBitShift = BucketWidthBitShift;
+   mBucketOriginX = 0;
+   mBucketOriginY = 0;
+   mBuckets = NULL;
+   mBucketTypes = NULL;
+
+   allocateBuckets(BucketRowCount, BucketRowCount);
+
+   mUseTypeIndex = true;
+   mCandidateCount = 0;
+
+   for(U32 i = 0; i < ARRAYSIZE(mTestFuncMasks); i++)
+      mTestFuncMasks[i].testFunc = NULL;
+   mBroadphase = NULL;
+   mScopeTracker = NULL;
 
    if(createWallSegmentManager)
       mWallSegmentManager = new WallSegmentManager();    // Gets deleted in destructor
@@ -64,6 +79,9 @@ GridDatabase::~GridDatabase()
    if(mWallSegmentManager)
       delete mWallSegmentManager;
 
+   delete [] mBuckets;
+   delete [] mBucketTypes;
+
    mCountGridDatabase--;
 
    if(mCountGridDatabase == 0)
@@ -74,6 +92,201 @@ GridDatabase::~GridDatabase()
 }
 
 
+// Discards current bucket heads and replaces them with a fresh, empty grid -- caller must make sure no objects are in the old buckets
+void GridDatabase::allocateBuckets(S32 cols, S32 rows)
+{
+   delete [] mBuckets;
+   delete [] mBucketTypes;
+
+   mBucketCols = cols;
+   mBucketRows = rows;
+   mBuckets = new DatabaseBucketEntryBase[cols * rows];     // Deleted in destructor, or when we get resized
+   mBucketTypes = new TypeMask[cols * rows];                // Ditto; TypeMasks start out empty
+
+   for(S32 i = 0; i < cols * rows; i++)
+      mBuckets[i].nextInBucket = NULL;
+}
+
+
+void GridDatabase::setBucketMode(BucketMode mode)
+{
+   if(mode == mBucketMode)
+      return;
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      removeFromBuckets(mAllObjects[i]);
+
+   mBucketMode = mode;
+   mBucketWidthBitShift = BucketWidthBitShift;
+   mBucketOriginX = 0;
+   mBucketOriginY = 0;
+
+   // LevelBuckets starts out the same size as the hashed grid, but anchored at (0,0); fitBucketsToExtents() will grow it to suit the level
+   allocateBuckets(BucketRowCount, BucketRowCount);
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      addToBuckets(mAllObjects[i]);
+}
+
+
+GridDatabase::BucketMode GridDatabase::getBucketMode() const
+{
+   return mBucketMode;
+}
+
+
+// Size our grid so every bucket covers a distinct part of extents.  Big levels get wider buckets rather than an enormous grid.
+// Objects that later wander outside extents still work; they just pile up in the edge buckets.
+void GridDatabase::fitBucketsToExtents(const Rect &extents)
+{
+   if(mBucketMode != LevelBuckets)
+      return;
+
+   S32 shift = BucketWidthBitShift;
+   S32 minx, miny, cols, rows;
+
+   while(true)
+   {
+      // Leave a spare row of buckets all the way around for objects sitting right on the edge
+      minx = (S32(extents.min.x) >> shift) - 1;
+      miny = (S32(extents.min.y) >> shift) - 1;
+      cols = (S32(extents.max.x) >> shift) + 2 - minx;
+      rows = (S32(extents.max.y) >> shift) + 2 - miny;
+
+      if((cols <= MaxLevelBucketRowCount && rows <= MaxLevelBucketRowCount) || shift >= 30)
+         break;
+
+      shift++;
+   }
+
+   cols = max(1, min(cols, (S32)MaxLevelBucketRowCount));
+   rows = max(1, min(rows, (S32)MaxLevelBucketRowCount));
+
+   // Nothing has changed -- this gets called a lot during level loading, so it is worth checking
+   if(shift == mBucketWidthBitShift && minx == mBucketOriginX && miny == mBucketOriginY && cols == mBucketCols && rows == mBucketRows)
+      return;
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      removeFromBuckets(mAllObjects[i]);
+
+   mBucketWidthBitShift = shift;
+   mBucketOriginX = minx;
+   mBucketOriginY = miny;
+   allocateBuckets(cols, rows);
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      addToBuckets(mAllObjects[i]);
+}
+
+
+// Translates extents into bins to search
+void GridDatabase::fillBins(const Rect &extents, IntRect &bins) const
+{
+   bins.minx = S32(extents.min.x) >> mBucketWidthBitShift;
+   bins.miny = S32(extents.min.y) >> mBucketWidthBitShift;
+   bins.maxx = S32(extents.max.x) >> mBucketWidthBitShift;
+   bins.maxy = S32(extents.max.y) >> mBucketWidthBitShift;
+
+   if(mBucketMode == LevelBuckets)
+   {
+      // Translate into grid coordinates, and clamp to the grid so nothing wraps around
+      bins.minx = max(0, min(bins.minx - mBucketOriginX, mBucketCols - 1));
+      bins.maxx = max(0, min(bins.maxx - mBucketOriginX, mBucketCols - 1));
+      bins.miny = max(0, min(bins.miny - mBucketOriginY, mBucketRows - 1));
+      bins.maxy = max(0, min(bins.maxy - mBucketOriginY, mBucketRows - 1));
+      return;
+   }
+
+   if(U32(bins.maxx - bins.minx) >= BucketRowCount)
+      bins.maxx = bins.minx + BucketRowCount - 1;
+
+   if(U32(bins.maxy - bins.miny) >= BucketRowCount)
+      bins.maxy = bins.miny + BucketRowCount - 1;
+}
+
+
+S32 GridDatabase::getBucketIndex(S32 x, S32 y) const
+{
+   if(mBucketMode == LevelBuckets)
+      return x * mBucketRows + y;       // fillBins() has already clamped x and y to our grid
+
+   return (x & BucketMask) * BucketRowCount + (y & BucketMask);
+}
+
+
+// Link theObject into every bucket its extent overlaps
+void GridDatabase::addToBuckets(DatabaseObject *theObject)
+{
+   TNLAssert(!theObject->mBucketList, "BucketList must be NULL");
+
+   IntRect bins;
+   fillBins(theObject->getExtent(), bins);
+
+   U8 type = theObject->getObjectTypeNumber();
+
+   // Don't use x <= maxx, it will endless loop if maxx = S32_MAX and x overflows
+   // Instead, use maxx - x >= 0, it will better handle overflows and avoid endless loop (MIN_S32 - MAX_S32 = +1)
+   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+      {
+         S32 index = getBucketIndex(x, y);
+         mBucketTypes[index].set(type);
+
+         DatabaseBucketEntry *be = mChunker->alloc();
+         DatabaseBucketEntryBase *base = &mBuckets[index];
+         be->theObject = theObject;
+         if(base->nextInBucket)
+            base->nextInBucket->prevInBucket = be;
+         be->nextInBucket = base->nextInBucket;
+         be->prevInBucket = base;
+         base->nextInBucket = be;
+         be->nextInBucketForThisObject = theObject->mBucketList;
+         theObject->mBucketList = be;
+      }
+}
+
+
+// Unlink theObject from all its buckets
+void GridDatabase::removeFromBuckets(DatabaseObject *theObject)
+{
+   while(theObject->mBucketList)
+   {
+      DatabaseBucketEntry *b = theObject->mBucketList;
+      TNLAssert(b->theObject == theObject, "Object mismatch");
+      TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
+      if(b->nextInBucket)
+         b->nextInBucket->prevInBucket = b->prevInBucket;
+      b->prevInBucket->nextInBucket = b->nextInBucket;
+      theObject->mBucketList = b->nextInBucketForThisObject;
+      mChunker->free(b);
+   }
+
+   // Drop theObject's type from the bucket masks, unless something else of that type is still there.  theObject's extent is the 
+   // one it was added with, so these are the buckets we added it to.  Getting this wrong would only leave a stale bit behind, 
+   // which costs a little search time but never misses anything.
+   IntRect bins;
+   fillBins(theObject->mExtent, bins);
+
+   U8 type = theObject->getObjectTypeNumber();
+
+   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+      {
+         S32 index = getBucketIndex(x, y);
+
+         if(!mBucketTypes[index].test(type))
+            continue;
+
+         DatabaseBucketEntry *walk = mBuckets[index].nextInBucket;
+         while(walk && walk->theObject->getObjectTypeNumber() != type)
+            walk = walk->nextInBucket;
+
+         if(!walk)
+            mBucketTypes[index].unset(type);
+      }
+}
+
+
 // This sort will put points on top of lines on top of polygons...  as they should be
 // We'll also put walls on the bottom, as this seems to work best in practice
 S32 QSORT_CALLBACK geometricSort(DatabaseObject * &a, DatabaseObject * &b)
@@ -102,15 +315,21 @@ void GridDatabase::copyObjects(const GridDatabase *source)
 {
    // Preallocate some memory to make copying a little more efficient
    mAllObjects.reserve(source->mAllObjects.size());
-   mGoalZones .reserve(source->mGoalZones.size());
-   mFlags     .reserve(source->mFlags.size());
-   mSpyBugs   .reserve(source->mSpyBugs.size());
 
+   for(U32 i = 0; i < ARRAYSIZE(mObjectsByType); i++)
+      mObjectsByType[i].reserve(source->mObjectsByType[i].size());
 
    for(S32 i = 0; i < source->mAllObjects.size(); i++)
       addToDatabase(source->mAllObjects[i]->clone());
 
    sortObjects(mAllObjects);
+
+   // The type lists have to follow mAllObjects' new order
+   for(U32 i = 0; i < ARRAYSIZE(mObjectsByType); i++)
+      mObjectsByType[i].clear();
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      mObjectsByType[mAllObjects[i]->mListedTypeNumber].push_back(mAllObjects[i]);
 }
 
 
@@ -127,34 +346,21 @@ void GridDatabase::addToDatabase(DatabaseObject *theObject)
 
    theObject->mDatabase = this;
 
-   static IntRect bins;
-   fillBins(theObject->getExtent(), bins);
-
-   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
-      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
-      {
-         DatabaseBucketEntry *be = mChunker->alloc();
-         DatabaseBucketEntryBase *base = &mBuckets[x & BucketMask][y & BucketMask];
-         be->theObject = theObject;
-         if(base->nextInBucket)
-            base->nextInBucket->prevInBucket = be;
-         be->nextInBucket = base->nextInBucket;
-         be->prevInBucket = base;
-         base->nextInBucket = be;
-         be->nextInBucketForThisObject = theObject->mBucketList;
-         theObject->mBucketList = be;
-      }
+   addToBuckets(theObject);
 
    // Add the object to our non-spatial "database" as well
    mAllObjects.push_back(theObject);
 
    U8 type = theObject->getObjectTypeNumber();
-   if(type == GoalZoneTypeNumber)
-      mGoalZones.push_back(theObject);
-   else if(type == FlagTypeNumber)
-      mFlags.push_back(theObject);
-   else if(type == SpyBugTypeNumber)
-      mSpyBugs.push_back(theObject);
+   mObjectsByType[type].push_back(theObject);
+   mTypesPresent.set(type);
+   theObject->mListedTypeNumber = type;
+
+   if(mBroadphase)
+      mBroadphase->onObjectAdded(theObject);
+
+   if(mScopeTracker)
+      mScopeTracker->onObjectAdded(theObject);
    
    //sortObjects(mAllObjects);  // problem: Barriers in-game don't have mGeometry (it is NULL)
 }
@@ -170,26 +376,31 @@ void GridDatabase::addToDatabase(const Vector<DatabaseObject *> &objects)
 
 void GridDatabase::removeEverythingFromDatabase()
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
+   for(S32 i = 0; i < mBucketCols * mBucketRows; i++)
    {
-      for(S32 y = 0; y < BucketRowCount; y++)
+      for(DatabaseBucketEntry *walk = mBuckets[i].nextInBucket; walk; )
       {
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; )
-         {
-            DatabaseBucketEntry *rem = walk;
-            walk->theObject->mDatabase = NULL;  // make sure object don't point to this database anymore
-            walk->theObject->mBucketList = NULL;
-            walk = rem->nextInBucket;
-            mChunker->free(rem);
-         }
-         mBuckets[x & BucketMask][y & BucketMask].nextInBucket = NULL;
+         DatabaseBucketEntry *rem = walk;
+         walk->theObject->mDatabase = NULL;  // make sure object don't point to this database anymore
+         walk->theObject->mBucketList = NULL;
+         walk = rem->nextInBucket;
+         mChunker->free(rem);
       }
+      mBuckets[i].nextInBucket = NULL;
+      mBucketTypes[i].clear();
    }
 
-   // Clear out our specialty lists -- since objects are also in mAllObjects, they'll be deleted below
-   mGoalZones.clear();
-   mFlags.clear();
-   mSpyBugs.clear();
+   // Clear out our per-type lists -- since objects are also in mAllObjects, they'll be deleted below
+   for(U32 i = 0; i < ARRAYSIZE(mObjectsByType); i++)
+      mObjectsByType[i].clear();
+
+   mTypesPresent.clear();
+
+   if(mBroadphase)
+      mBroadphase->onDatabaseCleared();
+
+   if(mScopeTracker)
+      mScopeTracker->onDatabaseCleared();
 
    mAllObjects.deleteAndClear();
    
@@ -198,13 +409,13 @@ void GridDatabase::removeEverythingFromDatabase()
 }
 
 
-// Don't use this with a sorted list!
-static void eraseObject_fast(Vector<DatabaseObject *> *objects, DatabaseObject *objectToDelete)
+// Keeps the order of the remaining objects
+static void eraseObject(Vector<DatabaseObject *> *objects, DatabaseObject *objectToDelete)
 {
    for(S32 i = 0; i < objects->size(); i++)
       if(objects->get(i) == objectToDelete)
       {
-         objects->erase_fast(i);     
+         objects->erase(i);     
          return;
       }
 }
@@ -216,41 +427,26 @@ void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
    if(object->mDatabase != this)
       return;
 
-   const Rect &extents = object->mExtent;
    object->mDatabase = NULL;
 
-   static IntRect bins;
-   fillBins(extents, bins);
+   removeFromBuckets(object);
 
-   while(object->mBucketList)
-   {
-      DatabaseBucketEntry *b = object->mBucketList;
-      TNLAssert(b->theObject == object, "Object mismatch");
-      TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-      if(b->nextInBucket)
-         b->nextInBucket->prevInBucket = b->prevInBucket;
-      b->prevInBucket->nextInBucket = b->nextInBucket;
-      object->mBucketList = b->nextInBucketForThisObject;
-      mChunker->free(b);
-   }
+   // Find and delete object from our non-spatial databases -- mAllObjects is sorted, so we can't use erase_fast, and 
+   // mObjectsByType keeps the same order
+   eraseObject(&mAllObjects, object);
 
-   // Find and delete object from our non-spatial databases
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(mAllObjects[i] == object)
-      {
-         mAllObjects.erase(i);            // mAllObjects is sorted, so we can't use erase_fast
-         break;
-      }
+   // Not getObjectTypeNumber() -- if the object has been through deleteObject(), that's DeletedTypeNumber now
+   U8 type = object->mListedTypeNumber;
+   eraseObject(&mObjectsByType[type], object);
 
+   if(mObjectsByType[type].size() == 0)
+      mTypesPresent.unset(type);
 
-   U8 type = object->getObjectTypeNumber();
+   if(mBroadphase)
+      mBroadphase->onObjectRemoved(object);
 
-   if(type == GoalZoneTypeNumber)
-      eraseObject_fast(&mGoalZones, object);
-   else if(type == FlagTypeNumber)
-      eraseObject_fast(&mFlags, object);
-   else if(type == SpyBugTypeNumber)
-      eraseObject_fast(&mSpyBugs, object);
+   if(mScopeTracker)
+      mScopeTracker->onObjectRemoved(object);
 
    if(deleteObject)
       delete object;      
@@ -273,191 +469,474 @@ const Vector<DatabaseObject *> *GridDatabase::findObjects_fast() const
 }
 
 
-// Faster than above, but results can't be modified, and only works with selected types at the moment
+// Faster than above, but results can't be modified
 const Vector<DatabaseObject *> *GridDatabase::findObjects_fast(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return &mGoalZones;
+   return &mObjectsByType[typeNumber];
+}
+
+
+// Legacy searches mark objects with mQueryId as they are found, so callers can run several searches (sameQuery) without
+// getting any object twice
+struct LegacySearch
+{
+   Vector<DatabaseObject *> *fillVector;
+   U32 queryId;
+};
+
+
+bool GridDatabase::addToFillVector(DatabaseObject *object, void *context)
+{
+   LegacySearch *search = static_cast<LegacySearch *>(context);
+
+   if(object->mLastQueryId != search->queryId)      // Object hasn't been found already
+   {
+      object->mLastQueryId = search->queryId;       // Flag the object so we know we've already visited it
+      search->fillVector->push_back(object);        // And save it as a found item
+   }
+
+   return true;
+}
+
+
+void GridDatabase::findObjects(const TypeMask &types, Vector<DatabaseObject *> &fillVector, const Rect *extents, bool sameQuery) const
+{
+   TNLAssert(this, "findObjects 'this' is NULL");
+   if(!sameQuery)
+      mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+
+   LegacySearch search;
+   search.fillVector = &fillVector;
+   search.queryId = mQueryId;
+
+   visitObjects(types, NULL, extents, addToFillVector, &search, true);
+}
+
+
+// Find all objects in database of type typeNumber
+void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const
+{
+   const Vector<DatabaseObject *> &objects = mObjectsByType[typeNumber];
+
+   mCandidateCount += objects.size();
+
+   for(S32 i = 0; i < objects.size(); i++)
+      if(objects[i]->getObjectTypeNumber() == typeNumber)      // Skip objects deleteObject() has been run on
+         fillVector.push_back(objects[i]);
+}
+
+
+// Find all objects in &extents that are of type typeNumber
+void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+{
+   findObjects(TypeMask(typeNumber), fillVector, &extents, false);
+}
+
+
+// Find all objects in database using derived type test function
+void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector) const
+{
+   findObjects(getTypeMask(testFunc), fillVector, NULL, false);
+}
+
+
+// Find all objects in database using derived type test function
+void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+{
+   findObjects(TypeMask(types), fillVector, &extents, false);
+}
+
+
+// Find all objects in database using derived type test function
+void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const
+{
+   findObjects(TypeMask(types), fillVector, NULL, false);
+}
+
+
+bool GridDatabase::testTypes(const Vector<U8> &types, U8 objectType) const
+{
+   for(S32 i = 0; i < types.size(); i++)
+      if(types[i] == objectType)
+         return true;
+
+   return false;
+}
+
+
+// Find all objects in &extents derived type test function
+void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents, bool sameQuery) const
+{
+   findObjects(getTypeMask(testFunc), fillVector, &extents, sameQuery);
+}
+
+
+static bool addToQueryResults(DatabaseObject *object, void *query)
+{
+   static_cast<DatabaseQuery *>(query)->addResult(object);
+   return true;
+}
+
+
+// Returns the first bin at or after queryMin in which an object spanning bins objMin to objMax will be found
+static S32 firstBinForObject(S32 objMin, S32 objMax, S32 queryMin, bool wraps)
+{
+   if(!wraps)
+      return max(objMin, queryMin);
+
+   // Object occupies buckets objMin..objMax modulo BucketRowCount; find the first of those at or after queryMin
+   S32 offset = (queryMin - objMin) & GridDatabase::BucketMask;
+
+   if(offset <= objMax - objMin)
+      return queryMin;
+
+   return queryMin + (GridDatabase::BucketRowCount - offset);
+}
+
+
+// Large objects are linked into several buckets, so a search covering several buckets may come across them more than once.
+// Rather than marking objects as we find them, we only accept an object in the first bucket of bins, in our (x, then y) 
+// search order, that it is linked into.  That keeps single searches free of any shared state.
+bool GridDatabase::isFirstBucketForObject(const DatabaseObject *object, const IntRect &bins, S32 x, S32 y) const
+{
+   if(bins.minx == bins.maxx && bins.miny == bins.maxy)     // Only one bucket -- nothing is in it twice
+      return true;
+
+   IntRect objectBins;
+   fillBins(object->mExtent, objectBins);
+
+   bool wraps = (mBucketMode == HashedBuckets);
+
+   return firstBinForObject(objectBins.minx, objectBins.maxx, bins.minx, wraps) == x &&
+          firstBinForObject(objectBins.miny, objectBins.maxy, bins.miny, wraps) == y;
+}
+
+
+TypeMask GridDatabase::getTypeMask(TestFunc testFunc) const
+{
+   const U32 mask = ARRAYSIZE(mTestFuncMasks) - 1;
+   U32 slot = U32(size_t(testFunc) >> 2) & mask;
+
+   for(U32 i = 0; i <= mask; i++, slot = (slot + 1) & mask)
+   {
+      const CachedTestFuncMask &entry = mTestFuncMasks[slot];
+
+      if(entry.testFunc == testFunc)
+         return entry.mask;
+
+      if(entry.testFunc == NULL)
+         break;
+   }
+
+   TypeMask types(testFunc);
+
+   if(mTestFuncMasks[slot].testFunc == NULL)    // Should always have room, but if not, just do without caching
+   {
+      mTestFuncMasks[slot].testFunc = testFunc;
+      mTestFuncMasks[slot].mask = types;
+   }
+
+   return types;
+}
+
+
+// Walking the per-type lists costs one check per object of the requested types; walking the buckets costs at least one check
+// per bucket.  Pick whichever should be cheaper.  What we find on the type lists has to be sorted into the order the buckets
+// would have given it, so we only go that way for a handful of objects.
+bool GridDatabase::useTypeLists(const TypeMask &types, const IntRect &bins) const
+{
+   if(!mUseTypeIndex)
+      return false;
+
+   S32 bucketCount = (bins.maxx - bins.minx + 1) * (bins.maxy - bins.miny + 1);
+   S32 maxObjects = min(bucketCount, (S32)MaxTypeListResults);
+   S32 objectCount = 0;
+
+   for(S32 i = 0; i < TypeMask::getWordCount(); i++)
+   {
+      U32 bits = types.getWord(i) & mTypesPresent.getWord(i);
+
+      for(S32 type = i * 32; bits; type++, bits >>= 1)
+         if(bits & 1)
+         {
+            objectCount += mObjectsByType[type].size();
+            if(objectCount > maxObjects)
+               return false;
+         }
+   }
+
+   return true;
+}
+
+
+// True if we only have objects of one of types (or none) -- then a single type list holds everything a search of the whole
+// database would find, in the same order as mAllObjects
+bool GridDatabase::isSingleTypeSearch(const TypeMask &types) const
+{
+   S32 typeCount = 0;
+
+   for(S32 i = 0; i < TypeMask::getWordCount(); i++)
+   {
+      U32 bits = types.getWord(i) & mTypesPresent.getWord(i);
+
+      if(bits & (bits - 1))      // More than one bit set
+         return false;
+
+      if(bits)
+         typeCount++;
+   }
+
+   return typeCount <= 1;
+}
+
+
+// Visit matching objects by way of mObjectsByType, rather than the buckets; since each object is listed only once, there are
+// no duplicates to worry about.  When searching extents, bins must be its bins, and we visit what we find in the order the
+// buckets would have given it to us -- callers like findFirstCollision() depend on that.
+bool GridDatabase::visitTypeLists(const TypeMask &types, DatabaseQuery *query, const Rect *extents, const IntRect *bins,
+                                  QueryVisitor visitor, void *context) const
+{
+   SearchOrder found[MaxTypeListResults];
+   S32 foundCount = 0;
+
+   for(S32 i = 0; i < TypeMask::getWordCount(); i++)
+   {
+      U32 bits = types.getWord(i) & mTypesPresent.getWord(i);
+
+      for(S32 type = i * 32; bits; type++, bits >>= 1)
+      {
+         if(!(bits & 1))
+            continue;
+
+         const Vector<DatabaseObject *> &objects = mObjectsByType[type];
+
+         mCandidateCount += objects.size();
+
+         for(S32 j = 0; j < objects.size(); j++)
+         {
+            DatabaseObject *object = objects[j];
+
+            // Objects stay on their type list after deleteObject() has changed their type to DeletedTypeNumber, so check again
+            if(!types.test(object->getObjectTypeNumber()) || (extents && !object->mExtent.intersects(*extents)) ||
+                  (query && !query->markVisited(object)))
+               continue;
+
+            if(!extents)
+            {
+               if(!visitor(object, context))
+                  return false;
+            }
+            else
+            {
+               TNLAssert(foundCount < MaxTypeListResults, "Found too many objects -- see useTypeLists()");
+               found[foundCount++].object = object;
+            }
+         }
+      }
+   }
+
+   if(foundCount > 1)
+      putInSearchOrder(*bins, found, foundCount);
+
+   for(S32 i = 0; i < foundCount; i++)
+      if(!visitor(found[i].object, context))
+         return false;
+
+   return true;
+}
+
+
+// Heart of all our searches.  If extents is NULL, searches the entire database.  If query is not NULL, objects already found 
+// since it was last cleared will be skipped.  Unless visitorSkipsDuplicates is set, each object will be visited only once.  
+// Returns false if visitor stopped the search.  Objects are always visited in the order a walk of mAllObjects (with no
+// extents) or of the buckets would find them, whichever way we actually go.
+// Touches nothing but query, so searches using different DatabaseQuerys (or none) won't interfere with one another.
+bool GridDatabase::visitObjects(const TypeMask &types, DatabaseQuery *query, const Rect *extents, 
+                                QueryVisitor visitor, void *context, bool visitorSkipsDuplicates) const
+{
+   if(!extents)
+   {
+      if(mUseTypeIndex && isSingleTypeSearch(types))
+         return visitTypeLists(types, query, NULL, NULL, visitor, context);
+
+      mCandidateCount += mAllObjects.size();
+
+      for(S32 i = 0; i < mAllObjects.size(); i++)
+         if(types.test(mAllObjects[i]->getObjectTypeNumber()) && (!query || query->markVisited(mAllObjects[i])))
+            if(!visitor(mAllObjects[i], context))
+               return false;
+
+      return true;
+   }
+
+   IntRect bins;
+   fillBins(*extents, bins);
+
+   if(useTypeLists(types, bins))
+      return visitTypeLists(types, query, extents, &bins, visitor, context);
+
+   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+      {
+         S32 index = getBucketIndex(x, y);
+
+         if(mUseTypeIndex && !mBucketTypes[index].intersects(types))      // Nothing we want in here
+            continue;
+
+         for(DatabaseBucketEntry *walk = mBuckets[index].nextInBucket; walk; walk = walk->nextInBucket)
+         {
+            DatabaseObject *theObject = walk->theObject;
+
+            mCandidateCount++;
+
+            if(types.test(theObject->getObjectTypeNumber()) &&                 // Object is of the right type; and
+               theObject->mExtent.intersects(*extents) &&                      // overlaps our extents; and
+               (visitorSkipsDuplicates ||                                      // hasn't been found already
+                  (query ? query->markVisited(theObject) : isFirstBucketForObject(theObject, bins, x, y))))
+            {
+               if(!visitor(theObject, context))
+                  return false;
+            }
+         }
+      }
+
+   return true;
+}
 
-   if(typeNumber == FlagTypeNumber)
-      return &mFlags;
 
-   if(typeNumber == SpyBugTypeNumber)
-      return &mSpyBugs;
+S32 QSORT_CALLBACK GridDatabase::compareSearchOrder(SearchOrder *a, SearchOrder *b)
+{
+   if(a->x != b->x)
+      return a->x - b->x;
+   if(a->y != b->y)
+      return a->y - b->y;
 
-   TNLAssert(false, "This type not currently supported!  Sorry dude!");
-   return NULL;  // this line gets rid of compile warning "Not all control paths return a value"
+   return a->position - b->position;
 }
 
 
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
+// Buckets are searched x, then y, then from the head of each bucket's list, and each object is taken at the first bucket
+// it turns up in -- see isFirstBucketForObject().  Only the object of each entry needs to be filled in.
+void GridDatabase::putInSearchOrder(const IntRect &bins, SearchOrder *order, S32 count) const
 {
-   static Vector<U8> types;
-   types.resize(1);
+   bool wraps = (mBucketMode == HashedBuckets);
 
-   types[0] = typeNumber;
+   for(S32 i = 0; i < count; i++)
+   {
+      IntRect objectBins;
+      fillBins(order[i].object->mExtent, objectBins);
 
-   findObjects(types, fillVector, extents, bins);
-}
+      order[i].x = firstBinForObject(objectBins.minx, objectBins.maxx, bins.minx, wraps);
+      order[i].y = firstBinForObject(objectBins.miny, objectBins.maxy, bins.miny, wraps);
+      order[i].position = 0;
+   }
 
+   qsort(order, count, sizeof(SearchOrder), (qsort_compare_func) compareSearchOrder);
 
-void GridDatabase::findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
-{
-   mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   // Objects found in the same bucket come out in bucket list order
+   bool sharedBuckets = false;
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
-         {
-            DatabaseObject *theObject = walk->theObject;
+   for(S32 first = 0; first < count; )
+   {
+      S32 last = first + 1;
+      while(last < count && order[last].x == order[first].x && order[last].y == order[first].y)
+         last++;
 
-            if(theObject->mLastQueryId != mQueryId &&                         // Object hasn't been queried; and
-               testTypes(typeNumbers, theObject->getObjectTypeNumber()) &&    // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )        // overlaps our extents (if passed)
-            {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
-            }
-         }
+      if(last - first > 1)
+      {
+         sharedBuckets = true;
+
+         S32 position = 0;
+         for(DatabaseBucketEntry *walk = mBuckets[getBucketIndex(order[first].x, order[first].y)].nextInBucket; walk; walk = walk->nextInBucket, position++)
+            for(S32 i = first; i < last; i++)
+               if(order[i].object == walk->theObject && order[i].position == 0)
+               {
+                  order[i].position = position + 1;
+                  break;
+               }
+      }
+
+      first = last;
+   }
+
+   if(sharedBuckets)
+      qsort(order, count, sizeof(SearchOrder), (qsort_compare_func) compareSearchOrder);
 }
 
 
-// Find all objects in database of type typeNumber
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const
+void GridDatabase::sortInSearchOrder(const Rect &extents, Vector<DatabaseObject *> &objects) const
 {
-   // If the user is looking for a type we maintain a list for, it will be faster to use that list than to cycle through the general item list.
-   TNLAssert(typeNumber != GoalZoneTypeNumber && typeNumber != FlagTypeNumber && typeNumber != SpyBugTypeNumber, 
-             "Can use findObjects_fast()?  If not, uncomment the appropriate block below; it will perform better!");
-
-   //if(typeNumber == GoalZoneTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mGoalZones.size(); i++)
-   //      fillVector.push_back(mGoalZones[i]);
-   //   return;
-   //}
-
-   //if(typeNumber == FlagTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mFlags.size(); i++)
-   //      fillVector.push_back(mFlags[i]);
-   //   return;
-   //}
-
-   //if(typeNumber == SpyBugTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mSpyBugs.size(); i++)
-   //      fillVector.push_back(mSpyBugs[i]);
-   //   return;
-   //}
+   if(objects.size() < 2)
+      return;
 
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(mAllObjects[i]->getObjectTypeNumber() == typeNumber)
-         fillVector.push_back(mAllObjects[i]);
-}
+   IntRect bins;
+   fillBins(extents, bins);
 
+   mSearchOrder.resize(objects.size());
 
-// Translates extents into bins to search
-void GridDatabase::fillBins(const Rect &extents, IntRect &bins) const
-{
-   bins.minx = S32(extents.min.x) >> BucketWidthBitShift;
-   bins.miny = S32(extents.min.y) >> BucketWidthBitShift;
-   bins.maxx = S32(extents.max.x) >> BucketWidthBitShift;
-   bins.maxy = S32(extents.max.y) >> BucketWidthBitShift;
+   for(S32 i = 0; i < objects.size(); i++)
+      mSearchOrder[i].object = objects[i];
 
-   if(U32(bins.maxx - bins.minx) >= BucketRowCount)
-      bins.maxx = bins.minx + BucketRowCount - 1;
+   putInSearchOrder(bins, mSearchOrder.address(), mSearchOrder.size());
 
-   if(U32(bins.maxy - bins.miny) >= BucketRowCount)
-      bins.maxy = bins.miny + BucketRowCount - 1;
+   for(S32 i = 0; i < objects.size(); i++)
+      objects[i] = mSearchOrder[i].object;
 }
 
 
-// Find all objects in &extents that are of type typeNumber
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+void GridDatabase::findObjects(U8 typeNumber, DatabaseQuery &query) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
-
-   findObjects(typeNumber, fillVector, &extents, &bins);
+   visitObjects(TypeMask(typeNumber), &query, NULL, addToQueryResults, &query);
 }
 
 
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery) const
+void GridDatabase::findObjects(U8 typeNumber, DatabaseQuery &query, const Rect &extents) const
 {
-   TNLAssert(this, "findObjects 'this' is NULL");
-   if(!sameQuery)
-      mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   visitObjects(TypeMask(typeNumber), &query, &extents, addToQueryResults, &query);
+}
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
-         {
-            DatabaseObject *theObject = walk->theObject;
 
-            if(theObject->mLastQueryId != mQueryId &&                      // Object hasn't been queried; and
-               (testFunc(theObject->getObjectTypeNumber())) &&             // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )     // overlaps our extents (if passed)
-            {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
-            }
-         }
+void GridDatabase::findObjects(TestFunc testFunc, DatabaseQuery &query) const
+{
+   visitObjects(getTypeMask(testFunc), &query, NULL, addToQueryResults, &query);
 }
 
 
-// Find all objects in database using derived type test function
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector) const
+void GridDatabase::findObjects(TestFunc testFunc, DatabaseQuery &query, const Rect &extents) const
 {
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(testFunc(mAllObjects[i]->getObjectTypeNumber()))
-         fillVector.push_back(mAllObjects[i]);
+   visitObjects(getTypeMask(testFunc), &query, &extents, addToQueryResults, &query);
 }
 
 
-// Find all objects in database using derived type test function
-void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+void GridDatabase::findObjects(const Vector<U8> &types, DatabaseQuery &query) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
-
-   findObjects(types, fillVector, &extents, &bins);
+   visitObjects(TypeMask(types), &query, NULL, addToQueryResults, &query);
 }
 
 
-// Find all objects in database using derived type test function
-void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const
+void GridDatabase::findObjects(const Vector<U8> &types, DatabaseQuery &query, const Rect &extents) const
 {
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(testTypes(types, mAllObjects[i]->getObjectTypeNumber()))
-         fillVector.push_back(mAllObjects[i]);
+   visitObjects(TypeMask(types), &query, &extents, addToQueryResults, &query);
 }
 
 
-bool GridDatabase::testTypes(const Vector<U8> &types, U8 objectType) const
+void GridDatabase::visitObjects(TestFunc testFunc, QueryVisitor visitor, void *context) const
 {
-   for(S32 i = 0; i < types.size(); i++)
-      if(types[i] == objectType)
-         return true;
-
-   return false;
+   visitObjects(getTypeMask(testFunc), NULL, NULL, visitor, context);
 }
 
 
-// Find all objects in &extents derived type test function
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents, bool sameQuery) const
+void GridDatabase::visitObjects(TestFunc testFunc, const Rect &extents, QueryVisitor visitor, void *context) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
-
-   findObjects(testFunc, fillVector, &extents, &bins, sameQuery);
+   visitObjects(getTypeMask(testFunc), NULL, &extents, visitor, context);
 }
 
 
 void GridDatabase::dumpObjects()
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
-      for(S32 y = 0; y < BucketRowCount; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
+   for(S32 x = 0; x < mBucketCols; x++)
+      for(S32 y = 0; y < mBucketRows; y++)
+         for(DatabaseBucketEntry *walk = mBuckets[x * mBucketRows + y].nextInBucket; walk; walk = walk->nextInBucket)
          {
             DatabaseObject *theObject = walk->theObject;
             logprintf("Found object in (%d,%d) with extents %s", x, y, theObject->getExtent().toString().c_str());
@@ -554,6 +1033,7 @@ void DatabaseObject::initialize()
    mExtentSet = false;
    mDatabase = NULL;
    mBucketList = NULL;
+   mListedTypeNumber = 0;
 }
 
 
@@ -746,39 +1226,16 @@ S32 GridDatabase::getObjectCount() const
 }
 
 
-// Return count of objects of specified type.  Only supports certain types at the moment.
+// Return count of objects of specified type
 S32 GridDatabase::getObjectCount(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return mGoalZones.size();
-
-   if(typeNumber == FlagTypeNumber)
-      return mFlags.size();
-
-   if(typeNumber == SpyBugTypeNumber)
-      return mSpyBugs.size();
-
-   TNLAssert(false, "Unsupported type!");
-   return 0;
+   return mObjectsByType[typeNumber].size();
 }
 
 
 bool GridDatabase::hasObjectOfType(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return mGoalZones.size() > 0;
-
-   if(typeNumber == FlagTypeNumber)
-      return mFlags.size() > 0;
-
-   if(typeNumber == SpyBugTypeNumber)
-      return mSpyBugs.size() > 0;
-
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(mAllObjects[i]->getObjectTypeNumber() == typeNumber)
-         return true;
-
-   return false;
+   return mTypesPresent.test(typeNumber);
 }
 
 
@@ -794,6 +1251,48 @@ DatabaseObject *GridDatabase::getObjectByIndex(S32 index) const
 } 
 
 
+void GridDatabase::setBroadphase(CollisionBroadphase *broadphase)
+{
+   mBroadphase = broadphase;
+}
+
+
+CollisionBroadphase *GridDatabase::getBroadphase() const
+{
+   return mBroadphase;
+}
+
+
+void GridDatabase::setScopeTracker(ScopeTracker *scopeTracker)
+{
+   mScopeTracker = scopeTracker;
+}
+
+
+ScopeTracker *GridDatabase::getScopeTracker() const
+{
+   return mScopeTracker;
+}
+
+
+void GridDatabase::setTypeIndexEnabled(bool enabled)
+{
+   mUseTypeIndex = enabled;
+}
+
+
+U32 GridDatabase::getCandidateCount() const
+{
+   return mCandidateCount;
+}
+
+
+void GridDatabase::resetCandidateCount()
+{
+   mCandidateCount = 0;
+}
+
+
 void DatabaseObject::addToDatabase(GridDatabase *database)
 {
    TNLAssert(mExtentSet, "Extent has not been set on this object!");    // Sanity check
@@ -887,67 +1386,24 @@ void DatabaseObject::setExtent(const Rect &extents)
 
    if(gridDB)
    {
-      // Remove from the extents database for current extents...
-      //gridDB->removeFromDatabase(this, mExtent);    // old extent
-      // ...and re-add for the new extent
-      //gridDB->addToDatabase(this, extents);
-
-
-      S32 minxold, minyold, maxxold, maxyold;
-      S32 minx, miny, maxx, maxy;
-
-      minxold = S32(mExtent.min.x) >> GridDatabase::BucketWidthBitShift;
-      minyold = S32(mExtent.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxxold = S32(mExtent.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxyold = S32(mExtent.max.y) >> GridDatabase::BucketWidthBitShift;
-
-      minx    = S32(extents.min.x) >> GridDatabase::BucketWidthBitShift;
-      miny    = S32(extents.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxx    = S32(extents.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxy    = S32(extents.max.y) >> GridDatabase::BucketWidthBitShift;
+      IntRect oldBins, newBins;
+      gridDB->fillBins(mExtent, oldBins);
+      gridDB->fillBins(extents, newBins);
 
       // Don't do anything if the buckets haven't changed...
-      if((minxold - minx) | (minyold - miny) | (maxxold - maxx) | (maxyold - maxy))
+      if((oldBins.minx - newBins.minx) | (oldBins.miny - newBins.miny) | (oldBins.maxx - newBins.maxx) | (oldBins.maxy - newBins.maxy))
       {
          // They are different... remove and readd to database, but don't touch gridDB->mAllObjects
-         if(U32(maxx - minx) >= gridDB->BucketRowCount)        maxx    = minx    + gridDB->BucketRowCount - 1;
-         if(U32(maxy - miny) >= gridDB->BucketRowCount)        maxy    = miny    + gridDB->BucketRowCount - 1;
-         if(U32(maxxold >= minxold) + gridDB->BucketRowCount)  maxxold = minxold + gridDB->BucketRowCount - 1;
-         if(U32(maxyold >= minyold) + gridDB->BucketRowCount)  maxyold = minyold + gridDB->BucketRowCount - 1;
-
-
-         // Don't use x <= maxx, it will endless loop if maxx = S32_MAX and x overflows
-         // Instead, use maxx - x >= 0, it will better handle overflows and avoid endless loop (MIN_S32 - MAX_S32 = +1)
+         gridDB->removeFromBuckets(this);
+         mExtent.set(extents);
+         gridDB->addToBuckets(this);
+      }
 
-         // Remove from the extents database for current extents...
-         while(mBucketList)
-         {
-            DatabaseBucketEntry *b = mBucketList;
-            TNLAssert(b->theObject == this, "Object mismatch");
-            TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-            if(b->nextInBucket)
-               b->nextInBucket->prevInBucket = b->prevInBucket;
-            b->prevInBucket->nextInBucket = b->nextInBucket;
-            mBucketList = b->nextInBucketForThisObject;
-            gridDB->mChunker->free(b);
-         }
+      if(gridDB->mBroadphase)
+         gridDB->mBroadphase->onExtentChanged(this, extents);
 
-         // ...and re-add for the new extent
-         for(S32 x = minx; maxx - x >= 0; x++)
-            for(S32 y = miny; maxy - y >= 0; y++)
-            {
-               DatabaseBucketEntry *be = gridDB->mChunker->alloc();
-               DatabaseBucketEntryBase *base = &gridDB->mBuckets[x & gridDB->BucketMask][y & gridDB->BucketMask];
-               be->theObject = this;
-               if(base->nextInBucket)
-                  base->nextInBucket->prevInBucket = be;
-               be->nextInBucket = base->nextInBucket;
-               be->prevInBucket = base;
-               base->nextInBucket = be;
-               be->nextInBucketForThisObject = mBucketList;
-               mBucketList = be;
-            }
-      }
+      if(gridDB->mScopeTracker)
+         gridDB->mScopeTracker->onExtentChanged(this);
    }
 
    mExtent.set(extents);
@@ -962,6 +1418,250 @@ DatabaseObject *DatabaseObject::clone() const
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+TypeMask::TypeMask()
+{
+   clear();
+}
+
+
+TypeMask::TypeMask(U8 typeNumber)
+{
+   clear();
+   set(typeNumber);
+}
+
+
+TypeMask::TypeMask(TestFunc testFunc)
+{
+   clear();
+
+   for(U32 i = 0; i < 256; i++)
+      if(testFunc(U8(i)))
+         set(U8(i));
+}
+
+
+TypeMask::TypeMask(const Vector<U8> &typeNumbers)
+{
+   clear();
+
+   for(S32 i = 0; i < typeNumbers.size(); i++)
+      set(typeNumbers[i]);
+}
+
+
+void TypeMask::clear()
+{
+   for(S32 i = 0; i < WordCount; i++)
+      mBits[i] = 0;
+}
+
+
+bool TypeMask::intersects(const TypeMask &other) const
+{
+   for(S32 i = 0; i < WordCount; i++)
+      if(mBits[i] & other.mBits[i])
+         return true;
+
+   return false;
+}
+
+
+bool TypeMask::isEmpty() const
+{
+   for(S32 i = 0; i < WordCount; i++)
+      if(mBits[i])
+         return false;
+
+   return true;
+}
+
+
+U32 TypeMask::getWord(S32 index) const
+{
+   return mBits[index];
+}
+
+
+S32 TypeMask::getWordCount()
+{
+   return WordCount;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+DatabaseQuery::DatabaseQuery()
+{
+   mStamp = 1;
+   mVisitedCount = 0;
+}
+
+
+// Destructor
+DatabaseQuery::~DatabaseQuery()
+{
+   // Do nothing
+}
+
+
+void DatabaseQuery::clear()
+{
+   mResults.clear();
+   mVisitedCount = 0;
+   mStamp++;
+
+   // Stamp wrapped around; old slots could look current, so wipe them all
+   if(mStamp == 0)
+   {
+      for(S32 i = 0; i < mVisited.size(); i++)
+         mVisited[i].stamp = 0;
+
+      mStamp = 1;
+   }
+}
+
+
+static inline U32 hashObjectPointer(const DatabaseObject *object)
+{
+   return U32(size_t(object) >> 3) * 2654435761u;     // Knuth's multiplicative hash; low bits of pointers are always 0
+}
+
+
+// Double the size of our visited set, carrying current entries over
+void DatabaseQuery::growVisited()
+{
+   Vector<VisitedSlot> old = mVisited;
+
+   S32 newSize = max(64, mVisited.size() * 2);     // Must remain a power of 2
+   mVisited.resize(newSize);
+
+   for(S32 i = 0; i < newSize; i++)
+      mVisited[i].stamp = 0;
+
+   U32 mask = newSize - 1;
+
+   for(S32 i = 0; i < old.size(); i++)
+      if(old[i].stamp == mStamp)
+      {
+         U32 slot = hashObjectPointer(old[i].object) & mask;
+         while(mVisited[slot].stamp == mStamp)
+            slot = (slot + 1) & mask;
+
+         mVisited[slot] = old[i];
+      }
+}
+
+
+bool DatabaseQuery::markVisited(DatabaseObject *object)
+{
+   // Keep the table no more than half full so probe runs stay short
+   if((mVisitedCount + 1) * 2 > mVisited.size())
+      growVisited();
+
+   U32 mask = mVisited.size() - 1;
+   U32 slot = hashObjectPointer(object) & mask;
+
+   while(mVisited[slot].stamp == mStamp)
+   {
+      if(mVisited[slot].object == object)
+         return false;
+
+      slot = (slot + 1) & mask;
+   }
+
+   mVisited[slot].object = object;
+   mVisited[slot].stamp = mStamp;
+   mVisitedCount++;
+
+   return true;
+}
+
+
+bool DatabaseQuery::isVisited(const DatabaseObject *object) const
+{
+   if(mVisitedCount == 0)
+      return false;
+
+   U32 mask = mVisited.size() - 1;
+
+   for(U32 slot = hashObjectPointer(object) & mask; mVisited[slot].stamp == mStamp; slot = (slot + 1) & mask)
+      if(mVisited[slot].object == object)
+         return true;
+
+   return false;
+}
+
+
+bool DatabaseQuery::unmarkVisited(const DatabaseObject *object)
+{
+   if(mVisitedCount == 0)
+      return false;
+
+   U32 mask = mVisited.size() - 1;
+   U32 hole = hashObjectPointer(object) & mask;
+
+   while(mVisited[hole].object != object)
+   {
+      if(mVisited[hole].stamp != mStamp)
+         return false;
+
+      hole = (hole + 1) & mask;
+   }
+
+   if(mVisited[hole].stamp != mStamp)
+      return false;
+
+   // Shift later entries of the same probe run back into the hole, so they can still be found.  An entry can fill the 
+   // hole if the hole lies between its home slot and where it is now.
+   for(U32 next = (hole + 1) & mask; mVisited[next].stamp == mStamp; next = (next + 1) & mask)
+   {
+      U32 home = hashObjectPointer(mVisited[next].object) & mask;
+
+      if(((next - home) & mask) >= ((next - hole) & mask))
+      {
+         mVisited[hole] = mVisited[next];
+         hole = next;
+      }
+   }
+
+   mVisited[hole].stamp = 0;     // Never a current stamp
+   mVisitedCount--;
+
+   return true;
+}
+
+
+const Vector<DatabaseObject *> &DatabaseQuery::getResults() const
+{
+   return mResults;
+}
+
+
+S32 DatabaseQuery::getResultCount() const
+{
+   return mResults.size();
+}
+
+
+DatabaseObject *DatabaseQuery::getResult(S32 index) const
+{
+   return mResults[index];
+}
+
+
+void DatabaseQuery::addResult(DatabaseObject *object)
+{
+   mResults.push_back(object);
+}
+
+
 };
 
 // Reusable container for searching gridDatabases
@@ -55,6 +55,7 @@ private:
    bool mExtentSet;     // A flag to mark whether extent has been set on this object
    GridDatabase *mDatabase;
    DatabaseBucketEntry *mBucketList;
+   U8 mListedTypeNumber;   // Type list mDatabase filed us under; deleteObject() can change our type while we're on it
 
 protected:
    U8 mObjectTypeNumber;
@@ -94,48 +95,192 @@ public:
 };
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// A set of object type numbers, one bit per type
+class TypeMask
+{
+private:
+   enum {
+      WordCount = 256 / 32,
+   };
+
+   U32 mBits[WordCount];
+
+public:
+   TypeMask();                               // Constructor -- empty set
+   explicit TypeMask(U8 typeNumber);         // Just typeNumber
+   explicit TypeMask(TestFunc testFunc);     // Every type testFunc accepts
+   explicit TypeMask(const Vector<U8> &typeNumbers);
+
+   void clear();
+   void set(U8 typeNumber) { mBits[typeNumber >> 5] |= 1u << (typeNumber & 31); }
+   void unset(U8 typeNumber) { mBits[typeNumber >> 5] &= ~(1u << (typeNumber & 31)); }
+   bool test(U8 typeNumber) const { return (mBits[typeNumber >> 5] & (1u << (typeNumber & 31))) != 0; }
+
+   bool intersects(const TypeMask &other) const;
+   bool isEmpty() const;
+
+   U32 getWord(S32 index) const;       // For iterating over the types in the set; see GridDatabase
+   static S32 getWordCount();
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Callback for visitor-style queries; context is passed through untouched.  Return false to stop the search.
+typedef bool (*QueryVisitor)(DatabaseObject *object, void *context);
+
+// Holds the results and bookkeeping for a series of database searches.  Unlike the global fillVector, each
+// DatabaseQuery has its own result buffer and its own query stamp, so searches using different DatabaseQuerys
+// can nest or run side by side.  Keep one around (as a member) rather than creating a new one for each search;
+// once its buffers have grown to size, searches no longer allocate memory.
+class DatabaseQuery
+{
+private:
+   struct VisitedSlot
+   {
+      DatabaseObject *object;
+      U32 stamp;        // Slot is only in use if this matches mStamp
+   };
+
+   U32 mStamp;
+   S32 mVisitedCount;
+   Vector<VisitedSlot> mVisited;       // Open-addressed hash set of objects found since the last clear()
+   Vector<DatabaseObject *> mResults;
+
+   void growVisited();
+
+public:
+   DatabaseQuery();              // Constructor
+   virtual ~DatabaseQuery();     // Destructor
+
+   void clear();     // Start a new search; until the next clear(), objects that have already been found won't be found again
+
+   bool markVisited(DatabaseObject *object);    // Returns false if object has already been found since the last clear()
+   bool isVisited(const DatabaseObject *object) const;
+   bool unmarkVisited(const DatabaseObject *object);     // Lets object be found again; returns false if it hadn't been found
+
+   const Vector<DatabaseObject *> &getResults() const;
+   S32 getResultCount() const;
+   DatabaseObject *getResult(S32 index) const;
+
+   void addResult(DatabaseObject *object);
+};
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
 class WallSegmentManager;
 class GoalZone;
+class CollisionBroadphase;
+class ScopeTracker;
 
 class GridDatabase
 {
+   friend class DatabaseObject;     // For maintaining bucket lists when extents change
+
 private:
    U32 mDatabaseId;
    static U32 mQueryId;
    static U32 mCountGridDatabase;      // Reference counter for destruction of mChunker
 
    WallSegmentManager *mWallSegmentManager;
+   CollisionBroadphase *mBroadphase;               // Told about objects added, removed, or moved while it's set
+   ScopeTracker *mScopeTracker;                    // Same
 
    Vector<DatabaseObject *> mAllObjects;
-   Vector<DatabaseObject *> mGoalZones;
-   Vector<DatabaseObject *> mFlags;
-   Vector<DatabaseObject *> mSpyBugs;
+   Vector<DatabaseObject *> mObjectsByType[256];   // Same objects as mAllObjects, split up by the type they were added with,
+                                                   // in the same order
+   TypeMask mTypesPresent;                         // Types with at least one object in the database
+
+   bool mUseTypeIndex;                             // Use mObjectsByType and bucket type masks to narrow searches
+   mutable U32 mCandidateCount;                    // Objects examined by searches, for benchmarking
+
+   // Building a TypeMask from a TestFunc means asking it about every type number, which is far more work than most searches.
+   // TestFuncs always give the same answers, so we remember the masks we've built; there are only a few dozen TestFuncs.
+   // Entries are only ever filled in, never replaced, so a search can't disturb one that's underway.
+   struct CachedTestFuncMask
+   {
+      TestFunc testFunc;
+      TypeMask mask;
+   };
+
+   mutable CachedTestFuncMask mTestFuncMasks[128];
+
+   struct SearchOrder
+   {
+      DatabaseObject *object;
+      S32 x, y;         // Bin in which a bucket search finds the object
+      S32 position;     // Position in that bin's bucket, if it shares the bin with another object
+   };
 
-   void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery = false) const;
+   mutable Vector<SearchOrder> mSearchOrder;       // Scratch space for sortInSearchOrder()
+
+   enum {
+      MaxTypeListResults = 32,      // Most objects a search in extents will take from the type lists; see useTypeLists()
+   };
+
+   static S32 QSORT_CALLBACK compareSearchOrder(SearchOrder *a, SearchOrder *b);
+   void putInSearchOrder(const IntRect &bins, SearchOrder *order, S32 count) const;
+
+   void findObjects(const TypeMask &types, Vector<DatabaseObject *> &fillVector, const Rect *extents, bool sameQuery) const;
+
+   static bool addToFillVector(DatabaseObject *object, void *context);
+
+   bool visitObjects(const TypeMask &types, DatabaseQuery *query, const Rect *extents, 
+                     QueryVisitor visitor, void *context, bool visitorSkipsDuplicates = false) const;
+   bool visitTypeLists(const TypeMask &types, DatabaseQuery *query, const Rect *extents, const IntRect *bins, 
+                       QueryVisitor visitor, void *context) const;
+   bool isFirstBucketForObject(const DatabaseObject *object, const IntRect &bins, S32 x, S32 y) const;
+   bool useTypeLists(const TypeMask &types, const IntRect &bins) const;
+   bool isSingleTypeSearch(const TypeMask &types) const;
+
+public:
+   enum BucketMode {
+      HashedBuckets,    // Fixed 16x16 grid; coordinates wrap around, so distant regions share buckets
+      LevelBuckets,     // Grid sized to cover the level extents; nothing wraps, coordinates outside are clamped to the edge
+   };
+
+private:
+   BucketMode mBucketMode;
+   S32 mBucketWidthBitShift;           // Width/height of each bucket in pixels, in a form of 2 ^ n
+   S32 mBucketOriginX, mBucketOriginY; // Bin coordinates of our lower-left bucket; LevelBuckets only
+   S32 mBucketCols, mBucketRows;
+
+   DatabaseBucketEntryBase *mBuckets;  // mBucketCols * mBucketRows bucket heads
+   TypeMask *mBucketTypes;             // For each bucket, the types of the objects in it; may include types that have since left
+
+
+   void allocateBuckets(S32 cols, S32 rows);
+   void addToBuckets(DatabaseObject *theObject);
+   void removeFromBuckets(DatabaseObject *theObject);
 
    void fillBins(const Rect &extents, IntRect &bins) const;    // Helper function -- translates extents into bins to search
+   S32 getBucketIndex(S32 x, S32 y) const;                     // Index into mBuckets for a bin produced by fillBins()
 
 public:
    enum {
-      BucketRowCount = 16,    // Number of buckets per grid row, and number of rows; should be power of 2
+      BucketRowCount = 16,    // Number of buckets per grid row, and number of rows in HashedBuckets mode; should be power of 2
       BucketMask = BucketRowCount - 1,
+      MaxLevelBucketRowCount = 128,    // LevelBuckets mode will widen its buckets rather than exceed this many per row
    };
 
    static ClassChunker<DatabaseBucketEntry> *mChunker;
 
-   DatabaseBucketEntryBase mBuckets[BucketRowCount][BucketRowCount];
-
    explicit GridDatabase(bool createWallSegmentManager = true);   // Constructor
    // GridDatabase::GridDatabase(const GridDatabase &source);
    virtual ~GridDatabase();                                       // Destructor
 
 
-   static const S32 BucketWidthBitShift = 8;    // Width/height of each bucket in pixels, in a form of 2 ^ n, 8 is 256 pixels
+   static const S32 BucketWidthBitShift = 8;    // Default width/height of each bucket in pixels, in a form of 2 ^ n, 8 is 256 pixels
+
+   void setBucketMode(BucketMode mode);
+   BucketMode getBucketMode() const;
+   void fitBucketsToExtents(const Rect &extents);     // Resize the grid to cover extents; only does something in LevelBuckets mode
 
    DatabaseObject *findObjectLOS(U8 typeNumber, U32 stateIndex, bool format, const Point &rayStart, const Point &rayEnd,
                                  float &collisionTime, Point &surfaceNormal) const;
@@ -151,7 +296,7 @@ public:
 
    void findObjects(Vector<DatabaseObject *> &fillVector) const;     // Returns all objects in the database
    const Vector<DatabaseObject *> *findObjects_fast() const;         // Faster than above, but results can't be modified
-   const Vector<DatabaseObject *> *findObjects_fast(U8 typeNumber) const;   // Currently only works with goalZones, may be expanded in the future
+   const Vector<DatabaseObject *> *findObjects_fast(U8 typeNumber) const;   // All objects of a single type
 
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const;
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
@@ -162,10 +307,26 @@ public:
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const;
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
 
+   // Reentrant searches -- results are appended to query, objects already found since query was last cleared are skipped
+   void findObjects(U8 typeNumber, DatabaseQuery &query) const;
+   void findObjects(U8 typeNumber, DatabaseQuery &query, const Rect &extents) const;
+   void findObjects(TestFunc testFunc, DatabaseQuery &query) const;
+   void findObjects(TestFunc testFunc, DatabaseQuery &query, const Rect &extents) const;
+   void findObjects(const Vector<U8> &types, DatabaseQuery &query) const;
+   void findObjects(const Vector<U8> &types, DatabaseQuery &query, const Rect &extents) const;
+
+   // Call visitor for each matching object without collecting them anywhere; needs no shared state, so visitors can search too
+   void visitObjects(TestFunc testFunc, QueryVisitor visitor, void *context) const;
+   void visitObjects(TestFunc testFunc, const Rect &extents, QueryVisitor visitor, void *context) const;
+
+   // Puts objects -- which must be exactly what a search in extents would find -- in the order that search would find them
+   void sortInSearchOrder(const Rect &extents, Vector<DatabaseObject *> &objects) const;
+
    void copyObjects(const GridDatabase *source);
 
 
    bool testTypes(const Vector<U8> &types, U8 objectType) const;
+   TypeMask getTypeMask(TestFunc testFunc) const;     // Same as TypeMask(testFunc), but remembered
 
 
    void dumpObjects();     // For debugging purposes
@@ -175,6 +336,12 @@ public:
 
    WallSegmentManager *getWallSegmentManager() const;      
 
+   void setBroadphase(CollisionBroadphase *broadphase);
+   CollisionBroadphase *getBroadphase() const;
+
+   void setScopeTracker(ScopeTracker *scopeTracker);
+   ScopeTracker *getScopeTracker() const;
+
    void addToDatabase(DatabaseObject *databaseObject);
    void addToDatabase(const Vector<DatabaseObject *> &objects);
 
@@ -186,6 +353,11 @@ public:
    S32 getObjectCount(U8 typeNumber) const;             // Return the number of objects currently in the database of specified type
    bool hasObjectOfType(U8 typeNumber) const;
    DatabaseObject *getObjectByIndex(S32 index) const;   // Kind of hacky, kind of useful
+
+   // For benchmarking
+   void setTypeIndexEnabled(bool enabled);              // When disabled, searches examine every object in the buckets they cover
+   U32 getCandidateCount() const;                       // Number of objects searches have examined since last reset
+   void resetCandidateCount();
 };
 
 
@@ -119,6 +119,9 @@ using namespace TNL;
 #include "SoundSystem.h"
 #include "InputCode.h"     // initializeKeyNames()
 #include "ClientInfo.h"
+#include "controlObjectConnection.h"    // For logPoolUsage()
+#include "TickScheduler.h"
+#include "gameNetInterface.h"
 #include "Console.h"       // For access to console
 #include "BotNavMeshZone.h"
 #include "ship.h"
@@ -403,10 +406,60 @@ void idle()
 }  // end idle()
 
 
+static const U32 SuspendedTickRate = 25;     // Ticks per second when nobody's playing; we still answer pings right away
+
+
+// Dedicated servers have nothing to draw and no input to poll, so instead of sleeping and checking the clock we wait on
+// the game socket.  Packets get handled the moment they arrive, and ticks run on a fixed schedule.
+static void dedicatedIdle(TickScheduler &scheduler)
+{
+   loadAnotherLevelOrStartHosting();
+
+   ServerGame *serverGame = GameManager::getServerGame();
+
+   // Load levels as fast as we can -- one per pass
+   if(GameManager::getHostingModePhase() == GameManager::LoadingLevels)
+      return;
+
+   scheduler.setTickRate(serverGame->isSuspended() ? SuspendedTickRate : 
+                                                     serverGame->getSettings()->getIniSettings()->maxDedicatedFPS);
+
+   U32 currentTime = Platform::getRealMilliseconds();
+   U32 waitTime = scheduler.getTimeUntilNextTick(currentTime);
+
+   if(waitTime > 0)
+   {
+      GameNetInterface *netInterface = serverGame->getNetInterface();
+
+      if(netInterface->waitForIncomingPackets(waitTime))
+         netInterface->checkIncomingPackets();
+
+      return;
+   }
+
+   U32 timeDelta = scheduler.beginTick(currentTime);
+
+   checkIfServerGameIsShuttingDown(timeDelta);
+   GameManager::idle(timeDelta);
+
+   if(scheduler.isReportDue(currentTime))
+      scheduler.logReport(currentTime);
+}
+
+
 void dedicatedServerLoop()
 {
+   TickScheduler scheduler;
+
    for(;;)        // Loop forever!
-      idle();     // Idly!
+   {
+      ServerGame *serverGame = GameManager::getServerGame();
+
+      if(serverGame && serverGame->isDedicated())
+         dedicatedIdle(scheduler);
+      else
+         idle();     // Idly!
+   }
 }
 
 ////////////////////////////////////////
@@ -511,6 +564,7 @@ void shutdownBitfighter()
    DisplayManager::cleanup();
 
    NetClassRep::logBitUsage();
+   ControlObjectConnection::logPoolUsage();
    logprintf("Bye!");
 
    exitToOs();    // Do not pass Go
@@ -1182,6 +1236,7 @@ int main(int argc, char **argv)
       checkIfThisIsAnUpdate(settings.get(), isStandalone);
 
    // Load Lua stuff
+   LuaScriptRunner::setBytecodeCacheDir(joindir(folderManager->rootDataDir, "bytecode"));
    LuaScriptRunner::startLua(folderManager->luaDir);  // Create single "L" instance which all scripts will use
    // TODO: What should we do if this fails?  Quit the game?
 
@@ -1195,6 +1250,14 @@ int main(int argc, char **argv)
    SoundSystem::init(settings->getIniSettings()->sfxSet, folderManager->sfxDir, 
                      folderManager->musicDir, settings->getIniSettings()->getMusicVolLevel());  
    
+   // Get the nav meshes ready ahead of time, so the server doesn't have to build them during play
+   if(settings->getSpecified(BUILD_NAV_MESHES))
+   {
+      writeToConsole();
+      ServerGame::buildBotNavMeshCaches(settings, LevelSourcePtr(settings->chooseLevelSource(NULL)));
+      exitToOs(0);
+   }
+
    if(settings->isDedicatedServer())
    {
 #ifndef ZAP_DEDICATED
@@ -8,6 +8,7 @@
 #include "SparkTypesEnum.h"
 #include "SoundSystemEnums.h"
 
+#include "CollisionBroadphase.h"
 #include "game.h"
 #include "gameConnection.h"
 #include "ship.h"
@@ -462,7 +463,11 @@ BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Poi
 
    fillVector.clear();
 
-   findObjects(collideTypes(), fillVector, queryRect);   // Free CPU for finding only the ones we care about
+   // On the server, the broadphase has usually already found what we might hit this tick; if not, search the database
+   CollisionBroadphase *broadphase = (stateIndex == ActualState && getDatabase()) ? getDatabase()->getBroadphase() : NULL;
+
+   if(!broadphase || !broadphase->findCandidates(this, collideTypes(), queryRect, fillVector))
+      findObjects(collideTypes(), fillVector, queryRect);   // Free CPU for finding only the ones we care about
 
    fillVector.sort(sortBarriersFirst);  // Sort to do Barriers::Collide first, to prevent picking up flag (FlagItem::Collide) through Barriers, especially when client does /maxfps 10
 
@@ -599,6 +604,28 @@ void MoveObject::onLeftZone(Zone *zone)
 
 
 
+struct ZoneSearch
+{
+   Point pos;
+   Vector<SafePtr<Zone> > *zoneList;
+};
+
+
+// Visitor for getZonesObjectIsIn -- extents overlap...  now check for actual overlap
+static bool addZoneIfContainsPoint(DatabaseObject *object, void *context)
+{
+   ZoneSearch *search = static_cast<ZoneSearch *>(context);
+
+   // Get points that define the zone boundaries
+   const Vector<Point> *polyPoints = object->getCollisionPoly();
+
+   if(polygonContainsPoint(polyPoints->address(), polyPoints->size(), search->pos))
+      search->zoneList->push_back(SafePtr<Zone>(static_cast<Zone *>(object)));
+
+   return true;
+}
+
+
 // Fill zoneList with a list of all zones that the ship is currently in
 // Server only
 void MoveObject::getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList)
@@ -608,20 +635,17 @@ void MoveObject::getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList)
 
    zoneList.clear();
 
-   Rect rect(getActualPos(), getActualPos());            // Center of object
+   GridDatabase *gridDB = getDatabase();
+   if(!gridDB)
+      return;
 
-   fillVector.clear();
-   findObjects((TestFunc)isZoneType, fillVector, rect);  // Find all zones the object might be in
+   ZoneSearch search;
+   search.pos = getActualPos();
+   search.zoneList = &zoneList;
 
-   // Extents overlap...  now check for actual overlap
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      // Get points that define the zone boundaries
-      const Vector<Point> *polyPoints = fillVector[i]->getCollisionPoly();
+   Rect rect(search.pos, search.pos);     // Center of object
 
-      if(polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()))
-         zoneList.push_back(SafePtr<Zone>(static_cast<Zone *>(fillVector[i])));
-   }
+   gridDB->visitObjects((TestFunc)isZoneType, rect, addZoneIfContainsPoint, &search);     // Check all zones the object might be in
 }
 
 
@@ -609,6 +609,7 @@ U16 Robot::findClosestZone(const Point &point)
    METHOD(CLASS,  canSeePoint,          ARRAYDEF({{ PT, END }              }), 1 )           \
                                                                                              \
    METHOD(CLASS,  getWaypoint,          ARRAYDEF({{ PT, END }}), 1 )                         \
+   METHOD(CLASS,  getFlowWaypoint,      ARRAYDEF({{ PT, END }}), 1 )                         \
                                                                                              \
    METHOD(CLASS,  setThrust,            ARRAYDEF({{ NUM, NUM, END }, { NUM, PT, END}}), 2 )  \
    METHOD(CLASS,  setThrustToPt,        ARRAYDEF({{ PT,       END }                 }), 1 )  \
@@ -842,26 +843,126 @@ S32 Robot::lua_getWaypoint(lua_State *L)
    // or the path we had no longer applied to our current location
    flightPlanTo = targetZone;
 
-   // check cache for path first
-   pair<S32,S32> pathIndex = pair<S32,S32>(currentZone, targetZone);
+   flightPlan = static_cast<ServerGame *>(getGame())->findBotPath(currentZone, targetZone, target);
 
-   const Vector<BotNavMeshZone *> *zones = static_cast<ServerGame *>(getGame())->getBotZones();  // Our pre-cached list of nav zones
+   if(flightPlan.size() > 0)
+      return returnPoint(L, flightPlan.last());
+   else
+      return returnNil(L);    // Out of options, end of the road
+}
+
+
+/**
+ * @luafunc point Robot::getFlowWaypoint(point p)
+ * 
+ * @brief Get next waypoint to head toward in order to move to `p`, using
+ * routes shared by all robots
+ * 
+ * @descr Like getWaypoint(), but rather than working out a path for this
+ * robot, looks up the next step in a map of the best way to `p` from
+ * everywhere on the level.  The map is made once for each place robots are
+ * heading, and only remade when `p` moves far enough to need a different one,
+ * so this stays cheap however many robots are chasing the same flag or core.
+ * The waypoints are not smoothed as much as getWaypoint()'s, so expect a
+ * slightly less direct route.
+ *
+ * @param p The destination point
+ * 
+ * @return The next point to head towards, or `nil` if no path can be found
+ */
+S32 Robot::lua_getFlowWaypoint(lua_State *L)
+{
+   TNLAssert(getGame()->isServer(), "Not a ServerGame");
+
+   checkArgList(L, functionArgs, "Robot", "getFlowWaypoint");
+
+   Point target = getPointOrXY(L, 1);
+
+   // If we can see the target, go there directly
+   if(canSeePoint(target, true))
+      return returnPoint(L, target);
 
-   if(getGame()->getGameType()->cachedBotFlightPlans.find(pathIndex) == getGame()->getGameType()->cachedBotFlightPlans.end())
+   ServerGame *serverGame = static_cast<ServerGame *>(getGame());
+
+   U16 targetZone = serverGame->findZoneContaining(target);
+
+   if(targetZone == U16_MAX)       // Target is off the map; head for the closest zone it can be seen from
    {
-      // Not found so calculate flight plan
-      flightPlan = AStar::findPath(zones, currentZone, targetZone, target);
+      targetZone = findClosestZone(target);
 
-      // Add to cache
-      getGame()->getGameType()->cachedBotFlightPlans[pathIndex] = flightPlan;
+      if(targetZone == U16_MAX)
+         return returnNil(L);
    }
-   else
-      flightPlan = getGame()->getGameType()->cachedBotFlightPlans[pathIndex];
 
-   if(flightPlan.size() > 0)
-      return returnPoint(L, flightPlan.last());
-   else
-      return returnNil(L);    // Out of options, end of the road
+   U16 currentZone = getCurrentZone();
+
+   if(currentZone == U16_MAX)
+      currentZone = findClosestZone(getActualPos());
+
+   if(currentZone == U16_MAX)
+      return returnNil(L);
+
+   // Already there, but something's in the way; the center of a zone can see all of it
+   if(currentZone == targetZone)
+   {
+      BotNavMeshZone *zone = static_cast<BotNavMeshZone *>(getGame()->getBotZoneDatabase()->getObjectByIndex(targetZone));
+      return returnPoint(L, zone->getCenter());
+   }
+
+   const BotFlowField *field = serverGame->getBotFlowField(targetZone);
+   U16 nextZone = field->getNextZone(currentZone);
+
+   if(nextZone == U16_MAX)
+      return returnNil(L);    // Can't get there from here
+
+   // Cut the corner if we can already see the gateway after this one, but don't skip past a teleporter
+   if(!field->isTeleporter(currentZone) && nextZone != targetZone && field->getNextZone(nextZone) != U16_MAX)
+   {
+      const Point &nextGateway = field->getGateway(nextZone);
+
+      if(canSeePoint(nextGateway, true))
+         return returnPoint(L, nextGateway);
+   }
+
+   return returnPoint(L, field->getGateway(currentZone));
+}
+
+
+struct ClosestEnemySearch
+{
+   Robot *robot;
+   F32 minDist;
+   Ship *closest;
+};
+
+
+// Visitor for findClosestEnemy
+static bool checkForCloserEnemy(DatabaseObject *object, void *context)
+{
+   ClosestEnemySearch *search = static_cast<ClosestEnemySearch *>(context);
+   Robot *robot = search->robot;
+
+   // Ignore self
+   if(object == robot)
+      return true;
+
+   // Ignore ship/robot if it's dead or cloaked
+   Ship *ship = static_cast<Ship *>(object);
+   if(ship->mHasExploded || !ship->isVisible(robot->hasModule(ModuleSensor)))
+      return true;
+
+   // Ignore ships on same team during team games
+   if(ship->getTeam() == robot->getTeam() && robot->getGame()->getGameType()->isTeamGame())
+      return true;
+
+   F32 dist = ship->getActualPos().distSquared(robot->getActualPos());
+   if(dist < search->minDist)
+   {
+      search->minDist = dist;
+      search->closest = ship;
+   }
+
+   return true;
 }
 
 
@@ -901,38 +1002,17 @@ S32 Robot::lua_findClosestEnemy(lua_State *L)
    }
 
 
-   F32 minDist = F32_MAX;
-   Ship *closest = NULL;
-
-   fillVector.clear();
+   ClosestEnemySearch search;
+   search.robot = this;
+   search.minDist = F32_MAX;
+   search.closest = NULL;
 
    if(useRange)
-      getGame()->getGameObjDatabase()->findObjects((TestFunc)isShipType, fillVector, queryRect);   
+      getGame()->getGameObjDatabase()->visitObjects((TestFunc)isShipType, queryRect, checkForCloserEnemy, &search);
    else
-      getGame()->getGameObjDatabase()->findObjects((TestFunc)isShipType, fillVector);   
-
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      // Ignore self 
-      if(fillVector[i] == this) 
-         continue;
-
-      // Ignore ship/robot if it's dead or cloaked
-      Ship *ship = static_cast<Ship *>(fillVector[i]);
-      if(ship->mHasExploded || !ship->isVisible(hasModule(ModuleSensor)))
-         continue;
+      getGame()->getGameObjDatabase()->visitObjects((TestFunc)isShipType, checkForCloserEnemy, &search);
 
-      // Ignore ships on same team during team games
-      if(ship->getTeam() == getTeam() && getGame()->getGameType()->isTeamGame())
-         continue;
-
-      F32 dist = ship->getActualPos().distSquared(getActualPos());
-      if(dist < minDist)
-      {
-         minDist = dist;
-         closest = ship;
-      }
-   }
+   Ship *closest = search.closest;
 
    return returnShip(L, closest);    // Handles closest == NULL
 }
@@ -102,6 +102,7 @@ public:
 
    // Navigation
    S32 lua_getWaypoint(lua_State *L);
+   S32 lua_getFlowWaypoint(lua_State *L);
 
    // Finding stuff
    S32 lua_findVisibleObjects(lua_State *L);
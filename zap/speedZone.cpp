@@ -44,6 +44,7 @@ const U16 SpeedZone::defaultSpeed = 2000;
 SpeedZone::SpeedZone(lua_State *L)
 {
    mNetFlags.set(Ghostable);
+   mNetFlags.set(SharesUpdates);
    mObjectTypeNumber = SpeedZoneTypeNumber;
 
    mSpeed = defaultSpeed;
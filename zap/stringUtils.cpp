@@ -479,6 +479,20 @@ bool fileExists(const string &path)
 }
 
 
+// Gets the last modified time (in secs) and size (in bytes) of a file, enough to tell if it has changed
+bool getFileStats(const string &path, S64 &modifiedTime, S64 &size)
+{
+   struct stat st;
+   if(stat(path.c_str(), &st) != 0)
+      return false;
+
+   modifiedTime = st.st_mtime;
+   size = st.st_size;
+
+   return true;
+}
+
+
 // Checks if specified folder exists; creates it if not
 bool makeSureFolderExists(const string &folder)
 {
@@ -814,6 +828,16 @@ bool writeFile(const string &path, const string &contents, bool append)
 
 // Pass in a path, returns contents of file; if file does not exist, returns empty string
 const string readFile(const string &path)
+{
+   string result = readFileBytes(path);
+   removeByteOrderMark(result);
+
+   return result;
+}
+
+
+// Same as readFile(), but leaves any byte order mark in place, so the contents are exactly what's on disk
+const string readFileBytes(const string &path)
 {
    ifstream file(path.c_str(), ios_base::in | ios_base::binary);
 
@@ -829,11 +853,15 @@ const string readFile(const string &path)
    file.read(&result[0], result.size());
    file.close();
 
+   return result;
+}
+
+
+void removeByteOrderMark(string &text)
+{
    // Remove the UTF-8 BOM if it exists
    // These are the first three bytes:  EF BB BF
-   trim_left_in_place(result, "\357\273\277");
-
-   return result;
+   trim_left_in_place(text, "\357\273\277");
 }
 
 
@@ -84,6 +84,7 @@ bool caseInsensitiveStringCompare(const string &str1, const string &str2);
 // File utils
 string getFileSeparator();
 bool fileExists(const string &path);               // Does file exist?
+bool getFileStats(const string &path, S64 &modifiedTime, S64 &size);   // False if file doesn't exist
 bool makeSureFolderExists(const string &dir);      // Like the man said: Make sure folder exists
 bool getFilesFromFolder(const string &dir, Vector<string> &files, const string extensions[] = 0, S32 extensionCount = 0);
 bool safeFilename(const char *str);
@@ -124,6 +125,8 @@ string chopComment(const string &line);
 
 bool writeFile(const string& path, const string& contents, bool append = false);
 const string readFile(const string& path);
+const string readFileBytes(const string& path);
+void removeByteOrderMark(string &text);
 
 string getExecutableDir();
 